@@ -18,17 +18,8 @@
  */
 extern const int MPFR_PREC_DEFAULT;
 
-/**
- *
- * @brief Global tuning parameters for 
- *        MCMC library
- */
-extern const int MCMC_MAX_BONDS;
-
 #define GLOBAL_VAR_DEFS               \
-     const int MPFR_PREC_DEFAULT = 53;\
-                                      \
-     const int MCMC_MAX_BONDS = 100;
+     const int MPFR_PREC_DEFAULT = 53;
 
 #endif	/* GLOBALVARS_H */
 
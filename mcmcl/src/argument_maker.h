@@ -19,6 +19,10 @@
  * array of the same length as y, each of whose values is the scalar 
  * sigma.
  * 
+ * The inputs are contiguous views on the values of the bond's nodes, 
+ * see mcmc_node::values: on the bond's copy of a parameter, or on the
+ * storage of a constant node like data, which is never copied.
+ * 
  * @see mcmc_parameter
  * @see basic_mcmc_bond
  * @see mcmc_likelihood
@@ -27,7 +31,10 @@
 #ifndef ARGUMENT_MAKER_H
 #define	ARGUMENT_MAKER_H
 
+#include <algorithm>
 #include <vector>
+#include <cstddef>
+#include "argument_view.h"
 
 class argument_maker {
 public:
@@ -52,7 +59,166 @@ public:
      * @see group_argument
      * 
      */
-    virtual std::vector<double> getArgument (std::vector<std::vector<double> > const &params) {return params[0];};
+    virtual std::vector<double> getArgument (std::vector<argument_view> const &params) {
+        return std::vector<double>(params[0].data, params[0].data + params[0].size());
+    };
+    
+    /**
+     * 
+     * @brief Computes the argument into caller-owned storage.
+     * @param params Input parameters for which the argument should 
+     *        be computed.
+     * @param out Storage for @ref getSize(params) entries the argument 
+     *        is written to, usually a column of a @ref bond_arg_matrix. 
+     * 
+     * The default falls back to @ref getArgument and therefore 
+     * allocates.
+     * 
+     */
+    virtual void fillArgument (std::vector<argument_view> const &params, double *out) {
+        std::vector<double> temp = getArgument(params);
+        std::copy(temp.begin(), temp.end(), out);
+    };
+    
+    /**
+     * 
+     * @brief  Makes the argument available without copying it if 
+     *         possible.
+     * @param  params Input parameters for which the argument should 
+     *         be computed.
+     * @param  storage Caller-owned storage for @ref getSize(params)
+     *         entries that can be used for the argument.
+     * @return A view on the argument, valid as long as %params and 
+     *         %storage are unchanged.
+     * 
+     * The default fills %storage through @ref fillArgument and returns 
+     * a view on it. Arguments that are a parameter vector or a single 
+     * value return a view on these instead.
+     * 
+     */
+    virtual argument_view makeArgument (std::vector<argument_view> const &params, double *storage) {
+        fillArgument(params, storage);
+        return argument_view(storage, 1, getSize(params));
+    };
+    
+    /**
+     * 
+     * @brief  Makes a range of entries of the argument available.
+     * @param  params Input parameters for which the argument should 
+     *         be computed.
+     * @param  begin Index of the first entry.
+     * @param  end Index one past the last entry.
+     * @param  storage Caller-owned storage for end - begin entries
+     *         that can be used for the range.
+     * @return A view on the entries [begin, end) of the argument.
+     * 
+     * Used by bonds that recompute a contiguous range of likelihood
+     * terms. The default fills %storage entry by entry through 
+     * @ref getArgumentAt.
+     * 
+     */
+    virtual argument_view makeArgumentRange (std::vector<argument_view> const &params, size_t begin, size_t end, double *storage) {
+        for(size_t i = begin; i < end; ++i) {
+            storage[i - begin] = getArgumentAt(params, i);
+        }
+        return argument_view(storage, 1, end - begin);
+    };
+    
+    /**
+     * 
+     * @brief  Computes a single entry of the argument.
+     * @param  params Input parameters for which the argument should 
+     *         be computed.
+     * @param  i Index of the entry, i.e. of the likelihood term.
+     * @return The i-th entry of @ref getArgument(params).
+     * 
+     * Used by bonds that recompute only the likelihood terms touched 
+     * by a proposal. The default materializes the whole argument, 
+     * inheriting classes should override it with an O(1) lookup 
+     * defined in their header, such that @ref static_bond can 
+     * inline it.
+     * 
+     */
+    virtual double getArgumentAt (std::vector<argument_view> const &params, size_t i) {return getArgument(params)[i];};
+    
+    /**
+     * 
+     * @brief  Returns the length of the argument.
+     * @param  params Input parameters for which the argument should 
+     *         be computed.
+     * @return Number of entries of the argument.
+     * 
+     * The default is the length of the first parameter vector. 
+     * Makers whose argument has a different length have to override
+     * it, as callers size the storage for the argument by it.
+     * 
+     */
+    virtual size_t getSize (std::vector<argument_view> const &params) const {return params[0].size();};
+    
+    /**
+     * 
+     * @brief  Collects the argument entries that depend on a single
+     *         parameter coordinate.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which Index of the coordinate in that parameter vector.
+     * @param  terms Container the indices of the dependent entries are
+     *         appended to.
+     * @return True, if the dependency is known, false otherwise. 
+     * 
+     * A return value of false forces the bond to recompute the whole
+     * likelihood, which is also the default.
+     * 
+     */
+    virtual bool dependentTerms (int whatami, int which, std::vector<size_t> &terms) const {return false;};
+    
+    /**
+     * 
+     * @brief Indicates if @ref addGradient is implemented.
+     * 
+     */
+    virtual bool hasGradient () const {
+        return false;
+    };
+    
+    /**
+     * 
+     * @brief Propagates derivatives with respect to the argument to a
+     *        parameter vector of the bond.
+     * @param params Input parameters the argument is computed from.
+     * @param whatami Index of the parameter vector in the bond.
+     * @param grad Derivatives with respect to each entry of the 
+     *        argument, @ref getSize(params) entries.
+     * @param out Derivatives with respect to the entries of 
+     *        %params[whatami], the propagated ones are added.
+     * 
+     * Only used if @ref hasGradient returns true.
+     * 
+     */
+    virtual void addGradient (std::vector<argument_view> const &params, int whatami, 
+        double const *grad, std::vector<double> &out) const {};
+    
+    /**
+     * 
+     * @brief  Indicates if the argument depends on a parameter vector.
+     * @param  whatami Index of the parameter vector in the bond.
+     * 
+     * The default is true, which is always safe.
+     * 
+     */
+    virtual bool dependsOn (int whatami) const {return true;};
+    
+    /**
+     * 
+     * @brief  Indicates if each entry of the argument is one 
+     *         coordinate of a parameter vector, unchanged.
+     * @param  whatami Index of the parameter vector in the bond.
+     * 
+     * For such an argument @ref addGradient sums values per entry 
+     * into the coordinates, which bonds also use for sufficient 
+     * statistics, see mcmc_likelihood::sufficientStatistics.
+     * 
+     */
+    virtual bool isSelection (int whatami) const {return false;};
     
 };
 
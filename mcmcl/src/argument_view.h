@@ -0,0 +1,110 @@
+/**
+ *
+ * @file argument_view.h
+ * @author Lars Simon Zehnder
+ * 
+ * @created June 2, 2012, 11:20 AM
+ * 
+ * @brief Non-owning view on an argument vector.
+ * 
+ * An %argument_view refers to storage owned by someone else, e.g.
+ * a parameter vector, a buffer of a bond or a single constant. 
+ * A stride of zero broadcasts a scalar to the whole length, 
+ * a stride of one refers to a contiguous vector. 
+ * 
+ * @see argument_maker
+ * @see mcmc_likelihood
+ * 
+ */
+#ifndef ARGUMENT_VIEW_H
+#define	ARGUMENT_VIEW_H
+
+#include <cstddef>
+
+class argument_view {
+public:
+    
+    /**
+     * 
+     * @brief Default constructor, constructs an empty view.
+     * 
+     */
+    argument_view() : data(0), stride(0), length(0) {};
+    
+    /**
+     * 
+     * @brief Custom constructor.
+     * @param data Pointer to the first entry.
+     * @param stride Distance between two entries, zero for a 
+     *        broadcast scalar. 
+     * @param length Number of entries.
+     * 
+     */
+    argument_view(double const *data, size_t stride, size_t length) :
+    data(data), stride(stride), length(length) {};
+    
+    /**
+     * 
+     * @brief  Element access.
+     * @param  i Index of the entry.
+     * @return The i-th entry.
+     * 
+     */
+    double operator[](size_t i) const {
+        return data[i * stride];
+    }
+    
+    /**
+     * 
+     * @brief  Restricts the view to a range of entries.
+     * @param  begin Index of the first entry.
+     * @param  end Index one past the last entry.
+     * @return View on the entries [begin, end).
+     * 
+     */
+    argument_view slice(size_t begin, size_t end) const {
+        return argument_view(data + begin * stride, stride, end - begin);
+    }
+    
+    /**
+     * 
+     * @brief Indicates if the view broadcasts a single value.
+     * 
+     */
+    bool isScalar() const {
+        return stride == 0;
+    }
+    
+    /**
+     * 
+     * @brief Number of entries.
+     * 
+     */
+    size_t size() const {
+        return length;
+    }
+    
+    /**
+     * 
+     * @brief Pointer to the first entry.
+     * 
+     */
+    double const *data;
+    
+    /**
+     * 
+     * @brief Distance between two entries.
+     * 
+     */
+    size_t stride;
+    
+    /**
+     * 
+     * @brief Number of entries.
+     * 
+     */
+    size_t length;
+};
+
+#endif	/* ARGUMENT_VIEW_H */
+
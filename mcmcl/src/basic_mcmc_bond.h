@@ -13,28 +13,47 @@
  * values of the parameters into arguments for the Likelihood function.  
  * The %basic_mcmc_bond consists on default only of an 
  * @ref identity_argument_maker, and an @ref mcmc_likelihood. 
- * When @ref basic_mcmc_bond::compute is called, the parameters are prepared
+ * When @ref basic_mcmc_bond::propose is called, the parameters are prepared
  * by the @ref argument_makers and then the old value is subtracted from the 
- * new likelihood value. 
+ * new likelihood value. The bond holds its own copy of the parameter 
+ * values, which is filled once and afterwards only changed coordinate
+ * by coordinate: a proposal writes the candidate and remembers the 
+ * replaced value, @ref basic_mcmc_bond::reject writes it back.
+ * Constant nodes, i.e. data, are not copied but read in place, see 
+ * mcmc_node::isConstant, such that data referenced by an 
+ * @ref mcmc_data exists once however many bonds and chains use it.
  * Likelihood is a bad name actually, as the function is not restrained on a
  * standard likelihood function. It can be as well only a part of a 'true'
  * likelihood function. 
  * 
+ * Separable likelihoods over more than %CHUNK_TERMS terms are evaluated
+ * in chunks of this fixed size, in parallel if a @ref thread_pool is
+ * set. The chunk sums are added in order, so the value of the bond
+ * does not depend on the number of threads. The likelihood has to 
+ * allow concurrent calls to mcmc_likelihood::evaluate then, which the
+ * built-in densities do.
+ * 
  * @see mcmc_bond
  * @see mcmc_likelihood
  * @see argument_maker
+ * @see static_bond
  * 
  */
 #ifndef BASIC_MCMC_BOND_H
 #define	BASIC_MCMC_BOND_H
 
-#include "mcmc_bond.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <boost/shared_ptr.hpp>
+#include "staged_bond.h"
 #include "mcmc_parameter.h"
 #include "identity_argument_maker.h"
 #include "mcmc_likelihood.h"
 #include "argument_maker.h"
+#include "bond_arg_matrix.h"
 
-class basic_mcmc_bond : public mcmc_bond {
+class basic_mcmc_bond : public staged_bond {
 public:
     
     /**
@@ -43,10 +62,18 @@ public:
      * @param lik Likelihood function to be computed for this bond. 
      * @param par Parameters to be part of the likelihood function.
      * 
+     * Each parameter is passed through an @ref identity_argument_maker.
+     * The parameters are referenced, not copied.
+     * 
      */
-    basic_mcmc_bond(mcmc_likelihood const &lik, std::vector<mcmc_parameter> const &par) : 
-    lik(lik), par(par) {
-        
+    basic_mcmc_bond(boost::shared_ptr<mcmc_likelihood> const &lik, std::vector<mcmc_parameter> const &par) : 
+    lik(lik), pool(0), bounded(false) {
+        for(size_t i = 0; i < par.size(); ++i) {
+            argms.push_back(boost::shared_ptr<argument_maker>(new identity_argument_maker(i)));
+            nodes.push_back(&par[i]);
+        }
+        row.resize(argms.size());
+        prepareArgs();
     }
     
     /**
@@ -57,18 +84,37 @@ public:
      * @param par Parameters relevant for the bond. 
      * 
      * Note, that all @ref mcmc_parameter add the bond into their bond list. 
-     * On the other side the bond adds all these parameters to its parameter list.
+     * On the other side the bond adds all these parameters to its node list.
+     * %argument_makers and the likelihood are held by pointer, such that
+     * inheriting classes are not sliced. 
      * 
      */
-    basic_mcmc_bond(std::vector<argument_maker> argm, mcmc_likelihood lik,
-    std::vector<mcmc_parameter> par) {
+    basic_mcmc_bond(std::vector<boost::shared_ptr<argument_maker> > argm, boost::shared_ptr<mcmc_likelihood> lik,
+    std::vector<mcmc_parameter> &par) : pool(0), bounded(false) {
         this->argms = argm;
         this->lik = lik;
-        this->par = par;
+        row.resize(argms.size());
         size_t i; 
         for(i = 0; i < par.size(); ++i){
+            nodes.push_back(&par[i]);
             par[i].addBond(*this, i);
         }
+        prepareArgs();
+    }
+    
+    /**
+     * 
+     * @brief Constructor for bonds owned by an @ref mcmc_model.
+     * @param argm Vector of type @ref argument_maker holding transformations
+     *        for parameters.
+     * @param lik Log-likelihood function used in this bond.
+     * 
+     * The nodes are attached by mcmc_model::addBond.
+     * 
+     */
+    basic_mcmc_bond(std::vector<boost::shared_ptr<argument_maker> > const &argm, 
+    boost::shared_ptr<mcmc_likelihood> const &lik) : argms(argm), lik(lik), pool(0), bounded(false) {
+        row.resize(argms.size());
     }
     /**
      * 
@@ -82,77 +128,332 @@ public:
      *        parameters to get altered through their 
      *        corresponding @ref argument_maker.
      * 
-     * Note, that par is a vector of @ref mcmc_parameter and 
-     * mcmc_parameter::value is a double vector of the respective 
-     * parameter values. 
+     * Note, that %nodes are the parameters of the bond and 
+     * mcmc_node::value is a double vector of the respective 
+     * parameter values. The values are copied once when the nodes
+     * are attached, calling the function again resets the bond to the
+     * current values of its nodes. Constant nodes, i.e. data, are not 
+     * copied, the %argument_makers read them in place through 
+     * mcmc_node::values.
      * 
      * @see argument_maker
      * 
      */
     virtual void prepareArgs() {
-        for(size_t i = 0; i < par.size(); ++i) {
-            preargs.push_back(par[i].value);
-        }
+        copyNodes(nodes);
     }
+    
     /**
      * 
-     * @brief Subtracts the %current_value of the bond from the
-     *        the new value.
+     * @brief Computes the current value of the bond.
      * 
      * To ensure performance the current value of a bond is always
-     * hold in the %basic_mcmc_bond object. 
+     * hold in the %basic_mcmc_bond object. It is computed once, at the
+     * first proposal, and afterwards only replaced by accepted 
+     * proposals.
      * 
      */
-    virtual void subtractOld() {
-        if(this->value_computed) {
-            this->logr -= current_value;
-        } else {
-            for (size_t i = 0; i < am.size(); ++i) {
-                args[i] = am[i].getArgument(preargs);
+    virtual void computeCurrent() {
+        args.resize(argms.size(), numTerms());
+        for (size_t i = 0; i < argms.size(); ++i) {
+            args.bind(i, argms[i]->makeArgument(node_views, args.column(i)));
+        }
+        current_value = evaluate(args.views());
+        bounded = lik->upperBound(args.views()) < HUGE_VAL;
+        value_computed = true;
+    }
+    
+    /**
+     * 
+     * @brief  Computes the change of the bond for a proposal and stops
+     *         once it is certainly below a floor.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  newpar The candidate.
+     * @param  which The coordinate in the parameter vector.
+     * @param  floor The proposal is rejected below this difference.
+     * @return The logged difference, or an upper bound of it below 
+     *         %floor.
+     * 
+     * The new terms are evaluated chunk by chunk, see @ref evaluate, 
+     * and the evaluation stops as soon as the chunks done plus the 
+     * bounds of the others, see mcmc_likelihood::upperBound, fall 
+     * below %floor. Gives the same difference as @ref propose if it
+     * does not stop.
+     * 
+     */
+    virtual double proposeBounded(int whatami, double newpar, int which, double floor) {
+        size_t coord = which;
+        
+        return proposeCoords(whatami, &coord, &newpar, 1, floor);
+    }
+    
+    /**
+     * 
+     * @brief  Bounds the difference of a proposal from above without
+     *         evaluating the likelihood.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  newpar The candidate.
+     * @param  which The coordinate in the parameter vector.
+     * @return mcmc_likelihood::upperBound at the candidate minus the 
+     *         current value, HUGE_VAL if the likelihood has no bound
+     *         or the proposal only recomputes the terms depending on 
+     *         the coordinate.
+     * 
+     * Makes the arguments at the candidate, a pass over the arguments
+     * but not over the terms, and restores the state.
+     * 
+     */
+    virtual double changeBound(int whatami, double newpar, int which) {
+        size_t coord = which;
+        restoreCurrent();
+        if(!bounded || (collectTerms(whatami, &coord, 1) && 2 * terms.size() <= numTerms())) {
+            return HUGE_VAL;
+        }
+        changeParameters(whatami, newpar, coord);
+        new_args.resize(argms.size(), numTerms());
+        for(size_t i = 0; i < argms.size(); ++i) {
+            new_args.bind(i, argms[i]->makeArgument(node_views, new_args.column(i)));
+        }
+        double bound = lik->upperBound(new_args.views()) - current_value;
+        reject();
+        
+        return bound;
+    }
+    
+    /**
+     * 
+     * @brief  Adds the derivatives of the bond with respect to a 
+     *         parameter.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  grad Derivatives with respect to the coordinates of the
+     *         parameter, the derivatives of the bond are added.
+     * @return True, if the likelihood is separable and the likelihood
+     *         and all %argument_makers provide derivatives.
+     * 
+     * The likelihood writes the derivative of each term with respect 
+     * to each argument into %grad_args, chunk by chunk like 
+     * @ref evaluate, and the %argument_makers propagate them to the
+     * coordinates of the parameter (chain rule). The state is the 
+     * one in %preargs, i.e. including a pending proposal.
+     * 
+     */
+    virtual bool gradient(int whatami, std::vector<double> &grad) {
+        if(!lik->isSeparable() || !lik->hasGradient()) {
+            return false;
+        }
+        for(size_t k = 0; k < argms.size(); ++k) {
+            if(!argms[k]->hasGradient()) {
+                return false;
             }
-            this->value_computed = true;
-            current_value = lik.compute(args);
-            logr -= current_value;
         }
+        size_t n = numTerms();
+        new_args.resize(argms.size(), n);
+        grad_args.resize(argms.size(), n);
+        grad_columns.resize(argms.size());
+        for(size_t k = 0; k < argms.size(); ++k) {
+            new_args.bind(k, argms[k]->makeArgument(node_views, new_args.column(k)));
+            grad_columns[k] = grad_args.column(k);
+        }
+        differentiate(new_args.views(), n);
+        for(size_t k = 0; k < argms.size(); ++k) {
+            addCoordinates(k, whatami, grad_columns[k], grad);
+        }
+        
+        return true;
     }
     
     /**
      * 
-     * @brief  Computes all necessary steps to update the bond.
-     * @param  whatami Determines the affiliation to the appropriate 
-     *         @ref mcmc_parameter vector.
-     * @param  newpar The new proposal for the parameter in turn. 
-     * @param  which Defines the entry in the parameter vector for which the 
-     *         change in bond should be determined. 
-     * @return The computed bond value.
+     * @brief  Collects the terms depending on a coordinate.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which Index of the coordinate.
+     * @param  terms The indices of the terms are appended, sorted and
+     *         without duplicates.
+     * @return True, if the likelihood is separable and every 
+     *         %argument_maker knows its dependent entries.
      * 
-     * For all steps (stages) of the process see the comment 
-     * on @ref stage1().
+     */
+    virtual bool dependentTerms(int whatami, size_t which, std::vector<size_t> &terms) const {
+        if(!lik->isSeparable() || isBroadcast(whatami)) {
+            return false;
+        }
+        size_t first = terms.size();
+        for(size_t k = 0; k < argms.size(); ++k) {
+            if(!argms[k]->dependentTerms(whatami, which, terms)) {
+                return false;
+            }
+        }
+        std::sort(terms.begin() + first, terms.end());
+        terms.erase(std::unique(terms.begin() + first, terms.end()), terms.end());
+        
+        return true;
+    }
+    
+    /**
+     * 
+     * @brief  Computes the difference in the terms of one coordinate.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which Index of the coordinate.
+     * @param  newpar The candidate.
+     * @return The logged difference of the bond.
+     * 
+     * Like @ref computeIncremental, with the terms summed in the same
+     * order, but with scratch space of the calling thread and the old
+     * value written back at the end. The
+     * coordinate is the only entry of %preargs written, so calls for
+     * coordinates without common terms do not interfere. If the terms
+     * are not known, see @ref dependentTerms, the difference is 
+     * computed from all terms by @ref propose and rejected, and the 
+     * call must not run concurrently with others.
      * 
      */
-    virtual double compute(int whatami, double newpar, int which) {
-        stage1();
-        changeParameters(whatami, newpar, which);
-        addNew();
-
-        return logr;
+    virtual double proposeCoordinate(int whatami, size_t which, double newpar) {
+        static thread_local std::vector<size_t> local_terms;
+        static thread_local std::vector<double> local_row;
+        static thread_local bond_arg_matrix local_args;
+        local_terms.clear();
+        if(!dependentTerms(whatami, which, local_terms)) {
+            double diff = propose(whatami, newpar, which);
+            reject();
+            
+            return diff;
+        }
+        if(local_terms.empty()) {
+            return 0;
+        }
+        local_row.resize(argms.size());
+        double old = preargs[whatami][which];
+        double diff = 0;
+        bool contiguous = local_terms.back() - local_terms.front() + 1 == local_terms.size();
+        for(int pass = 0; pass < 2; ++pass) {
+            preargs[whatami][which] = pass == 0 ? old : newpar;
+            double sign = pass == 0 ? -1.0 : 1.0;
+            if(contiguous) {
+                size_t begin = local_terms.front();
+                size_t end = local_terms.back() + 1;
+                local_args.resize(argms.size(), end - begin);
+                for(size_t k = 0; k < argms.size(); ++k) {
+                    local_args.bind(k, argms[k]->makeArgumentRange(node_views, begin, end, local_args.column(k)));
+                }
+                diff += sign * lik->evaluate(local_args.views());
+            } else {
+                for(size_t t = 0; t < local_terms.size(); ++t) {
+                    for(size_t k = 0; k < argms.size(); ++k) {
+                        local_row[k] = argms[k]->getArgumentAt(node_views, local_terms[t]);
+                    }
+                    diff += sign * lik->computeTerm(local_row);
+                }
+            }
+        }
+        preargs[whatami][which] = old;
+        
+        return diff;
+    }
+    
+    /**
+     * 
+     * @brief  Indicates if the bond is conjugate in a parameter.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @return True, if the likelihood is separable, the parameter 
+     *         enters exactly one argument, as a selection, and the 
+     *         likelihood is conjugate in this argument.
+     * 
+     */
+    virtual bool isConjugate(int whatami) const {
+        return conjugateArgument(whatami) < argms.size();
+    }
+    
+    /**
+     * 
+     * @brief Adds the coefficients of the sufficient statistics of a
+     *        parameter.
+     * @param whatami Index of the parameter vector in the bond.
+     * @param stats The coefficients of the bond are added, one vector
+     *        per statistic.
+     * 
+     * The likelihood writes the coefficients of each term into 
+     * %stat_args, chunk by chunk like @ref evaluate, and the 
+     * %argument_maker of the conjugate argument sums them per 
+     * coordinate. This is one pass over the terms, the value of the
+     * bond is not computed.
+     * 
+     */
+    virtual void addStatistics(int whatami, std::vector<std::vector<double> > &stats) {
+        reject();
+        size_t arg = conjugateArgument(whatami);
+        size_t n = numTerms();
+        new_args.resize(argms.size(), n);
+        for(size_t k = 0; k < argms.size(); ++k) {
+            new_args.bind(k, argms[k]->makeArgument(node_views, new_args.column(k)));
+        }
+        stat_args.resize(CONJUGATE_STATS, n);
+        grad_columns.resize(CONJUGATE_STATS);
+        for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+            grad_columns[j] = stat_args.column(j);
+        }
+        collectStatistics(new_args.views(), arg, n);
+        for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+            addCoordinates(arg, whatami, grad_columns[j], stats[j]);
+        }
+    }
+    
+    /**
+     * 
+     * @brief Attaches the nodes and copies their values.
+     * @param nodes The nodes in the order of the bond's arguments.
+     * 
+     */
+    virtual void attach(std::vector<mcmc_node const*> const &nodes) {
+        this->nodes = nodes;
+        prepareArgs();
     }
     
     /**
      * 
-     * @brief If the current value is accepted this function updates the 
-     *        current_value of the bond. 
+     * @brief  Copies the bond without its nodes.
+     * @return A bond sharing the likelihood and the %argument_makers.
+     * 
+     * Inheriting classes override the function to copy themselves.
+     * 
+     */
+    virtual mcmc_bond *clone() const {
+        return new basic_mcmc_bond(argms, lik);
+    }
+    
+    /**
+     * 
+     * @brief Sets the pool used to evaluate chunks in parallel.
+     * @param pool The pool, or null for serial evaluation. Not owned.
+     * 
+     */
+    virtual void setThreadPool(thread_pool *pool) {
+        this->pool = pool;
+    }
+    
+    /**
      * 
-     * The function is usually called by a class implementing the interface 
-     * class  @ref mcmc_update.
+     * @brief  Returns the number of likelihood terms, the largest 
+     *         length of the arguments.
      * 
-     * @see mcmc_update.
+     * Inherited from @ref mcmc_bond.
      * 
      */
-    virtual void revise() {
-        current_value = new_value;
+    virtual size_t numTerms() const {
+        size_t n = 0;
+        for(size_t k = 0; k < argms.size(); ++k) {
+            n = std::max(n, argms[k]->getSize(node_views));
+        }
+        
+        return n;
     }
     
+    /**
+     * 
+     * @brief Number of terms in a chunk of a separable likelihood.
+     * 
+     */
+    static size_t const CHUNK_TERMS = 16384;
+    
     /**
      *
      * @brief Container collecting all %argument_makers to be
@@ -167,139 +468,558 @@ public:
      * @see group_argument_maker
      * 
      */
-    std::vector<argument_maker> argms;
+    std::vector<boost::shared_ptr<argument_maker> > argms;
     
     /**
      * @brief The likelihood function determining the model. 
      * 
      */
-    mcmc_likelihood lik;
+    boost::shared_ptr<mcmc_likelihood> lik;
     
     /**
-     * @brief Parameters used in this %mcmc_bond.
+     * @brief Parameters and data used in this %mcmc_bond.
+     * 
+     * The nodes are referenced, not copied, and have to outlive the
+     * bond.
      *  
      */
-    std::vector<mcmc_parameter> par;
+    std::vector<mcmc_node const*> nodes;
     
 private:
     
     /**
      * 
-     * @brief Performs first steps of the bond computation.
+     * @brief  Computes the change of the bond for a proposal of one or
+     *         more coordinates of a parameter.
      * 
-     * Altogether there are three steps: 
-     *  1. Set the log-value to its initial state = zero. 
-     *     Prepare all parameters (nodes) for their transformation
-     *     through @link argument_makers. And subtract the old log-
-     *     value from the new one 
-     *  2. Set the relevant parameters (nodes) to be changed. 
-     *  3. Calculate the logged difference of the bond.
+     * The candidates are written into %preargs and the replaced values
+     * are kept as undo record. If the likelihood is separable and 
+     * every %argument_maker knows which of its entries depend on the
+     * coordinates, only these terms are recomputed, see 
+     * @ref computeIncremental(). Otherwise the new value is computed
+     * from all terms, see @ref addNew().
+     * 
+     * Inherited from @ref staged_bond.
      * 
      */
-    void stage1() {
-        logr = 0;
-        prepareArgs();
-        subtractOld();
+    virtual double proposeCoords(int const whatami, size_t const *which, double const *cand, size_t const count) {
+        return proposeCoords(whatami, which, cand, count, -HUGE_VAL);
     }
     
     /**
      * 
-     * @brief Stores the relevant parameters to be changed into the %preargs
-     *        vector.
-     * @param whatami Indicates which @ref mcmc_parameter is relevant to 
-     *        compute the bond.
-     * @param cand the proposed candidate for the parameter in turn.
-     * @param which The parameter which is in turn.
+     * @brief  Computes the change of the bond for a proposal of one or
+     *         more coordinates of a parameter.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which The coordinates.
+     * @param  cand The candidates, one per coordinate.
+     * @param  count Number of coordinates.
+     * @param  floor The evaluation may stop below this difference, see
+     *         @ref proposeBounded.
+     * @return The logged difference of the bond.
      * 
-     * Remember in the %preargs are several columns (%vectors) as there maybe
-     * several parameter vectors belonging to a bond.
-     * Note also, that %whatami is the integer vector in @ref mcmc_parameter 
-     * that is relevant for the bond, i.e. that became the %mcmc_bond added.  
+     * If more than half of the terms depend on the coordinates, all 
+     * terms are recomputed in one pass.
      * 
      */
-    void changeParameters(int const whatami, double const cand, int const which) {
-        preargs[whatami][which] = cand;
+    double proposeCoords(int const whatami, size_t const *which, double const *cand, size_t const count,
+        double const floor) {
+        restoreCurrent();
+        if(collectTerms(whatami, which, count) && 2 * terms.size() <= numTerms()) {
+            return computeIncremental(whatami, which, cand, count, floor);
+        }
+        for(size_t c = 0; c < count; ++c) {
+            changeParameters(whatami, cand[c], which[c]);
+        }
+        addNew(floor);
+
+        return logr;
     }
     
     /**
      * 
      * @brief Calculates the value of the likelihood for the new value proposed.
+     * @param floor The evaluation may stop once the difference is 
+     *        certainly below %floor, see @ref evaluate.
      * 
      * The function first transforms the parameters values (data values) via 
      * the appropriate @ref argument_maker. 
-     * Then the transformed values are used in the likelihood term to be added to the 
-     * %basic_mcmc_bond::logr value. 
+     * Then the transformed values are used in the likelihood term, the 
+     * difference to the current value is stored in %basic_mcmc_bond::logr. 
      * 
      */
-    void addNew() {
-        for(size_t i = 0; i < args.size(); ++i) {
-            new_args[i] = am[i].getArgument(preargs); 
+    void addNew(double const floor = -HUGE_VAL) {
+        new_args.resize(argms.size(), numTerms());
+        for(size_t i = 0; i < argms.size(); ++i) {
+            new_args.bind(i, argms[i]->makeArgument(node_views, new_args.column(i))); 
         }   
-        new_value = lik.compute(new_args);
-        logr += new_value;
+        new_value = evaluate(new_args.views(), floor + current_value);
+        logr = new_value - current_value;
     }
     
     /**
-     * @brief Determines if the bond has been already computed. 
+     * 
+     * @brief  Collects the likelihood terms that depend on any of the 
+     *         parameter coordinates into %terms.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which Indices of the coordinates in that parameter vector.
+     * @param  count Number of coordinates.
+     * @return True, if only the collected terms have to be recomputed.
      * 
      */
-    bool value_computed;
+    bool collectTerms(int const whatami, size_t const *which, size_t const count) {
+        if(!lik->isSeparable() || isBroadcast(whatami)) {
+            return false;
+        }
+        terms.clear();
+        for(size_t c = 0; c < count; ++c) {
+            for(size_t i = 0; i < argms.size(); ++i) {
+                if(!argms[i]->dependentTerms(whatami, which[c], terms)) {
+                    return false;
+                }
+            }
+        }
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+        
+        return true;
+    }
     
     /**
-     * @brief Stores the value of the logged bond. 
+     * 
+     * @brief  Computes the bond difference from the terms in %terms only.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which Indices of the coordinates in that parameter vector.
+     * @param  cand The proposed candidates for the coordinates.
+     * @param  count Number of coordinates.
+     * @param  floor The evaluation of a contiguous range may stop below
+     *         this difference, see @ref evaluate.
+     * @return The logged difference of the bond.
+     * 
+     * The old contributions of the touched terms are subtracted, the 
+     * candidates are put into %preargs and the new contributions are 
+     * added. Contiguous terms are evaluated as one range. The cost is 
+     * linear in the number of touched terms, not in the size of the 
+     * data.
      * 
      */
-    double logr;
+    double computeIncremental(int const whatami, size_t const *which, double const *cand, size_t const count,
+        double const floor) {
+        bool contiguous = !terms.empty() && terms.back() - terms.front() + 1 == terms.size();
+        logr = contiguous ? -computeRange(terms.front(), terms.back() + 1) : 0;
+        for(size_t t = 0; !contiguous && t < terms.size(); ++t) {
+            logr -= lik->computeTerm(makeRow(terms[t]));
+        }
+        for(size_t c = 0; c < count; ++c) {
+            changeParameters(whatami, cand[c], which[c]);
+        }
+        if(contiguous) {
+            logr += computeRange(terms.front(), terms.back() + 1, floor - logr);
+        }
+        for(size_t t = 0; !contiguous && t < terms.size(); ++t) {
+            logr += lik->computeTerm(makeRow(terms[t]));
+        }
+        new_value = current_value + logr;
+        
+        return logr;
+    }
     
     /**
-     * @brief Stores the current value of the bond.
+     * 
+     * @brief  Computes the sum of a contiguous range of likelihood terms.
+     * @param  begin Index of the first term.
+     * @param  end Index one past the last term.
+     * @param  floor The evaluation may stop below this sum, see 
+     *         @ref evaluate.
+     * @return Sum of the terms [begin, end).
+     * 
+     * The range is evaluated in one call to the likelihood on views 
+     * of the arguments restricted to the range, e.g. the observations 
+     * of a group together with a broadcast of the group value.
      * 
      */
-    double current_value;
+    double computeRange(size_t const begin, size_t const end, double const floor = -HUGE_VAL) {
+        range_args.resize(argms.size(), end - begin);
+        for(size_t k = 0; k < argms.size(); ++k) {
+            range_args.bind(k, argms[k]->makeArgumentRange(node_views, begin, end, range_args.column(k)));
+        }
+        
+        return evaluate(range_args.views(), floor);
+    }
     
     /**
-     * @brief Stores the new value of the bond.
      * 
-     * The new value is the value for the proposed 
-     * parameters.
+     * @brief  Evaluates the likelihood on views of the arguments.
+     * @param  views Views on the arguments.
+     * @param  floor Sum below which the evaluation may stop.
+     * @return The sum of the likelihood terms or, if the evaluation
+     *         stopped, an upper bound of it below %floor.
+     * 
+     * Splits separable likelihoods into chunks of %CHUNK_TERMS terms,
+     * evaluates them on %pool, if set, and sums them in order.
+     * 
+     * With a floor the chunks are evaluated in rounds of one chunk per
+     * thread. After each round the sum of the chunks done plus the 
+     * bounds of the others, see mcmc_likelihood::upperBound, is an 
+     * upper bound of the sum, and the evaluation stops once it is 
+     * below %floor, e.g. at a chunk outside the support. A sum that is
+     * not stopped is the same as without a floor.
      * 
      */
-    double new_value;
+    double evaluate(std::vector<argument_view> const &views, double const floor = -HUGE_VAL) {
+        size_t n = 0;
+        for(size_t k = 0; k < views.size(); ++k) {
+            n = std::max(n, views[k].size());
+        }
+        bool bounded = floor > -HUGE_VAL;
+        if(n <= CHUNK_TERMS || !lik->isSeparable()) {
+            double bound = bounded ? lik->upperBound(views) : HUGE_VAL;
+            
+            return bound < floor ? bound : lik->evaluate(views);
+        }
+        size_t nchunks = (n + CHUNK_TERMS - 1) / CHUNK_TERMS;
+        if(chunk_views.size() < nchunks) {
+            chunk_views.resize(nchunks);
+            chunk_sums.resize(nchunks);
+        }
+        if(bounded && chunk_bounds.size() < nchunks) {
+            chunk_bounds.resize(nchunks);
+        }
+        double remaining = 0;
+        for(size_t c = 0; c < nchunks; ++c) {
+            std::vector<argument_view> &part = chunk_views[c];
+            part.resize(views.size());
+            for(size_t k = 0; k < views.size(); ++k) {
+                part[k] = views[k].slice(c * CHUNK_TERMS, std::min(n, (c + 1) * CHUNK_TERMS));
+            }
+            if(bounded) {
+                chunk_bounds[c] = lik->upperBound(part);
+                remaining += chunk_bounds[c];
+            }
+        }
+        if(remaining < floor) {
+            return remaining;
+        }
+        size_t round = !bounded ? nchunks : (pool != 0 ? pool->size() : 1);
+        double sum = 0;
+        for(size_t first = 0; first < nchunks; first += round) {
+            size_t count = std::min(round, nchunks - first);
+            std::function<void(size_t)> chunk = [this, first](size_t c) {
+                chunk_sums[first + c] = lik->evaluate(chunk_views[first + c]);
+            };
+            if(pool != 0 && count > 1) {
+                pool->run(count, chunk);
+            } else {
+                for(size_t c = 0; c < count; ++c) {
+                    chunk(c);
+                }
+            }
+            for(size_t c = first; c < first + count; ++c) {
+                sum += chunk_sums[c];
+                if(bounded && remaining < HUGE_VAL) {
+                    remaining -= chunk_bounds[c];
+                }
+            }
+            if(bounded && first + count < nchunks && !(sum + remaining >= floor)) {
+                return std::isnan(sum + remaining) ? -HUGE_VAL : sum + remaining;
+            }
+        }
+        
+        return sum;
+    }
     
     /**
      * 
-     * @brief Stores the @link argument_makers for preparing
-     *        the parameters.
-     *    
-     * @see argument_maker
+     * @brief Computes the derivatives of all terms into %grad_columns.
+     * @param views Views on the arguments.
+     * @param n Number of terms.
+     * 
+     * Splits the terms into chunks of %CHUNK_TERMS terms, which write 
+     * disjoint parts of %grad_args and run on %pool, if set.
      * 
      */
-    std::vector<argument_maker> am;
+    void differentiate(std::vector<argument_view> const &views, size_t n) {
+        size_t nchunks = (n + CHUNK_TERMS - 1) / CHUNK_TERMS;
+        if(nchunks <= 1) {
+            lik->gradient(views, grad_columns);
+            return;
+        }
+        if(chunk_views.size() < nchunks) {
+            chunk_views.resize(nchunks);
+            chunk_sums.resize(nchunks);
+        }
+        if(chunk_grads.size() < nchunks) {
+            chunk_grads.resize(nchunks);
+        }
+        std::function<void(size_t)> chunk = [this, &views, n](size_t c) {
+            std::vector<argument_view> &part = chunk_views[c];
+            std::vector<double*> &out = chunk_grads[c];
+            part.resize(views.size());
+            out.resize(views.size());
+            for(size_t k = 0; k < views.size(); ++k) {
+                part[k] = views[k].slice(c * CHUNK_TERMS, std::min(n, (c + 1) * CHUNK_TERMS));
+                out[k] = grad_columns[k] + c * CHUNK_TERMS;
+            }
+            lik->gradient(part, out);
+        };
+        if(pool != 0) {
+            pool->run(nchunks, chunk);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                chunk(c);
+            }
+        }
+    }
     
     /**
      * 
-     * @brief Stores the prepared values for computing the 
-     *        the bond.
+     * @brief Computes the coefficients of the sufficient statistics of
+     *        all terms into %grad_columns.
+     * @param views Views on the arguments.
+     * @param arg Index of the conjugate argument.
+     * @param n Number of terms.
+     * 
+     * Splits the terms into chunks like @ref differentiate.
      * 
      */
-    std::vector<std::vector<double> > args;
+    void collectStatistics(std::vector<argument_view> const &views, size_t arg, size_t n) {
+        size_t nchunks = (n + CHUNK_TERMS - 1) / CHUNK_TERMS;
+        if(nchunks <= 1) {
+            lik->sufficientStatistics(views, arg, grad_columns);
+            return;
+        }
+        if(chunk_views.size() < nchunks) {
+            chunk_views.resize(nchunks);
+            chunk_sums.resize(nchunks);
+        }
+        if(chunk_grads.size() < nchunks) {
+            chunk_grads.resize(nchunks);
+        }
+        std::function<void(size_t)> chunk = [this, &views, arg, n](size_t c) {
+            std::vector<argument_view> &part = chunk_views[c];
+            std::vector<double*> &out = chunk_grads[c];
+            part.resize(views.size());
+            out.resize(CONJUGATE_STATS);
+            for(size_t k = 0; k < views.size(); ++k) {
+                part[k] = views[k].slice(c * CHUNK_TERMS, std::min(n, (c + 1) * CHUNK_TERMS));
+            }
+            for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+                out[j] = grad_columns[j] + c * CHUNK_TERMS;
+            }
+            lik->sufficientStatistics(part, arg, out);
+        };
+        if(pool != 0) {
+            pool->run(nchunks, chunk);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                chunk(c);
+            }
+        }
+    }
     
     /**
      * 
-     * @brief Stores the parameters before preparing them via
-     *        @link argument_maker.
+     * @brief  Finds the argument a parameter enters conjugately.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @return Index of the argument, or the number of arguments if the
+     *         bond is not conjugate in the parameter.
      * 
-     * @see argument_maker
+     */
+    size_t conjugateArgument(int whatami) const {
+        size_t arg = argms.size();
+        if(!lik->isSeparable()) {
+            return arg;
+        }
+        for(size_t k = 0; k < argms.size(); ++k) {
+            if(!argms[k]->dependsOn(whatami)) {
+                continue;
+            }
+            if(arg < argms.size() || !argms[k]->isSelection(whatami) || !argms[k]->hasGradient()) {
+                return argms.size();
+            }
+            arg = k;
+        }
+        
+        return arg < argms.size() && lik->isConjugate(arg) ? arg : argms.size();
+    }
+    
+    /**
+     * 
+     * @brief Adds per-term derivatives of argument k to the 
+     *        coordinates of a parameter through its %argument_maker.
+     * @param k Index of the argument.
+     * @param whatami Index of the parameter vector in the bond.
+     * @param grad One entry per term.
+     * @param out One entry per coordinate of the parameter.
+     * 
+     * A broadcast parameter, see staged_bond::nodeView, is shown to
+     * the maker as a vector of one entry per term. The entries are 
+     * summed into its single coordinate.
      * 
      */
-    std::vector<std::vector<double> > preargs;
+    void addCoordinates(size_t const k, int const whatami, double const *grad, std::vector<double> &out) {
+        if(!isBroadcast(whatami)) {
+            argms[k]->addGradient(node_views, whatami, grad, out);
+            return;
+        }
+        spread_views = node_views;
+        spread_views[whatami] = argument_view(node_views[whatami].data, 0, numTerms());
+        spread.assign(numTerms(), 0.0);
+        argms[k]->addGradient(spread_views, whatami, grad, spread);
+        for(size_t i = 0; i < spread.size(); ++i) {
+            out[0] += spread[i];
+        }
+    }
+    
+    /**
+     * 
+     * @brief  Fills %row with the i-th entry of every argument.
+     * @param  i Index of the likelihood term.
+     * @return %row.
+     * 
+     */
+    std::vector<double> const &makeRow(size_t const i) {
+        for(size_t k = 0; k < argms.size(); ++k) {
+            row[k] = argms[k]->getArgumentAt(node_views, i);
+        }
+        
+        return row;
+    }
+    
+    /**
+     * @brief Stores the logged difference of the bond for the last
+     *        proposal. 
+     * 
+     */
+    double logr;
+    
+    /**
+     * 
+     * @brief Stores the prepared values for computing the 
+     *        the bond.
+     * 
+     * The storage is owned by the bond and kept across iterations, 
+     * such that the @ref argument_makers can write into it without
+     * allocating. Arguments that need no storage are bound to views
+     * on the parameters instead.
+     * 
+     * @see bond_arg_matrix
+     * 
+     */
+    bond_arg_matrix args;
     
     /**
      * @brief Stores the new parameters (nodes) after being prepared
      *        for bond computation.
      * 
      */
-    std::vector<std::vector<double> > new_args;
+    bond_arg_matrix new_args;
+    
+    /**
+     * 
+     * @brief Indices of the likelihood terms touched by the current 
+     *        proposal.
+     * 
+     * Kept as a member to avoid allocations in each step.
+     * 
+     */
+    std::vector<size_t> terms;
+    
+    /**
+     * 
+     * @brief Stores the arguments of a range of likelihood terms.
+     * 
+     */
+    bond_arg_matrix range_args;
+    
+    /**
+     * 
+     * @brief Stores the arguments of a single likelihood term.
+     * 
+     */
+    std::vector<double> row;
+    
+    /**
+     * 
+     * @brief Pool for the parallel evaluation of chunks, not owned.
+     * 
+     */
+    thread_pool *pool;
+    
+    /**
+     * 
+     * @brief Determines if the likelihood has an upper bound at the 
+     *        current state, see @ref changeBound.
+     * 
+     */
+    bool bounded;
+    
+    /**
+     * 
+     * @brief Views on the arguments of each chunk.
+     * 
+     */
+    std::vector<std::vector<argument_view> > chunk_views;
+    
+    /**
+     * 
+     * @brief Sums of the chunks, reduced in order.
+     * 
+     */
+    std::vector<double> chunk_sums;
+    
+    /**
+     * 
+     * @brief Upper bounds of the chunks of a bounded evaluation.
+     * 
+     */
+    std::vector<double> chunk_bounds;
+    
+    /**
+     * 
+     * @brief Stores the derivatives of the terms with respect to the
+     *        arguments, one column per argument.
+     * 
+     */
+    bond_arg_matrix grad_args;
+    
+    /**
+     * 
+     * @brief The columns of %grad_args, or of %stat_args while the 
+     *        statistics are collected.
+     * 
+     */
+    std::vector<double*> grad_columns;
+    
+    /**
+     * 
+     * @brief Stores the coefficients of the sufficient statistics of 
+     *        the terms, one column per statistic.
+     * 
+     */
+    bond_arg_matrix stat_args;
+    
+    /**
+     * 
+     * @brief The columns of %grad_args restricted to each chunk.
+     * 
+     */
+    std::vector<std::vector<double*> > chunk_grads;
+    
+    /**
+     * 
+     * @brief The views of the nodes with a broadcast parameter at the
+     *        length of the terms, see @ref addCoordinates.
+     * 
+     */
+    std::vector<argument_view> spread_views;
+    
+    /**
+     * 
+     * @brief Derivatives of a broadcast parameter per term.
+     * 
+     */
+    std::vector<double> spread;
 };
 #endif	/* BASIC_MCMC_BOND_H */
 
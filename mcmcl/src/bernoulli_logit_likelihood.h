@@ -0,0 +1,149 @@
+/**
+ *
+ * @file bernoulli_logit_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 12, 2012, 2:15 PM
+ *
+ * @brief Log-probability of the Bernoulli distribution with
+ *        logit-parametrized success probability.
+ *
+ * Columns: outcomes y in {0, 1} and log-odds eta. The log-probability
+ * is y * eta - log(1 + exp(eta)).
+ *
+ * @see binomial_logit_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef BERNOULLI_LOGIT_LIKELIHOOD_H
+#define	BERNOULLI_LOGIT_LIKELIHOOD_H
+
+#include <cmath>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief  Computes log(1 + exp(eta)) without overflow.
+ *
+ */
+template<class V>
+inline typename V::reg simd_softplus(typename V::reg eta) {
+    return V::add(V::max(eta, V::zero()), V::log1p(V::exp(V::sub(V::zero(), V::abs(eta)))));
+}
+
+/**
+ *
+ * @brief Bernoulli-logit log-probability kernel for the instruction
+ *        set V.
+ *
+ */
+template<class V>
+class bernoulli_logit_kernel {
+public:
+
+    bernoulli_logit_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), eta(args[1]) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg e = eta(i);
+
+        return V::sub(V::mul(y(i), e), simd_softplus<V>(e));
+    }
+
+    simd_column<V> y, eta;
+};
+
+class bernoulli_logit_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~bernoulli_logit_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y and eta.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y and eta.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        return simd_sum<bernoulli_logit_kernel>(args);
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-probability of a single observation.
+     * @param row y and eta of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return row[0] * row[1] - simd_softplus<simd_scalar>(row[1]);
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y and eta.
+     * @param grad Derivatives with respect to y and eta. The outcomes
+     *        are discrete, their derivative is set to zero.
+     *
+     * The derivative with respect to eta is y - 1 / (1 + exp(-eta)).
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            if(grad[0]) {
+                grad[0][i] = 0;
+            }
+            if(grad[1]) {
+                grad[1][i] = args[0][i] - 1 / (1 + std::exp(-args[1][i]));
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief  Bounds the log-likelihood, a log-probability of discrete
+     *         outcomes.
+     * @param  args Views on y and eta.
+     * @return Zero.
+     *
+     */
+    virtual double upperBound (std::vector<argument_view> const &args) {
+        return 0;
+    };
+};
+#endif	/* BERNOULLI_LOGIT_LIKELIHOOD_H */
+
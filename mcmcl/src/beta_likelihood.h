@@ -0,0 +1,157 @@
+/**
+ *
+ * @file beta_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 13, 2012, 9:45 AM
+ *
+ * @brief Log-density of the Beta distribution.
+ *
+ * Columns: observations y in (0, 1) and shapes a and b. The
+ * log-density is (a - 1) * log(y) + (b - 1) * log(1 - y) - log B(a, b).
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef BETA_LIKELIHOOD_H
+#define	BETA_LIKELIHOOD_H
+
+#include <cmath>
+#include <boost/math/special_functions/digamma.hpp>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Beta log-density kernel for the instruction set V, without
+ *        the Beta function.
+ *
+ */
+template<class V>
+class beta_kernel {
+public:
+
+    beta_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), a(args[1]), b(args[2]) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg x = y(i);
+        typename V::reg one = V::set1(1.0);
+        typename V::reg r = V::mul(V::sub(a(i), one), V::log(x));
+
+        return V::fmadd(V::sub(b(i), one), V::log1p(V::sub(V::zero(), x)), r);
+    }
+
+    simd_column<V> y, a, b;
+};
+
+class beta_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~beta_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y, a and b.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y, a and b.
+     *
+     * The Beta function is computed once if both shapes are broadcast
+     * scalars.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        size_t n = args[0].size();
+        double norm = 0;
+        if(args[1].isScalar() && args[2].isScalar()) {
+            norm = n * log_beta(args[1][0], args[2][0]);
+        } else {
+            for(size_t i = 0; i < n; ++i) {
+                norm += log_beta(args[1][i], args[2][i]);
+            }
+        }
+
+        return simd_sum<beta_kernel>(args) - norm;
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-density of a single observation.
+     * @param row y, a and b of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return (row[1] - 1) * std::log(row[0]) + (row[2] - 1) * std::log1p(-row[0]) - log_beta(row[1], row[2]);
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y, a and b.
+     * @param grad Derivatives with respect to y, a and b.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            double y = args[0][i];
+            double a = args[1][i];
+            double b = args[2][i];
+            double ab = (grad[1] || grad[2]) ? boost::math::digamma(a + b) : 0.0;
+            if(grad[0]) {
+                grad[0][i] = (a - 1) / y - (b - 1) / (1 - y);
+            }
+            if(grad[1]) {
+                grad[1][i] = std::log(y) - boost::math::digamma(a) + ab;
+            }
+            if(grad[2]) {
+                grad[2][i] = std::log1p(-y) - boost::math::digamma(b) + ab;
+            }
+        }
+    };
+
+private:
+
+    /**
+     *
+     * @brief Log of the Beta function B(a, b).
+     *
+     */
+    static double log_beta (double a, double b) {
+        return std::lgamma(a) + std::lgamma(b) - std::lgamma(a + b);
+    };
+};
+#endif	/* BETA_LIKELIHOOD_H */
+
@@ -0,0 +1,178 @@
+/**
+ *
+ * @file binomial_logit_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 12, 2012, 3:00 PM
+ *
+ * @brief Log-probability of the Binomial distribution with
+ *        logit-parametrized success probability.
+ *
+ * Columns: successes y, trials n and log-odds eta. The log-probability
+ * is y * eta - n * log(1 + exp(eta)) + log(n choose y).
+ *
+ * @see bernoulli_logit_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef BINOMIAL_LOGIT_LIKELIHOOD_H
+#define	BINOMIAL_LOGIT_LIKELIHOOD_H
+
+#include <cmath>
+#include "mcmc_likelihood.h"
+#include "bernoulli_logit_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Binomial-logit log-probability kernel for the instruction
+ *        set V, without the binomial coefficient.
+ *
+ */
+template<class V>
+class binomial_logit_kernel {
+public:
+
+    binomial_logit_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), trials(args[1]), eta(args[2]) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg e = eta(i);
+
+        return V::fnmadd(trials(i), simd_softplus<V>(e), V::mul(y(i), e));
+    }
+
+    simd_column<V> y, trials, eta;
+};
+
+class binomial_logit_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Constructor.
+     * @param normalized If false, the binomial coefficient, which
+     *        depends on the data only, is left out. Differences of
+     *        bond values are not affected by this.
+     *
+     */
+    binomial_logit_likelihood (bool normalized = true) : normalized(normalized) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~binomial_logit_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y, n and eta.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y, n and eta.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        double sum = simd_sum<binomial_logit_kernel>(args);
+        if(normalized) {
+            for(size_t i = 0; i < args[0].size(); ++i) {
+                sum += log_choose(args[1][i], args[0][i]);
+            }
+        }
+
+        return sum;
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-probability of a single observation.
+     * @param row y, n and eta of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return row[0] * row[2] - row[1] * simd_softplus<simd_scalar>(row[2]) +
+            (normalized ? log_choose(row[1], row[0]) : 0.0);
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y, n and eta.
+     * @param grad Derivatives with respect to y, n and eta. Successes
+     *        and trials are discrete, their derivatives are set to 
+     *        zero.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            if(grad[0]) {
+                grad[0][i] = 0;
+            }
+            if(grad[1]) {
+                grad[1][i] = 0;
+            }
+            if(grad[2]) {
+                grad[2][i] = args[0][i] - args[1][i] / (1 + std::exp(-args[2][i]));
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief  Bounds the log-likelihood, a log-probability of discrete
+     *         outcomes.
+     * @param  args Views on y, n and eta.
+     * @return Zero without the binomial coefficient, else HUGE_VAL.
+     *
+     */
+    virtual double upperBound (std::vector<argument_view> const &args) {
+        return normalized ? HUGE_VAL : 0.0;
+    };
+
+    /**
+     *
+     * @brief Determines if the binomial coefficient is included.
+     *
+     */
+    bool normalized;
+
+private:
+
+    /**
+     *
+     * @brief Log of the binomial coefficient n choose k.
+     *
+     */
+    static double log_choose (double n, double k) {
+        return log_factorial(n) - log_factorial(k) - log_factorial(n - k);
+    };
+};
+#endif	/* BINOMIAL_LOGIT_LIKELIHOOD_H */
+
@@ -0,0 +1,254 @@
+/**
+ *
+ * @file block_proposal.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 21, 2012, 3:30 PM
+ *
+ * @brief Adaptive Gaussian random walk for a block of coordinates.
+ *
+ * A %block_proposal moves several coordinates of an
+ * @ref mcmc_parameter jointly, x' = x + L z with z standard normal and
+ * L the Cholesky factor of the proposal covariance. It starts from the
+ * diagonal covariance given by the step sizes and adapts to the chain
+ * history (Haario, Saksman and Tamminen, 2001): the mean and the
+ * covariance C of the visited states are updated after each step and
+ * every %ADAPT_INTERVAL steps the proposal covariance is set to
+ * 2.38^2 / d * (C + eps * diag(C)), d the size of the block. The
+ * factorization costs O(d^3), the update of the history O(d^2).
+ *
+ * @see mcmc_parameter::setBlocks
+ *
+ */
+#ifndef BLOCK_PROPOSAL_H
+#define	BLOCK_PROPOSAL_H
+
+#include <cmath>
+#include <vector>
+
+/**
+ *
+ * @brief Relative regularization of the diagonal of the adapted
+ *        covariance.
+ *
+ */
+static double const BLOCK_PROPOSAL_EPSILON = 1e-6;
+
+class block_proposal {
+public:
+
+    /**
+     *
+     * @brief Number of steps before the covariance is adapted.
+     *
+     */
+    static size_t const ADAPT_START = 200;
+
+    /**
+     *
+     * @brief Number of steps between two factorizations of the
+     *        adapted covariance.
+     *
+     */
+    static size_t const ADAPT_INTERVAL = 50;
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param coords Indices of the coordinates in the parameter vector.
+     * @param mss Step sizes of the parameter, the initial proposal
+     *        standard deviations of the coordinates.
+     *
+     */
+    block_proposal(std::vector<size_t> const &coords, std::vector<double> const &mss) :
+    coords(coords), d(coords.size()), n(0), adaptive(true), mean(d, 0.0), m2(d * d, 0.0),
+    chol(d * d, 0.0), cov(d * d, 0.0), delta(d, 0.0) {
+        for(size_t k = 0; k < d; ++k) {
+            chol[k * d + k] = mss[coords[k]];
+        }
+    };
+
+    /**
+     *
+     * @brief Draws a candidate for the block.
+     * @param value The current parameter vector.
+     * @param z Standard normal draws, one per coordinate.
+     * @param cand Receives the candidates, one per coordinate.
+     *
+     */
+    void draw(std::vector<double> const &value, std::vector<double> const &z, std::vector<double> &cand) const {
+        cand.resize(d);
+        for(size_t i = 0; i < d; ++i) {
+            double step = 0;
+            for(size_t j = 0; j <= i; ++j) {
+                step += chol[i * d + j] * z[j];
+            }
+            cand[i] = value[coords[i]] + step;
+        }
+    }
+
+    /**
+     *
+     * @brief Adds the current state of the chain to the history.
+     * @param value The current parameter vector.
+     *
+     * Refactors the proposal covariance every %ADAPT_INTERVAL steps
+     * after %ADAPT_START. If the covariance is not positive definite,
+     * the former factor is kept.
+     *
+     */
+    void adapt(std::vector<double> const &value) {
+        if(!adaptive) {
+            return;
+        }
+        ++n;
+        for(size_t i = 0; i < d; ++i) {
+            delta[i] = value[coords[i]] - mean[i];
+            mean[i] += delta[i] / n;
+        }
+        for(size_t i = 0; i < d; ++i) {
+            for(size_t j = 0; j <= i; ++j) {
+                m2[i * d + j] += delta[i] * (value[coords[j]] - mean[j]);
+            }
+        }
+        if(n >= ADAPT_START && n % ADAPT_INTERVAL == 0) {
+            factorize();
+        }
+    }
+
+    /**
+     *
+     * @brief Switches the adaptation on or off, e.g. after burn-in.
+     *
+     */
+    void setAdaptive(bool adaptive) {
+        this->adaptive = adaptive;
+    }
+
+    /**
+     *
+     * @brief Indices of the coordinates in the parameter vector.
+     *
+     */
+    std::vector<size_t> const &coordinates() const {
+        return coords;
+    }
+
+    /**
+     *
+     * @brief Number of coordinates.
+     *
+     */
+    size_t size() const {
+        return d;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Computes the Cholesky factor of the scaled, regularized
+     *        sample covariance into %chol.
+     *
+     */
+    void factorize() {
+        double scale = 2.38 * 2.38 / d;
+        for(size_t i = 0; i < d; ++i) {
+            for(size_t j = 0; j <= i; ++j) {
+                cov[i * d + j] = scale * m2[i * d + j] / (n - 1);
+            }
+            cov[i * d + i] *= 1 + BLOCK_PROPOSAL_EPSILON;
+        }
+        /* in place on the lower triangle of cov */
+        for(size_t j = 0; j < d; ++j) {
+            double s = cov[j * d + j];
+            for(size_t k = 0; k < j; ++k) {
+                s -= cov[j * d + k] * cov[j * d + k];
+            }
+            if(!(s > 0)) {
+                return;
+            }
+            cov[j * d + j] = std::sqrt(s);
+            for(size_t i = j + 1; i < d; ++i) {
+                double t = cov[i * d + j];
+                for(size_t k = 0; k < j; ++k) {
+                    t -= cov[i * d + k] * cov[j * d + k];
+                }
+                cov[i * d + j] = t / cov[j * d + j];
+            }
+        }
+        for(size_t i = 0; i < d; ++i) {
+            for(size_t j = 0; j <= i; ++j) {
+                chol[i * d + j] = cov[i * d + j];
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Indices of the coordinates in the parameter vector.
+     *
+     */
+    std::vector<size_t> coords;
+
+    /**
+     *
+     * @brief Number of coordinates.
+     *
+     */
+    size_t d;
+
+    /**
+     *
+     * @brief Number of states in the history.
+     *
+     */
+    size_t n;
+
+    /**
+     *
+     * @brief Determines if the history is recorded.
+     *
+     */
+    bool adaptive;
+
+    /**
+     *
+     * @brief Mean of the history.
+     *
+     */
+    std::vector<double> mean;
+
+    /**
+     *
+     * @brief Sums of the products of the deviations from the mean,
+     *        lower triangle, row-major.
+     *
+     */
+    std::vector<double> m2;
+
+    /**
+     *
+     * @brief Cholesky factor of the proposal covariance, lower
+     *        triangle, row-major.
+     *
+     */
+    std::vector<double> chol;
+
+    /**
+     *
+     * @brief Scratch storage for the factorization.
+     *
+     */
+    std::vector<double> cov;
+
+    /**
+     *
+     * @brief Deviations of the current state from the former mean.
+     *
+     */
+    std::vector<double> delta;
+};
+
+#endif	/* BLOCK_PROPOSAL_H */
+
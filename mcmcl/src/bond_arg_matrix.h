@@ -0,0 +1,271 @@
+/**
+ *
+ * @file bond_arg_matrix.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 15, 2012, 11:00 AM
+ *
+ * @brief Contiguous storage for the arguments of a bond.
+ *
+ * The %bond_arg_matrix holds all argument columns of a bond in one
+ * aligned, column-major block. The distance between two columns is
+ * fixed and padded to a multiple of the alignment, such that every
+ * column starts on a cache line and can be read with unit stride.
+ * @ref argument_makers fill the columns, the @ref mcmc_likelihood
+ * reads them through the views returned by @ref views(). A column
+ * that needs no storage, e.g. a parameter vector or a broadcast
+ * constant, is bound to an external view instead.
+ *
+ * The block only grows, so resizing to the same or a smaller size
+ * does not allocate. It is not initialized, such that the pages of
+ * columns bound to external views, e.g. data read in place, are never
+ * touched and take no memory.
+ *
+ * @see basic_mcmc_bond
+ * @see argument_view
+ *
+ */
+#ifndef BOND_ARG_MATRIX_H
+#define	BOND_ARG_MATRIX_H
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include "argument_view.h"
+
+class bond_arg_matrix {
+public:
+
+    /**
+     *
+     * @brief Alignment of the columns in doubles, one cache line.
+     *
+     */
+    static size_t const ALIGN = 8;
+
+    /**
+     *
+     * @brief Default constructor, constructs an empty matrix.
+     *
+     */
+    bond_arg_matrix() : ncols(0), nrows(0), ld(0), offset(0), capacity(0) {};
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param ncols Number of columns.
+     * @param nrows Number of rows.
+     *
+     */
+    bond_arg_matrix(size_t ncols, size_t nrows) : ncols(0), nrows(0), ld(0), offset(0), capacity(0) {
+        resize(ncols, nrows);
+    };
+
+    /**
+     *
+     * @brief Copy constructor.
+     * @param other Other %bond_arg_matrix.
+     *
+     * Views bound to the storage of %other are rebound to the
+     * storage of the copy.
+     *
+     */
+    bond_arg_matrix(bond_arg_matrix const &other) : ncols(0), nrows(0), ld(0), offset(0), capacity(0) {
+        swap(other);
+    }
+
+    /**
+     *
+     * @brief Standard assignment operator.
+     * @param other.
+     *
+     * @return this.
+     */
+    bond_arg_matrix& operator=(bond_arg_matrix const &other) {
+        if(this != &other) {
+            swap(other);
+        }
+
+        return *this;
+    }
+
+    /**
+     *
+     * @brief Sets the dimensions of the matrix.
+     * @param ncols Number of columns.
+     * @param nrows Number of rows.
+     *
+     * Allocates only if the block has to grow, in which case the 
+     * entries are not preserved. All columns are bound to their own
+     * storage afterwards.
+     *
+     */
+    void resize(size_t ncols, size_t nrows) {
+        this->ncols = ncols;
+        this->nrows = nrows;
+        ld = (nrows + ALIGN - 1) / ALIGN * ALIGN;
+        if(ncols * ld + ALIGN > capacity) {
+            capacity = ncols * ld + ALIGN;
+            storage.reset(new double[capacity]);
+            align();
+        }
+        column_views.resize(ncols);
+        for(size_t k = 0; k < ncols; ++k) {
+            column_views[k] = argument_view(column(k), 1, nrows);
+        }
+    }
+
+    /**
+     *
+     * @brief  Storage of a column.
+     * @param  k Index of the column.
+     * @return Pointer to the first entry of column k, aligned to
+     *         %ALIGN doubles.
+     *
+     */
+    double *column(size_t k) {
+        return storage.get() + offset + k * ld;
+    }
+
+    double const *column(size_t k) const {
+        return storage.get() + offset + k * ld;
+    }
+
+    /**
+     *
+     * @brief Binds a column to a view.
+     * @param k Index of the column.
+     * @param view View on the column, either on its own storage or
+     *        on external memory.
+     *
+     */
+    void bind(size_t k, argument_view const &view) {
+        column_views[k] = view;
+    }
+
+    /**
+     *
+     * @brief  Views on all columns, in the layout expected by
+     *         @ref mcmc_likelihood::evaluate.
+     *
+     */
+    std::vector<argument_view> const &views() const {
+        return column_views;
+    }
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     */
+    size_t cols() const {
+        return ncols;
+    }
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t rows() const {
+        return nrows;
+    }
+
+    /**
+     *
+     * @brief Distance between two columns in doubles.
+     *
+     */
+    size_t stride() const {
+        return ld;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Computes the offset of the first aligned entry.
+     *
+     */
+    void align() {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(storage.get());
+        uintptr_t bytes = ALIGN * sizeof(double);
+        offset = ((bytes - addr % bytes) % bytes) / sizeof(double);
+    }
+
+    /**
+     *
+     * @brief Copies %other into this.
+     * @param other.
+     *
+     * Only the columns bound to their own storage are copied.
+     *
+     */
+    void swap(bond_arg_matrix const &other) {
+        resize(other.ncols, other.nrows);
+        for(size_t k = 0; k < ncols; ++k) {
+            argument_view const &view = other.column_views[k];
+            if(view.data == other.column(k)) {
+                std::copy(other.column(k), other.column(k) + nrows, column(k));
+                column_views[k] = argument_view(column(k), view.stride, view.length);
+            } else {
+                column_views[k] = view;
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     */
+    size_t ncols;
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t nrows;
+
+    /**
+     *
+     * @brief Distance between two columns, %nrows padded to a multiple
+     *        of %ALIGN.
+     *
+     */
+    size_t ld;
+
+    /**
+     *
+     * @brief Offset of the first aligned entry in %storage.
+     *
+     */
+    size_t offset;
+
+    /**
+     *
+     * @brief Number of doubles in %storage.
+     *
+     */
+    size_t capacity;
+
+    /**
+     *
+     * @brief The block holding all columns, not initialized.
+     *
+     */
+    std::unique_ptr<double[]> storage;
+
+    /**
+     *
+     * @brief Views on the columns.
+     *
+     */
+    std::vector<argument_view> column_views;
+};
+
+#endif	/* BOND_ARG_MATRIX_H */
+
@@ -0,0 +1,196 @@
+/**
+ *
+ * @file cached_data_reader.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 3, 2012, 4:45 PM
+ *
+ * @brief Reader that keeps a binary column file next to its source.
+ *
+ * The %cached_data_reader reads a file with another reader, e.g. a
+ * @ref csv_data_reader, the first time and writes the table as a
+ * @ref column_file under the path of the source with
+ * %COLUMN_FILE_SUFFIX appended. Later reads map that file instead of
+ * parsing the source again. The column file is used as long as the
+ * size and the modification time of the source equal the ones it
+ * records, otherwise it is written anew. A column file that cannot be
+ * written, e.g. in a read-only directory, is skipped.
+ *
+ * Example:
+ * @code
+ * csv_data_reader csv;
+ * cached_data_reader cached(csv);
+ * column_table table;
+ * if(!cached.read("data.csv", table)) {
+ *     std::cerr << cached.error() << std::endl;
+ * }
+ * @endcode
+ *
+ * @see column_file
+ *
+ */
+#ifndef CACHED_DATA_READER_H
+#define	CACHED_DATA_READER_H
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include "reader.h"
+#include "column_file.h"
+
+/**
+ *
+ * @brief Appended to the path of a source to name its column file.
+ *
+ */
+static char const COLUMN_FILE_SUFFIX[] = ".mcol";
+
+class cached_data_reader : public reader {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param source Reader of the source files, referenced. Has to
+     *        outlive this reader.
+     * @param verify Determines if the blocks of a column file are
+     *        checked when it is mapped.
+     *
+     */
+    cached_data_reader(reader &source, bool verify = true) : source(source), verify(verify) {};
+
+    virtual ~cached_data_reader() {};
+
+    /**
+     *
+     * @brief  Maps the column file of a source, writing it first if it
+     *         is missing or stale.
+     * @param  path Path of the source.
+     * @param  file Receives the mapping, which the caller can use in
+     *         place.
+     * @return True, if the column file is open. Otherwise @ref error
+     *         tells why.
+     *
+     */
+    bool open(std::string const &path, column_file &file) {
+        uint64_t size;
+        int64_t mtime;
+        if(!status(path, size, mtime)) {
+            return false;
+        }
+        std::string cache = path + COLUMN_FILE_SUFFIX;
+        if(fresh(file, cache, size, mtime)) {
+            return true;
+        }
+        column_table table;
+        if(!source.read(path, table)) {
+            message = source.error();
+            return false;
+        }
+        if(!column_file::write(cache, table, size, mtime, message)) {
+            return false;
+        }
+        if(!file.open(cache, verify)) {
+            message = file.error();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief  Reads a source into named columns, through its column
+     *         file if possible.
+     * @param  path Path of the source.
+     * @param  table Receives the columns.
+     * @return True, if the source has been read.
+     *
+     * Inherited from @ref reader.
+     *
+     */
+    virtual bool read(std::string const &path, column_table &table) {
+        table = column_table();
+        uint64_t size;
+        int64_t mtime;
+        if(!status(path, size, mtime)) {
+            return false;
+        }
+        std::string cache = path + COLUMN_FILE_SUFFIX;
+        column_file file;
+        if(fresh(file, cache, size, mtime)) {
+            file.copy(table);
+            return true;
+        }
+        if(!source.read(path, table)) {
+            message = source.error();
+            return false;
+        }
+        std::string ignored;
+        column_file::write(cache, table, size, mtime, ignored);
+
+        return true;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable.
+     *
+     */
+    cached_data_reader(cached_data_reader const &other);
+    cached_data_reader& operator=(cached_data_reader const &other);
+
+    /**
+     *
+     * @brief Reads the size and the modification time of a source.
+     *
+     */
+    bool status(std::string const &path, uint64_t &size, int64_t &mtime) {
+        struct stat st;
+        if(stat(path.c_str(), &st) != 0) {
+            message = path + ": " + std::strerror(errno);
+            return false;
+        }
+        size = static_cast<uint64_t>(st.st_size);
+        mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Maps a column file if it is valid and was written from
+     *        the current source.
+     *
+     */
+    bool fresh(column_file &file, std::string const &cache, uint64_t size, int64_t mtime) {
+        if(!file.open(cache, verify)) {
+            return false;
+        }
+        if(file.sourceSize() != size || file.sourceTime() != mtime) {
+            file.close();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Reader of the sources.
+     *
+     */
+    reader &source;
+
+    /**
+     *
+     * @brief Determines if the blocks are checked.
+     *
+     */
+    bool verify;
+};
+
+#endif	/* CACHED_DATA_READER_H */
@@ -0,0 +1,781 @@
+/**
+ *
+ * @file column_file.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 3, 2012, 2:10 PM
+ *
+ * @brief Binary columnar file, mapped read-only.
+ *
+ * A %column_file stores a @ref column_table such that it is used in
+ * place after mapping it, see @ref mapped_file. The file starts with
+ * a %column_file_header, followed by one %column_file_entry per
+ * column, the names of the columns and the column blocks. Every block
+ * starts at a multiple of %COLUMN_FILE_ALIGN bytes and holds the
+ * entries of its column in the byte order of the writer. The header
+ * records the byte order, and the entries record the type, the
+ * position and a checksum of each block, see @ref column_checksum.
+ * The directory and the names have a checksum of their own.
+ *
+ * Opening a file validates its structure and, optionally, every
+ * block. The columns are then read from the page cache, which all
+ * processes mapping the same file share. Loading takes no parsing and
+ * no copying.
+ *
+ * The header also records the size and the modification time of the
+ * file the table was read from, such that a %column_file can serve as
+ * a cache of it, see @ref cached_data_reader.
+ *
+ * Files larger than the memory are read in chunks by a
+ * @ref column_file_stream instead.
+ *
+ * @see column_file_reader
+ * @see csv_data_reader
+ *
+ */
+#ifndef COLUMN_FILE_H
+#define	COLUMN_FILE_H
+
+#include <stdint.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "reader.h"
+#include "mapped_file.h"
+
+/**
+ *
+ * @brief First bytes of every column file.
+ *
+ */
+static char const COLUMN_FILE_MAGIC[8] = {'M', 'C', 'M', 'C', 'L', 'C', 'O', 'L'};
+
+/**
+ *
+ * @brief Version of the format.
+ *
+ */
+static uint32_t const COLUMN_FILE_VERSION = 1;
+
+/**
+ *
+ * @brief Alignment of the column blocks, a page.
+ *
+ */
+static uint64_t const COLUMN_FILE_ALIGN = 4096;
+
+/**
+ *
+ * @brief Type of a column of doubles, the only type written.
+ *
+ */
+static uint32_t const COLUMN_FLOAT64 = 1;
+
+/**
+ *
+ * @brief First block of a column file.
+ *
+ */
+struct column_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t rows;
+    uint64_t columns;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t names_bytes;
+    uint64_t checksum;
+};
+
+/**
+ *
+ * @brief Directory entry of a column.
+ *
+ */
+struct column_file_entry {
+    uint32_t type;
+    uint32_t name_length;
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t checksum;
+};
+
+/**
+ *
+ * @brief  Checksum of a block of bytes.
+ *
+ * Four independent lanes take a 64-bit word each, xor it, multiply by
+ * the 64-bit FNV prime and rotate, such that the checksum runs at
+ * about the speed of reading the block. Every step is a bijection, so
+ * a change of any single word changes the checksum.
+ *
+ */
+inline uint64_t column_checksum(void const *data, size_t bytes) {
+    unsigned char const *p = static_cast<unsigned char const*>(data);
+    uint64_t const prime = 0x100000001B3ULL;
+    uint64_t h[4] = {0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL, 0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL};
+    size_t n = bytes / 32;
+    for(size_t i = 0; i < n; ++i, p += 32) {
+        for(int l = 0; l < 4; ++l) {
+            uint64_t w;
+            std::memcpy(&w, p + 8 * l, 8);
+            uint64_t x = (h[l] ^ w) * prime;
+            h[l] = (x << 27) | (x >> 37);
+        }
+    }
+    for(size_t i = 32 * n; i < bytes; ++i, ++p) {
+        h[0] = (h[0] ^ *p) * prime;
+    }
+    uint64_t r = bytes;
+    for(int l = 0; l < 4; ++l) {
+        r = (r ^ h[l] ^ (h[l] >> 29)) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    return r ^ (r >> 32);
+}
+
+class column_file {
+public:
+
+    /**
+     *
+     * @brief Default constructor, opens nothing.
+     *
+     */
+    column_file() : header(0), entries(0) {};
+
+    /**
+     *
+     * @brief  Maps a column file and validates it.
+     * @param  path Path of the file.
+     * @param  verify Determines if the checksums of the blocks are
+     *         checked, which reads the whole file.
+     * @return True, if the file is valid. Otherwise @ref error tells
+     *         why and nothing is open.
+     *
+     */
+    bool open(std::string const &path, bool verify = true) {
+        close();
+        if(!file.open(path, false)) {
+            message = file.error();
+            return false;
+        }
+        if(!validate(verify)) {
+            message = path + ": " + message;
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Releases the file.
+     *
+     */
+    void close() {
+        file.close();
+        header = 0;
+        entries = 0;
+        names.clear();
+    }
+
+    /**
+     *
+     * @brief Determines if a file is open.
+     *
+     */
+    bool isOpen() const {
+        return header != 0;
+    }
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t rows() const {
+        return header != 0 ? header->rows : 0;
+    }
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     */
+    size_t numColumns() const {
+        return names.size();
+    }
+
+    /**
+     *
+     * @brief The name of column k.
+     *
+     */
+    std::string const &name(size_t k) const {
+        return names[k];
+    }
+
+    /**
+     *
+     * @brief The entries of column k, in the mapped file.
+     *
+     */
+    double const *column(size_t k) const {
+        return reinterpret_cast<double const*>(file.data() + entries[k].offset);
+    }
+
+    /**
+     *
+     * @brief Size of the file the table was read from.
+     *
+     */
+    uint64_t sourceSize() const {
+        return header != 0 ? header->source_size : 0;
+    }
+
+    /**
+     *
+     * @brief Modification time of the file the table was read from.
+     *
+     */
+    int64_t sourceTime() const {
+        return header != 0 ? header->source_mtime : 0;
+    }
+
+    /**
+     *
+     * @brief Copies the columns into a table.
+     *
+     */
+    void copy(column_table &table) const {
+        table.names = names;
+        table.columns.resize(names.size());
+        for(size_t k = 0; k < names.size(); ++k) {
+            table.columns[k].assign(column(k), column(k) + rows());
+        }
+    }
+
+    /**
+     *
+     * @brief Why the last @ref open or @ref write failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+    /**
+     *
+     * @brief  Writes a table as a column file.
+     * @param  path Path of the file.
+     * @param  table The table, all columns of the same length.
+     * @param  source_size Size of the file the table was read from.
+     * @param  source_mtime Modification time of that file.
+     * @param  message Receives why the file could not be written.
+     * @return True, if the file has been written.
+     *
+     * The file is written under a unique temporary name, synced and
+     * renamed, such that readers never see a partial file, also if
+     * several processes write it at once.
+     *
+     */
+    static bool write(std::string const &path, column_table const &table, uint64_t source_size,
+        int64_t source_mtime, std::string &message) {
+        size_t ncols = table.columns.size();
+        uint64_t rows = table.rows();
+        column_file_header head;
+        std::memset(&head, 0, sizeof(head));
+        std::memcpy(head.magic, COLUMN_FILE_MAGIC, sizeof(head.magic));
+        head.version = COLUMN_FILE_VERSION;
+        head.byte_order = 0x01020304;
+        head.rows = rows;
+        head.columns = ncols;
+        head.source_size = source_size;
+        head.source_mtime = source_mtime;
+        std::string all_names;
+        std::vector<column_file_entry> dir(ncols);
+        for(size_t k = 0; k < ncols; ++k) {
+            all_names += table.names[k];
+        }
+        head.names_bytes = all_names.size();
+        uint64_t offset = align(sizeof(head) + ncols * sizeof(column_file_entry) + all_names.size());
+        for(size_t k = 0; k < ncols; ++k) {
+            if(table.columns[k].size() != rows) {
+                message = path + ": the columns differ in length";
+                return false;
+            }
+            std::memset(&dir[k], 0, sizeof(dir[k]));
+            dir[k].type = COLUMN_FLOAT64;
+            dir[k].name_length = static_cast<uint32_t>(table.names[k].size());
+            dir[k].offset = offset;
+            dir[k].bytes = rows * sizeof(double);
+            dir[k].checksum = column_checksum(rows > 0 ? &table.columns[k][0] : 0, dir[k].bytes);
+            offset = align(offset + dir[k].bytes);
+        }
+        head.checksum = directoryChecksum(dir.empty() ? 0 : &dir[0], ncols, all_names.data(), all_names.size());
+        std::vector<char> temp(path.begin(), path.end());
+        char const suffix[] = ".XXXXXX";
+        temp.insert(temp.end(), suffix, suffix + sizeof(suffix));
+        int fd = mkstemp(&temp[0]);
+        if(fd < 0) {
+            message = path + ": " + std::strerror(errno);
+            return false;
+        }
+        bool ok = fchmod(fd, 0644) == 0 &&
+            writeAll(fd, reinterpret_cast<char const*>(&head), sizeof(head)) &&
+            writeAll(fd, reinterpret_cast<char const*>(dir.empty() ? 0 : &dir[0]), ncols * sizeof(column_file_entry)) &&
+            writeAll(fd, all_names.data(), all_names.size());
+        uint64_t pos = sizeof(head) + ncols * sizeof(column_file_entry) + all_names.size();
+        std::vector<char> zeros(COLUMN_FILE_ALIGN, 0);
+        for(size_t k = 0; ok && k < ncols; ++k) {
+            ok = writeAll(fd, &zeros[0], dir[k].offset - pos) &&
+                writeAll(fd, reinterpret_cast<char const*>(rows > 0 ? &table.columns[k][0] : 0), dir[k].bytes);
+            pos = dir[k].offset + dir[k].bytes;
+        }
+        ok = ok && fsync(fd) == 0;
+        ok = ::close(fd) == 0 && ok;
+        ok = ok && std::rename(&temp[0], path.c_str()) == 0;
+        if(!ok) {
+            message = path + ": " + std::strerror(errno);
+            std::remove(&temp[0]);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief  Number of bytes of the header, the directory and the
+     *         names of a column file.
+     * @return The number, or the largest value if it overflows.
+     *
+     */
+    static uint64_t directoryEnd(column_file_header const &head) {
+        uint64_t const most = ~uint64_t(0);
+        if(head.columns > most / 2 / sizeof(column_file_entry) || head.names_bytes > most / 2) {
+            return most;
+        }
+
+        return sizeof(column_file_header) + head.columns * sizeof(column_file_entry) + head.names_bytes;
+    }
+
+    /**
+     *
+     * @brief  Checks the header, the directory and the names of a
+     *         column file.
+     * @param  data The first bytes of the file.
+     * @param  available Number of bytes at %data, at least
+     *         @ref directoryEnd of the header for a valid file.
+     * @param  size Number of bytes of the file.
+     * @param  names Receives the names of the columns.
+     * @param  message Receives why the file is not valid.
+     * @return True, if the structure is valid. The blocks are not
+     *         checked.
+     *
+     */
+    static bool readDirectory(char const *data, size_t available, uint64_t size, std::vector<std::string> &names,
+        std::string &message) {
+        names.clear();
+        if(available < sizeof(column_file_header) || std::memcmp(data, COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC)) != 0) {
+            message = "not a column file";
+            return false;
+        }
+        column_file_header const *head = reinterpret_cast<column_file_header const*>(data);
+        if(head->version != COLUMN_FILE_VERSION || head->byte_order != 0x01020304) {
+            message = "unsupported version or byte order";
+            return false;
+        }
+        if(directoryEnd(*head) > available) {
+            message = "truncated directory";
+            return false;
+        }
+        column_file_entry const *dir = reinterpret_cast<column_file_entry const*>(data + sizeof(column_file_header));
+        char const *all_names = data + directoryEnd(*head) - head->names_bytes;
+        if(directoryChecksum(dir, head->columns, all_names, head->names_bytes) != head->checksum) {
+            message = "directory checksum mismatch";
+            return false;
+        }
+        uint64_t name_pos = 0;
+        for(size_t k = 0; k < head->columns; ++k) {
+            if(dir[k].type != COLUMN_FLOAT64 || dir[k].bytes != head->rows * sizeof(double) ||
+                dir[k].offset % COLUMN_FILE_ALIGN != 0 || dir[k].offset > size || dir[k].bytes > size - dir[k].offset ||
+                dir[k].name_length > head->names_bytes - name_pos) {
+                message = "invalid column entry";
+                names.clear();
+                return false;
+            }
+            names.push_back(std::string(all_names + name_pos, dir[k].name_length));
+            name_pos += dir[k].name_length;
+        }
+
+        return true;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the mapping is released once.
+     *
+     */
+    column_file(column_file const &other);
+    column_file& operator=(column_file const &other);
+
+    /**
+     *
+     * @brief Writes all bytes to a file, retrying short writes.
+     *
+     */
+    static bool writeAll(int fd, char const *data, size_t bytes) {
+        while(bytes > 0) {
+            ssize_t n = ::write(fd, data, bytes);
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+            if(n <= 0) {
+                return false;
+            }
+            data += n;
+            bytes -= n;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief The next multiple of %COLUMN_FILE_ALIGN.
+     *
+     */
+    static uint64_t align(uint64_t offset) {
+        return (offset + COLUMN_FILE_ALIGN - 1) / COLUMN_FILE_ALIGN * COLUMN_FILE_ALIGN;
+    }
+
+    /**
+     *
+     * @brief Checksum of the directory and the names.
+     *
+     */
+    static uint64_t directoryChecksum(column_file_entry const *dir, size_t ncols, char const *names, size_t bytes) {
+        return column_checksum(dir, ncols * sizeof(column_file_entry)) ^ (column_checksum(names, bytes) * 31);
+    }
+
+    /**
+     *
+     * @brief  Checks the structure of the mapped file and reads the
+     *         names.
+     * @param  verify Determines if the blocks are checked as well.
+     *
+     */
+    bool validate(bool verify) {
+        char const *data = file.data();
+        if(!readDirectory(data, file.size(), file.size(), names, message)) {
+            return false;
+        }
+        column_file_header const *head = reinterpret_cast<column_file_header const*>(data);
+        column_file_entry const *dir = reinterpret_cast<column_file_entry const*>(data + sizeof(column_file_header));
+        for(size_t k = 0; verify && k < head->columns; ++k) {
+            if(column_checksum(data + dir[k].offset, dir[k].bytes) != dir[k].checksum) {
+                message = "checksum mismatch in column " + names[k];
+                names.clear();
+                return false;
+            }
+        }
+        header = head;
+        entries = dir;
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief The mapping.
+     *
+     */
+    mapped_file file;
+
+    /**
+     *
+     * @brief The header and the directory in the mapping, null if
+     *        nothing is open.
+     *
+     */
+    column_file_header const *header;
+    column_file_entry const *entries;
+
+    /**
+     *
+     * @brief The names of the columns.
+     *
+     */
+    std::vector<std::string> names;
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
+};
+
+/**
+ *
+ * @brief Reads a column file through the @ref reader interface.
+ *
+ */
+class column_file_reader : public reader {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param verify Determines if the blocks are checked on reading.
+     *
+     */
+    column_file_reader(bool verify = true) : verify(verify) {};
+
+    virtual ~column_file_reader() {};
+
+    /**
+     *
+     * @brief  Reads a column file into named columns.
+     * @param  path Path of the file.
+     * @param  table Receives a copy of the columns.
+     * @return True, if the file is a valid column file.
+     *
+     * Inherited from @ref reader.
+     *
+     */
+    virtual bool read(std::string const &path, column_table &table) {
+        table = column_table();
+        column_file file;
+        if(!file.open(path, verify)) {
+            message = file.error();
+            return false;
+        }
+        file.copy(table);
+
+        return true;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Determines if the blocks are checked.
+     *
+     */
+    bool verify;
+};
+
+/**
+ *
+ * @brief Reads ranges of rows of a column file, without mapping it.
+ *
+ * Only the header, the directory and the names are held in memory,
+ * the rows are read by pread into the caller's buffers, so files
+ * larger than the memory can be read chunk by chunk. Concurrent calls
+ * are safe. The checksums of the blocks are not checked, as a range
+ * does not cover a block.
+ *
+ * @see streaming_bond
+ *
+ */
+class column_file_stream : public chunk_reader {
+public:
+
+    /**
+     *
+     * @brief Default constructor, opens nothing.
+     *
+     */
+    column_file_stream() : fd(-1), nrows(0) {};
+
+    /**
+     *
+     * @brief Destructor, closes the file.
+     *
+     */
+    virtual ~column_file_stream() {
+        close();
+    };
+
+    /**
+     *
+     * @brief  Opens a column file and reads its directory.
+     * @param  path Path of the file.
+     * @return True, if the file is a valid column file. Otherwise
+     *         @ref error tells why and nothing is open.
+     *
+     */
+    bool open(std::string const &path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) != 0) {
+            message = path + ": " + std::strerror(errno);
+            close();
+            return false;
+        }
+        uint64_t size = static_cast<uint64_t>(st.st_size);
+        column_file_header head;
+        std::memset(&head, 0, sizeof(head));
+        std::vector<char> directory;
+        if(readAt(reinterpret_cast<char*>(&head), sizeof(head), 0, message) &&
+            column_file::directoryEnd(head) <= size) {
+            directory.resize(column_file::directoryEnd(head));
+            readAt(&directory[0], directory.size(), 0, message);
+        }
+        if(directory.empty() || !column_file::readDirectory(&directory[0], directory.size(), size, names, message)) {
+            message = path + ": " + (directory.empty() ? std::string("not a column file") : message);
+            close();
+            return false;
+        }
+        nrows = head.rows;
+        column_file_entry const *dir = reinterpret_cast<column_file_entry const*>(&directory[sizeof(head)]);
+        for(size_t k = 0; k < names.size(); ++k) {
+            offsets.push_back(dir[k].offset);
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Closes the file.
+     *
+     */
+    void close() {
+        if(fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+        nrows = 0;
+        names.clear();
+        offsets.clear();
+    }
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     * Inherited from @ref chunk_reader.
+     *
+     */
+    virtual size_t rows() const {
+        return nrows;
+    }
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     * Inherited from @ref chunk_reader.
+     *
+     */
+    virtual size_t numColumns() const {
+        return names.size();
+    }
+
+    /**
+     *
+     * @brief The name of column k.
+     *
+     * Inherited from @ref chunk_reader.
+     *
+     */
+    virtual std::string const &name(size_t k) const {
+        return names[k];
+    }
+
+    /**
+     *
+     * @brief Reads a range of rows of a column.
+     *
+     * Inherited from @ref chunk_reader.
+     *
+     */
+    virtual bool readRows(size_t k, size_t first, size_t count, double *out, std::string &message) const {
+        if(k >= names.size() || first > nrows || count > nrows - first) {
+            message = "rows out of range";
+            return false;
+        }
+
+        return readAt(reinterpret_cast<char*>(out), count * sizeof(double), offsets[k] + first * sizeof(double),
+            message);
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the file is closed once.
+     *
+     */
+    column_file_stream(column_file_stream const &other);
+    column_file_stream& operator=(column_file_stream const &other);
+
+    /**
+     *
+     * @brief Reads bytes at an offset, retrying short reads.
+     *
+     */
+    bool readAt(char *out, size_t bytes, uint64_t offset, std::string &message) const {
+        while(bytes > 0) {
+            ssize_t got = pread(fd, out, bytes, static_cast<off_t>(offset));
+            if(got < 0 && errno == EINTR) {
+                continue;
+            }
+            if(got <= 0) {
+                message = got < 0 ? std::strerror(errno) : "unexpected end of file";
+                return false;
+            }
+            out += got;
+            bytes -= got;
+            offset += got;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief The file descriptor, negative if nothing is open.
+     *
+     */
+    int fd;
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t nrows;
+
+    /**
+     *
+     * @brief The names of the columns.
+     *
+     */
+    std::vector<std::string> names;
+
+    /**
+     *
+     * @brief Offsets of the column blocks in the file.
+     *
+     */
+    std::vector<uint64_t> offsets;
+};
+
+#endif	/* COLUMN_FILE_H */
@@ -14,6 +14,7 @@
  */
 
 
+#include <algorithm>
 #include <vector>
 
 #include "constant_argument_maker.h"
@@ -54,12 +55,85 @@ constant_argument_maker::~constant_argument_maker(){};
  * 
  * @see argument_maker
  */
-std::vector<double> constant_argument_maker::getArgument(std::vector<std::vector<double> > const &params) {
+std::vector<double> constant_argument_maker::getArgument(std::vector<argument_view> const &params) {
     std::vector<double> temp(params[0].size(), CONSTANT_VALUE);
     
     return temp;
 }
  
+/**
+ * 
+ * @brief Fills caller-owned storage with the constant value.
+ * @param params Input parameters.
+ * @param out Storage the argument is written to.
+ * 
+ * Inherited from the interface class @ref argument_maker.
+ * 
+ * @see argument_maker
+ */
+void constant_argument_maker::fillArgument(std::vector<argument_view> const &params, double *out) {
+    std::fill(out, out + params[0].size(), CONSTANT_VALUE);
+}
+
+/**
+ * 
+ * @brief  Returns a view broadcasting the constant value.
+ * @param  params Input parameters.
+ * @param  storage Unused, nothing has to be stored.
+ * @return View with stride zero on %CONSTANT_VALUE and the length 
+ *         of the first parameter vector.
+ * 
+ * Inherited from the interface class @ref argument_maker.
+ * 
+ * @see argument_maker
+ */
+argument_view constant_argument_maker::makeArgument(std::vector<argument_view> const &params, double *storage) {
+    return argument_view(&CONSTANT_VALUE, 0, params[0].size());
+}
+
+/**
+ * 
+ * @brief  Returns a view broadcasting the constant value over a range.
+ * @param  params Input parameters.
+ * @param  begin Index of the first entry.
+ * @param  end Index one past the last entry.
+ * @param  storage Unused, nothing has to be stored.
+ * @return View with stride zero on %CONSTANT_VALUE.
+ * 
+ * Inherited from the interface class @ref argument_maker.
+ * 
+ * @see argument_maker
+ */
+argument_view constant_argument_maker::makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage) {
+    return argument_view(&CONSTANT_VALUE, 0, end - begin);
+}
+
+/**
+ * 
+ * @brief  Collects the entries depending on a parameter coordinate.
+ * @param  whatami Index of the parameter vector in the bond.
+ * @param  which Index of the coordinate in that parameter vector.
+ * @param  terms Container the dependent entries are appended to.
+ * @return Always true, no entry depends on any parameter.
+ * 
+ * @see argument_maker
+ */
+bool constant_argument_maker::dependentTerms(int whatami, int which, std::vector<size_t> &terms) const {
+    return true;
+}
+
+/**
+ * 
+ * @brief  Propagates derivatives with respect to the argument.
+ * 
+ * No parameter enters a constant argument, nothing is added.
+ * 
+ * @see argument_maker
+ * 
+ */
+void constant_argument_maker::addGradient(std::vector<argument_view> const &params, int whatami, 
+    double const *grad, std::vector<double> &out) const {}
+ 
 /**
  * 
  * @brief Standard assignment operator.
@@ -55,7 +55,87 @@ public:
      * 
      * @see argument_maker
      */
-    std::vector<double> getArgument(std::vector<std::vector<double> > const &params);
+    std::vector<double> getArgument(std::vector<argument_view> const &params);
+    
+    /**
+     * 
+     * @brief Fills the storage %out with the constant value.
+     * @param params Input parameters.
+     * @param out Storage the argument is written to.
+     * 
+     * @see argument_maker
+     */
+    void fillArgument(std::vector<argument_view> const &params, double *out);
+    
+    /**
+     * 
+     * @brief Returns a view broadcasting the constant value.
+     * @param params Input parameters.
+     * @param storage Unused.
+     * @return View with stride zero on %CONSTANT_VALUE.
+     * 
+     * @see argument_maker
+     */
+    argument_view makeArgument(std::vector<argument_view> const &params, double *storage);
+    
+    /**
+     * 
+     * @brief Returns a view broadcasting the constant value over 
+     *        a range.
+     * 
+     * @see argument_maker
+     */
+    argument_view makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage);
+    
+    /**
+     * 
+     * @brief Returns a single entry of the argument.
+     * @param params Input parameters.
+     * @param i Index of the entry.
+     * @return The constant value.
+     * 
+     * @see argument_maker
+     */
+    double getArgumentAt(std::vector<argument_view> const &params, size_t i) {
+        return CONSTANT_VALUE;
+    }
+    
+    /**
+     * 
+     * @brief No entry of a constant argument depends on a parameter.
+     * 
+     * @see argument_maker
+     */
+    bool dependentTerms(int whatami, int which, std::vector<size_t> &terms) const;
+    
+    /**
+     * 
+     * @brief A constant argument has no derivative.
+     * 
+     * @see argument_maker
+     */
+    bool hasGradient() const {
+        return true;
+    }
+    
+    /**
+     * 
+     * @brief Does nothing, no parameter enters the argument.
+     * 
+     * @see argument_maker
+     */
+    void addGradient(std::vector<argument_view> const &params, int whatami, 
+        double const *grad, std::vector<double> &out) const;
+    
+    /**
+     * 
+     * @brief No parameter enters the argument.
+     * 
+     * @see argument_maker
+     */
+    bool dependsOn(int whatami) const {
+        return false;
+    }
 
     /**
      * 
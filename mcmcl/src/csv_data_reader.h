@@ -1,59 +1,485 @@
-/* 
- * File:   CSVReaderData.h
- * Author: simonzehnder
+/**
+ *
+ * @file csv_data_reader.h
+ * @author Lars Simon Zehnder
+ *
+ * @created May 17, 2012, 5:14 PM
+ *
+ * @brief Parallel reader of numeric CSV files.
+ *
+ * The %csv_data_reader maps the file into memory, see @ref mapped_file,
+ * and parses it in place. The body after the header line is split
+ * into chunks of about %CSV_CHUNK_BYTES, each moved to the start of a
+ * line. A first pass counts the rows of every chunk, which gives the
+ * offset of its first row, and a second pass parses each chunk
+ * straight into the columns. Both passes run on the @ref thread_pool,
+ * if set, and read the file front to back, so the throughput is
+ * bounded by the memory bandwidth rather than by the parsing.
+ *
+ * Numbers are parsed by @ref csv_parse_double: up to 19 significant
+ * digits and decimal exponents up to 22 are converted exactly with
+ * one multiplication or division, all other numbers by strtod. Empty
+ * lines are skipped, empty fields and NA are NaN. Names are taken
+ * from the header line, without surrounding quotes, or are V1, V2,
+ * ... if the file has none.
+ *
+ * Example:
+ * @code
+ * csv_data_reader csv;
+ * csv.setThreadPool(&pool);
+ * column_table table;
+ * if(!csv.read("data.csv", table)) {
+ *     std::cerr << csv.error() << std::endl;
+ * }
+ * std::vector<double> &y = table.columns[table.find("y")];
+ * @endcode
+ *
+ * @see reader
+ * @see column_table
  *
- * Created on May 17, 2012, 5:14 PM
  */
-
 #ifndef CSV_DATA_READER_H
 #define	CSV_DATA_READER_H
 
-#include <fstream>
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include <stdint.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <string>
+#include <vector>
 #include "reader.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+/**
+ *
+ * @brief Target size of the chunks parsed by one task.
+ *
+ */
+static size_t const CSV_CHUNK_BYTES = static_cast<size_t>(1) << 22;
+
+/**
+ *
+ * @brief Powers of ten that are exact doubles.
+ *
+ */
+static double const CSV_POW10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ *
+ * @brief  Parses a decimal number.
+ * @param  p First character of the number.
+ * @param  end End of the input.
+ * @param  out Receives the number.
+ * @return The character after the number, null if there is none.
+ *
+ * The digits are accumulated in an integer. If it has at most 19
+ * significant digits and is below 2^53 and the decimal exponent is
+ * within [-22, 22], the number is the integer times or divided by an
+ * exact power of ten, which is correctly rounded (Clinger, 1990).
+ * Other numbers, inf and nan are left to strtod.
+ *
+ */
+inline char const *csv_parse_double(char const *p, char const *end, double &out) {
+    char const *start = p;
+    bool neg = false;
+    if(p != end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        ++p;
+    }
+    uint64_t m = 0;
+    int digits = 0, exp10 = 0;
+    bool any = false, exact = true;
+    for(; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+        any = true;
+        if(digits < 19) {
+            m = 10 * m + (*p - '0');
+            digits += m > 0;
+        } else {
+            exact = exact && *p == '0';
+            ++exp10;
+        }
+    }
+    if(p != end && *p == '.') {
+        for(++p; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+            any = true;
+            if(digits < 19) {
+                m = 10 * m + (*p - '0');
+                digits += m > 0;
+                --exp10;
+            } else {
+                exact = exact && *p == '0';
+            }
+        }
+    }
+    if(any && p != end && (*p == 'e' || *p == 'E')) {
+        char const *q = p + 1;
+        bool eneg = false;
+        if(q != end && (*q == '-' || *q == '+')) {
+            eneg = *q == '-';
+            ++q;
+        }
+        if(q != end && static_cast<unsigned>(*q - '0') < 10) {
+            int e = 0;
+            for(; q != end && static_cast<unsigned>(*q - '0') < 10; ++q) {
+                e = e < 100000 ? 10 * e + (*q - '0') : e;
+            }
+            exp10 += eneg ? -e : e;
+            p = q;
+        }
+    }
+    if(any && exact && m < (static_cast<uint64_t>(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        double v = static_cast<double>(m);
+        v = exp10 < 0 ? v / CSV_POW10[-exp10] : v * CSV_POW10[exp10];
+        out = neg ? -v : v;
 
-using namespace std;
-using namespace boost;
+        return p;
+    }
+    /* inf, nan and other numbers: strtod on a terminated copy */
+    char const *stop = p;
+    if(!any) {
+        stop = start + (start != end && (*start == '-' || *start == '+'));
+        while(stop != end && std::isalpha(static_cast<unsigned char>(*stop)) != 0) {
+            ++stop;
+        }
+    }
+    std::string token(start, stop);
+    char *parsed = 0;
+    out = std::strtod(token.c_str(), &parsed);
+    if(token.empty() || parsed != token.c_str() + token.size()) {
+        return 0;
+    }
+
+    return stop;
+}
 
 class csv_data_reader : public reader {
-public: 
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param header Determines if the first line holds the names of
+     *        the columns.
+     * @param separator The character between the fields.
+     *
+     */
+    csv_data_reader(bool header = true, char separator = ',') : header(header), separator(separator), pool(0) {};
+
     virtual ~csv_data_reader() {};
+
+    /**
+     *
+     * @brief Reads a file into @ref table.
+     * @param path Path of the file.
+     *
+     * Prints the error, if the file cannot be read.
+     *
+     */
     virtual void read (string &path) {
-        
-        string _line;
-        vector<double> _data;
-        int _len = 0;
-        int _num;
-        
-        ifstream in(path.c_str());
-        if(in.fail()) {
-            cout << "File cannot be found!" << endl;
-            return;
-        }
-        
-        char_separator<char> sep(",");
-        tokenizer<char_separator<char> > tok(_line, sep);
-        
-        while(in.good() && getline(in, _line)) {
-            tok.assign(_line, sep);
-            for (tokenizer<char_separator<char> >::iterator it = tok.begin(); it != tok.end(); ++it) {
-                _data.push_back(lexical_cast<double>(*it));    
-            }
-            ++_len;
-        }
-        _num = _data.size() / _len;
-        
-        cout << _len << _num << endl;
-        in.close();
-        
-        
-        
-        
-        
-        
+        if(!read(path, data)) {
+            cout << message << endl;
+        }
     }
-};
 
-#endif	/* CSVREADERDATA_H */
+    /**
+     *
+     * @brief  Reads a file into named columns.
+     * @param  path Path of the file.
+     * @param  table Receives the columns.
+     * @return True, if the file has been read. Otherwise @ref error
+     *         tells why, e.g. the row and column of a field that is
+     *         not a number, and %table is empty.
+     *
+     * Inherited from @ref reader.
+     *
+     */
+    virtual bool read (std::string const &path, column_table &table) {
+        table = column_table();
+        mapped_file file;
+        if(!file.open(path)) {
+            message = file.error();
+            return false;
+        }
+        char const *p = file.data();
+        char const *end = p + file.size();
+        /* the first non-empty line gives the names or the number of columns */
+        char const *first = p;
+        while(first != end && (*first == '\n' || *first == '\r')) {
+            ++first;
+        }
+        char const *eol = lineEnd(first, end);
+        std::vector<std::string> fields;
+        split(first, eol, fields);
+        table.names.resize(fields.size());
+        for(size_t k = 0; k < fields.size(); ++k) {
+            if(header) {
+                table.names[k] = fields[k];
+            } else {
+                std::ostringstream name;
+                name << "V" << k + 1;
+                table.names[k] = name.str();
+            }
+        }
+        char const *body = header ? std::min(end, eol + 1) : first;
+        if(fields.empty()) {
+            return true;
+        }
+        /* chunks start after a newline */
+        size_t bytes = end - body;
+        size_t nchunks = std::max<size_t>(1, bytes / CSV_CHUNK_BYTES);
+        bounds.resize(nchunks + 1);
+        bounds[0] = body;
+        bounds[nchunks] = end;
+        for(size_t c = 1; c < nchunks; ++c) {
+            char const *b = std::max(bounds[c - 1], body + c * (bytes / nchunks));
+            char const *nl = static_cast<char const*>(std::memchr(b, '\n', end - b));
+            bounds[c] = nl != 0 ? nl + 1 : end;
+        }
+        counts.assign(nchunks + 1, 0);
+        runChunks(nchunks, [this](size_t c) {
+            counts[c + 1] = countRows(bounds[c], bounds[c + 1]);
+        });
+        for(size_t c = 0; c < nchunks; ++c) {
+            counts[c + 1] += counts[c];
+        }
+        table.columns.assign(fields.size(), std::vector<double>(counts[nchunks]));
+        errors.assign(nchunks, std::string());
+        runChunks(nchunks, [this, &table](size_t c) {
+            parseRows(c, table.columns);
+        });
+        for(size_t c = 0; c < nchunks; ++c) {
+            if(!errors[c].empty()) {
+                message = path + ": " + errors[c];
+                table = column_table();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Sets the pool used to parse chunks in parallel.
+     * @param pool The pool, or null for serial parsing. Not owned.
+     *
+     */
+    void setThreadPool(thread_pool *pool) {
+        this->pool = pool;
+    }
+
+    /**
+     *
+     * @brief The columns of the last @ref read(string&).
+     *
+     */
+    column_table const &table() const {
+        return data;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Runs a task per chunk, on %pool if set.
+     *
+     */
+    void runChunks(size_t nchunks, std::function<void(size_t)> const &task) {
+        if(pool != 0) {
+            pool->run(nchunks, task);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                task(c);
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief  The newline ending the line at p, or end.
+     *
+     */
+    static char const *lineEnd(char const *p, char const *end) {
+        char const *nl = p != end ? static_cast<char const*>(std::memchr(p, '\n', end - p)) : 0;
+
+        return nl != 0 ? nl : end;
+    }
+
+    /**
+     *
+     * @brief  Determines if a line, without its newline, holds a row.
+     *
+     */
+    static bool isRow(char const *p, char const *eol) {
+        return eol != p && !(eol - p == 1 && *p == '\r');
+    }
+
+    /**
+     *
+     * @brief  Number of rows of the lines in [p, end).
+     *
+     */
+    static size_t countRows(char const *p, char const *end) {
+        size_t n = 0;
+        while(p < end) {
+            char const *eol = lineEnd(p, end);
+            n += isRow(p, eol);
+            p = eol + 1;
+        }
+
+        return n;
+    }
+
+    /**
+     *
+     * @brief Splits a line into trimmed fields without quotes.
+     *
+     */
+    void split(char const *p, char const *eol, std::vector<std::string> &fields) const {
+        if(eol != p && eol[-1] == '\r') {
+            --eol;
+        }
+        while(p < eol) {
+            char const *q = static_cast<char const*>(std::memchr(p, separator, eol - p));
+            char const *f = q != 0 ? q : eol;
+            std::string field(p, f);
+            size_t b = field.find_first_not_of(" \t\"");
+            size_t e = field.find_last_not_of(" \t\"");
+            fields.push_back(b == std::string::npos ? std::string() : field.substr(b, e - b + 1));
+            p = f + 1;
+            if(q != 0 && p == eol) {
+                fields.push_back(std::string());
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Parses the rows of chunk c into the columns, from the row
+     *        %counts[c] on.
+     *
+     * Stops at the first malformed field and stores the message in
+     * %errors[c].
+     *
+     */
+    void parseRows(size_t c, std::vector<std::vector<double> > &columns) {
+        size_t ncols = columns.size();
+        size_t row = counts[c];
+        char const *p = bounds[c];
+        char const *end = bounds[c + 1];
+        while(p < end) {
+            char const *eol = lineEnd(p, end);
+            if(!isRow(p, eol)) {
+                p = eol + 1;
+                continue;
+            }
+            char const *stop = eol != p && eol[-1] == '\r' ? eol - 1 : eol;
+            for(size_t k = 0; k < ncols; ++k) {
+                while(p < stop && (*p == ' ' || *p == '\t')) {
+                    ++p;
+                }
+                double v;
+                if(p == stop || *p == separator) {
+                    v = NAN;
+                } else if(stop - p >= 2 && p[0] == 'N' && p[1] == 'A' && (stop - p == 2 || p[2] == separator || p[2] == ' ')) {
+                    v = NAN;
+                    p += 2;
+                } else {
+                    char const *q = csv_parse_double(p, stop, v);
+                    if(q == 0) {
+                        fail(c, row, k, "is not a number");
+                        return;
+                    }
+                    p = q;
+                }
+                while(p < stop && (*p == ' ' || *p == '\t')) {
+                    ++p;
+                }
+                if(k + 1 < ncols && (p == stop || *p != separator)) {
+                    fail(c, row, k, p == stop ? "is missing a field" : "has a malformed field");
+                    return;
+                }
+                if(k + 1 == ncols && p != stop) {
+                    fail(c, row, k, "has too many fields");
+                    return;
+                }
+                columns[k][row] = v;
+                ++p;
+            }
+            ++row;
+            p = eol + 1;
+        }
+    }
+
+    /**
+     *
+     * @brief Stores the error of chunk c at a row and column.
+     *
+     */
+    void fail(size_t c, size_t row, size_t k, char const *what) {
+        std::ostringstream out;
+        out << "row " << row + 1 << " " << what << " at column " << k + 1;
+        errors[c] = out.str();
+    }
+
+    /**
+     *
+     * @brief Determines if the first line holds the names.
+     *
+     */
+    bool header;
+
+    /**
+     *
+     * @brief The character between the fields.
+     *
+     */
+    char separator;
+
+    /**
+     *
+     * @brief The pool parsing the chunks, not owned.
+     *
+     */
+    thread_pool *pool;
+
+    /**
+     *
+     * @brief Start of every chunk and the end of the file.
+     *
+     */
+    std::vector<char const*> bounds;
+
+    /**
+     *
+     * @brief Index of the first row of every chunk and the number of
+     *        rows.
+     *
+     */
+    std::vector<size_t> counts;
+
+    /**
+     *
+     * @brief Error of every chunk, empty if it was parsed.
+     *
+     */
+    std::vector<std::string> errors;
+
+    /**
+     *
+     * @brief The columns of the last @ref read(string&).
+     *
+     */
+    column_table data;
+};
 
+#endif	/* CSV_DATA_READER_H */
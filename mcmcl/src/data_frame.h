@@ -1,33 +1,350 @@
-/* 
- * File:   DataFrame.h
- * Author: simonzehnder
+/**
+ *
+ * @file data_frame.h
+ * @author Lars Simon Zehnder
+ *
+ * @created May 15, 2012, 3:33 PM
+ *
+ * @brief Column store of the data, placed on the NUMA nodes.
+ *
+ * A %data_frame holds the columns of a @ref column_table, read by any
+ * @ref reader, each in a @ref numa_vector. Where the pages go is set
+ * by @ref setPlacement before the data is assigned:
+ *
+ * - FIRST_TOUCH writes the rows chunk by chunk on the pool set with
+ *   @ref setThreadPool, such that a bond evaluating the same chunks on
+ *   the same pool reads memory local to its threads. Without a pool
+ *   all pages go to the node of the calling thread.
+ * - BIND_NODE puts all pages on one node, e.g. the node of a chain
+ *   running on a single socket.
+ * - INTERLEAVED spreads the pages over all nodes, which balances the
+ *   bandwidth if the threads reading a range are not known.
+ *
+ * A placement the system refuses, e.g. BIND_NODE with a node that does
+ * not exist or any binding without NUMA support, fails the assignment
+ * and @ref error tells why. FIRST_TOUCH works on every system.
+ *
+ * Integer columns are converted from the real ones when first asked
+ * for and kept, with the same placement.
+ *
+ * Example:
+ * @code
+ * thread_pool pool(16, true);
+ * data_frame frame;
+ * frame.setThreadPool(&pool, basic_mcmc_bond::CHUNK_TERMS);
+ * csv_data_reader csv;
+ * if(!frame.read("data.csv", csv)) {
+ *     std::cerr << frame.error() << std::endl;
+ * }
+ * numa_vector<double> const *y = frame.realValued("y");
+ * @endcode
+ *
+ * @see mcmc_input
  *
- * Created on May 15, 2012, 3:33 PM
  */
-
 #ifndef DATA_FRAME_H
 #define	DATA_FRAME_H
 
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include "mcmc_input.h"
-#include <mpfr.h>
-#include "GLOBAL_VARS.h"
-
-template<Datatype>
-class data_frame : mcmc_input {
-    public: 
-        data_frame(string path, mpfr_prec_t precision = GLOBAL_VARS::MPFR_PREC_DEFAULT);
-        data_frame(const data_frame &_dataf);
-        ~data_frame();
-        
-        numa_vector<int> intValued(string name);
-        numa_vector<Datatype> realValued(string name, mpfr_prec_t precision = GLOBAL_VARS::MPFR_PREC_DEFAULT);
-        
-    private:
-        void readData(string path) {
-            
-        };
-            
-};
+#include "numa_vector.h"
+#include "reader.h"
+#include "thread_pool.h"
+
+class data_frame : public mcmc_input {
+public:
+
+    /**
+     *
+     * @brief Where the pages of the columns are placed.
+     *
+     */
+    enum placement {
+        FIRST_TOUCH,
+        BIND_NODE,
+        INTERLEAVED
+    };
+
+    /**
+     *
+     * @brief Default constructor, an empty frame placed by first
+     *        touch on the calling thread.
+     *
+     */
+    data_frame() : how(FIRST_TOUCH), node(0), pool(0), chunk(0), nrows(0) {};
+
+    virtual ~data_frame() {};
+
+    /**
+     *
+     * @brief Sets where the pages of columns assigned later go.
+     * @param how The placement.
+     * @param node The node of BIND_NODE.
+     *
+     */
+    void setPlacement(placement how, int node = 0) {
+        this->how = how;
+        this->node = node;
+    }
+
+    /**
+     *
+     * @brief Sets the pool writing the columns.
+     * @param pool The pool, or null to write on the calling thread.
+     *        Not owned.
+     * @param chunk Number of rows per task, the chunk size of the
+     *        bonds reading the columns, see basic_mcmc_bond::CHUNK_TERMS.
+     *
+     */
+    void setThreadPool(thread_pool *pool, size_t chunk) {
+        this->pool = pool;
+        this->chunk = chunk;
+    }
+
+    /**
+     *
+     * @brief  Reads the columns of a file.
+     * @param  path Path of the file.
+     * @param  source Reader of the file, e.g. a csv_data_reader.
+     * @return True, if the file has been read. Otherwise @ref error
+     *         tells why.
+     *
+     */
+    bool read(std::string const &path, reader &source) {
+        column_table table;
+        if(!source.read(path, table)) {
+            message = source.error();
+            return false;
+        }
+
+        return assign(table);
+    }
+
+    /**
+     *
+     * @brief  Replaces the columns by the ones of a table.
+     * @return True, if the columns are allocated. Otherwise @ref error
+     *         tells why and the frame is empty.
+     *
+     */
+    bool assign(column_table const &table) {
+        names.clear();
+        reals.clear();
+        ints.clear();
+        nrows = 0;
+        size_t n = table.rows();
+        for(size_t k = 0; k < table.columns.size(); ++k) {
+            if(table.columns[k].size() != n) {
+                message = "column " + table.names[k] + " differs in length";
+                assign(column_table());
+                return false;
+            }
+            boost::shared_ptr<numa_vector<double> > column(new numa_vector<double>());
+            if(!place(*column, n > 0 ? &table.columns[k][0] : 0, n)) {
+                assign(column_table());
+                return false;
+            }
+            reals.push_back(column);
+        }
+        names = table.names;
+        ints.resize(names.size());
+        nrows = n;
+
+        return true;
+    }
 
-#endif	/* DATAFRAME_H */
+    /**
+     *
+     * @brief Number of rows of the columns.
+     *
+     * Inherited from @ref mcmc_input.
+     *
+     */
+    virtual size_t rows() const {
+        return nrows;
+    }
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     */
+    size_t numColumns() const {
+        return names.size();
+    }
+
+    /**
+     *
+     * @brief The name of column k.
+     *
+     */
+    std::string const &name(size_t k) const {
+        return names[k];
+    }
+
+    /**
+     *
+     * @brief  The integer entries of a column.
+     *
+     * Converted on the first call. NaN, fractions and numbers beyond
+     * the range of int are not whole numbers.
+     *
+     * Inherited from @ref mcmc_input.
+     *
+     */
+    virtual numa_vector<int> const *intValued(std::string const &name) {
+        size_t k = find(name);
+        if(k == names.size()) {
+            return 0;
+        }
+        if(ints[k]) {
+            return ints[k].get();
+        }
+        numa_vector<double> const &real = *reals[k];
+        std::vector<int> values(nrows);
+        for(size_t i = 0; i < nrows; ++i) {
+            double x = real[i];
+            if(!(x == std::floor(x) && x >= INT_MIN && x <= INT_MAX)) {
+                std::ostringstream out;
+                out << "column " << name << " is not integer valued at row " << i + 1;
+                message = out.str();
+                return 0;
+            }
+            values[i] = static_cast<int>(x);
+        }
+        boost::shared_ptr<numa_vector<int> > column(new numa_vector<int>());
+        if(!place(*column, nrows > 0 ? &values[0] : 0, nrows)) {
+            return 0;
+        }
+        ints[k] = column;
+
+        return column.get();
+    }
+
+    /**
+     *
+     * @brief The real entries of a column.
+     *
+     * Inherited from @ref mcmc_input.
+     *
+     */
+    virtual numa_vector<double> const *realValued(std::string const &name) {
+        size_t k = find(name);
+
+        return k < names.size() ? reals[k].get() : 0;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the columns would be shared.
+     *
+     */
+    data_frame(data_frame const &other);
+    data_frame& operator=(data_frame const &other);
+
+    /**
+     *
+     * @brief  Index of a column.
+     * @return The index, or the number of columns if there is none,
+     *         with @ref error set.
+     *
+     */
+    size_t find(std::string const &name) {
+        size_t k = 0;
+        while(k < names.size() && names[k] != name) {
+            ++k;
+        }
+        if(k == names.size()) {
+            message = "no column " + name;
+        }
+
+        return k;
+    }
+
+    /**
+     *
+     * @brief  Allocates a column, sets its policy and writes it.
+     * @return False, if the memory or the policy is refused.
+     *
+     */
+    template<class T>
+    bool place(numa_vector<T> &column, T const *src, size_t n) {
+        if(!column.allocate(n)) {
+            message = column.error();
+            return false;
+        }
+        if((how == BIND_NODE && !column.bind(node)) || (how == INTERLEAVED && !column.interleave())) {
+            message = std::string(how == BIND_NODE ? "binding to the node" : "interleaving") +
+                " failed: " + column.error();
+            return false;
+        }
+        column.assign(src, pool, chunk);
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief The placement of columns assigned later.
+     *
+     */
+    placement how;
+
+    /**
+     *
+     * @brief The node of BIND_NODE.
+     *
+     */
+    int node;
+
+    /**
+     *
+     * @brief The pool writing the columns, not owned.
+     *
+     */
+    thread_pool *pool;
+
+    /**
+     *
+     * @brief Number of rows per task writing a column.
+     *
+     */
+    size_t chunk;
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t nrows;
+
+    /**
+     *
+     * @brief The names of the columns.
+     *
+     */
+    std::vector<std::string> names;
+
+    /**
+     *
+     * @brief The real columns.
+     *
+     */
+    std::vector<boost::shared_ptr<numa_vector<double> > > reals;
+
+    /**
+     *
+     * @brief The integer columns, null until converted.
+     *
+     */
+    std::vector<boost::shared_ptr<numa_vector<int> > > ints;
+};
 
+#endif	/* DATA_FRAME_H */
@@ -0,0 +1,154 @@
+/**
+ *
+ * @file exponential_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 13, 2012, 10:30 AM
+ *
+ * @brief Log-density of the Exponential distribution.
+ *
+ * Columns: observations y and rates lambda. The log-density is
+ * log(lambda) - lambda * y.
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef EXPONENTIAL_LIKELIHOOD_H
+#define	EXPONENTIAL_LIKELIHOOD_H
+
+#include <cmath>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Exponential log-density kernel for the instruction set V.
+ *
+ */
+template<class V>
+class exponential_kernel {
+public:
+
+    exponential_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), rate(args[1]),
+    log_rate(V::set1(rate.scalar ? std::log(args[1][0]) : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg r = rate(i);
+
+        return V::fnmadd(r, y(i), rate.scalar ? log_rate : V::log(r));
+    }
+
+    simd_column<V> y, rate;
+    typename V::reg log_rate;
+};
+
+class exponential_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~exponential_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y and lambda.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y and lambda.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        return simd_sum<exponential_kernel>(args);
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-density of a single observation.
+     * @param row y and lambda of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return std::log(row[1]) - row[1] * row[0];
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y and lambda.
+     * @param grad Derivatives with respect to y and lambda.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            if(grad[0]) {
+                grad[0][i] = -args[1][i];
+            }
+            if(grad[1]) {
+                grad[1][i] = 1 / args[1][i] - args[0][i];
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief Both arguments are conjugate.
+     *
+     */
+    virtual bool isConjugate (size_t arg) const {
+        return arg < 2;
+    };
+
+    /**
+     *
+     * @brief Computes the coefficients of the sufficient statistics.
+     * @param args Views on y and lambda.
+     * @param arg Index of the argument.
+     * @param stats Coefficients of x, x^2, log x and x^(-2).
+     *
+     * In y a term is -lambda y, in lambda it is log lambda - lambda y.
+     *
+     */
+    virtual void sufficientStatistics (std::vector<argument_view> const &args, size_t arg,
+        std::vector<double*> const &stats) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            stats[0][i] = -args[1 - arg][i];
+            stats[1][i] = 0;
+            stats[2][i] = arg == 1 ? 1.0 : 0.0;
+            stats[3][i] = 0;
+        }
+    };
+};
+#endif	/* EXPONENTIAL_LIKELIHOOD_H */
+
@@ -0,0 +1,166 @@
+/**
+ *
+ * @file gamma_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 12, 2012, 4:30 PM
+ *
+ * @brief Log-density of the Gamma distribution.
+ *
+ * Columns: observations y, shapes a and rates b. The log-density is
+ * a * log(b) - lgamma(a) + (a - 1) * log(y) - b * y.
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef GAMMA_LIKELIHOOD_H
+#define	GAMMA_LIKELIHOOD_H
+
+#include <cmath>
+#include <boost/math/special_functions/digamma.hpp>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Gamma log-density kernel for the instruction set V, without
+ *        the lgamma(a) term.
+ *
+ */
+template<class V>
+class gamma_kernel {
+public:
+
+    gamma_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), shape(args[1]), rate(args[2]),
+    log_rate(V::set1(rate.scalar ? std::log(args[2][0]) : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg a = shape(i);
+        typename V::reg x = y(i);
+        typename V::reg b = rate(i);
+        typename V::reg lb = rate.scalar ? log_rate : V::log(b);
+        typename V::reg r = V::fmadd(V::sub(a, V::set1(1.0)), V::log(x), V::mul(a, lb));
+
+        return V::fnmadd(b, x, r);
+    }
+
+    simd_column<V> y, shape, rate;
+    typename V::reg log_rate;
+};
+
+class gamma_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~gamma_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y, a and b.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y, a and b.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        return simd_sum<gamma_kernel>(args) - sum_lgamma(args[1], args[0].size());
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-density of a single observation.
+     * @param row y, a and b of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return row[1] * std::log(row[2]) - std::lgamma(row[1]) + (row[1] - 1) * std::log(row[0]) - row[2] * row[0];
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y, a and b.
+     * @param grad Derivatives with respect to y, a and b.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            double y = args[0][i];
+            double a = args[1][i];
+            double b = args[2][i];
+            if(grad[0]) {
+                grad[0][i] = (a - 1) / y - b;
+            }
+            if(grad[1]) {
+                grad[1][i] = std::log(b) - boost::math::digamma(a) + std::log(y);
+            }
+            if(grad[2]) {
+                grad[2][i] = a / b - y;
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief The observations and the rates are conjugate.
+     *
+     */
+    virtual bool isConjugate (size_t arg) const {
+        return arg == 0 || arg == 2;
+    };
+
+    /**
+     *
+     * @brief Computes the coefficients of the sufficient statistics.
+     * @param args Views on y, a and b.
+     * @param arg Index of the argument, zero or two.
+     * @param stats Coefficients of x, x^2, log x and x^(-2).
+     *
+     * In y a term is (a - 1) log y - b y, in b it is a log b - b y.
+     *
+     */
+    virtual void sufficientStatistics (std::vector<argument_view> const &args, size_t arg,
+        std::vector<double*> const &stats) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            stats[0][i] = -args[2 - arg][i];
+            stats[1][i] = 0;
+            stats[2][i] = arg == 0 ? args[1][i] - 1 : args[1][i];
+            stats[3][i] = 0;
+        }
+    };
+};
+#endif	/* GAMMA_LIKELIHOOD_H */
+
@@ -0,0 +1,279 @@
+/**
+ * 
+ * @file group_argument_maker.cpp
+ * @author Lars Simon Zehnder
+ * 
+ * @created June 4, 2012, 2:10 PM
+ * 
+ * @brief Maps group-level parameters onto the observations of 
+ *        each group.
+ * 
+ * The class inherits directly from @ref argument_maker
+ * interface class.
+ * 
+ * @see argument_maker
+ * 
+ */
+
+#include <algorithm>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "group_argument_maker.h"
+
+/**
+ * 
+ * @brief Custom constructor
+ * @param which Identifies the parameter holding the group values.
+ * @param groups Group index of each observation, starting at zero.
+ * 
+ * If %groups is sorted, the maker works in range mode.
+ * 
+ */
+group_argument_maker::group_argument_maker(int const &which, std::vector<int> const &groups) : 
+which(which), groups(groups), ranged(false) {
+    index();
+}
+
+/**
+ * 
+ * @brief Copy constructor.
+ * @param other Other %group_argument_maker from which %this should be constructed. 
+ * 
+ */
+group_argument_maker::group_argument_maker(group_argument_maker const &other) {
+    swap(other);
+}
+
+/**
+ * 
+ * @brief Default destructor.
+ * 
+ */
+group_argument_maker::~group_argument_maker() {};
+
+/**
+ * 
+ * @brief  Gathers the group values for each observation.
+ * @param  params Parameters to be changed by the argument. 
+ * @return Argument.
+ * 
+ * Inherited from argument_maker.
+ * 
+ * @see argument_maker
+ * 
+ */
+std::vector<double> group_argument_maker::getArgument(std::vector<argument_view> const &params) {
+    std::vector<double> temp(groups.size());
+    if(!temp.empty()) {
+        fillArgument(params, &temp[0]);
+    }
+    
+    return temp;
+}
+
+/**
+ * 
+ * @brief  Gathers the group values into caller-owned storage.
+ * @param  params Parameters to be changed by the argument. 
+ * @param  out Storage the argument is written to.
+ * 
+ * Inherited from argument_maker.
+ * 
+ * @see argument_maker
+ * 
+ */
+void group_argument_maker::fillArgument(std::vector<argument_view> const &params, double *out) {
+    gather(params[which].data, 0, groups.size(), out);
+}
+
+/**
+ * 
+ * @brief  Makes a range of the argument available.
+ * @param  params Parameters to be changed by the argument. 
+ * @param  begin Index of the first observation.
+ * @param  end Index one past the last observation.
+ * @param  storage Storage used, if the range spans several groups. 
+ * @return View on the entries [begin, end) of the argument.
+ * 
+ * In range mode a range within a single group is a broadcast of the
+ * group value and nothing is copied. This is always the case for the
+ * terms touched by a group value.
+ * 
+ * @see argument_maker
+ * 
+ */
+argument_view group_argument_maker::makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage) {
+    if(ranged && begin < end && groups[begin] == groups[end - 1]) {
+        return argument_view(params[which].data + groups[begin], 0, end - begin);
+    }
+    gather(params[which].data, begin, end, storage);
+    
+    return argument_view(storage, 1, end - begin);
+}
+
+/**
+ * 
+ * @brief  Collects the observations depending on a group value.
+ * @param  whatami Index of the parameter vector in the bond.
+ * @param  which Index of the group.
+ * @param  terms Container the dependent observations are appended to.
+ * @return Always true, the dependency is known.
+ * 
+ * @see argument_maker
+ * 
+ */
+bool group_argument_maker::dependentTerms(int whatami, int which, std::vector<size_t> &terms) const {
+    if(whatami != this->which || which < 0 || (size_t) which + 1 >= offsets.size()) {
+        return true;
+    }
+    if(ranged) {
+        for(size_t i = offsets[which]; i < offsets[which + 1]; ++i) {
+            terms.push_back(i);
+        }
+    } else {
+        terms.insert(terms.end(), members.begin() + offsets[which], members.begin() + offsets[which + 1]);
+    }
+    
+    return true;
+}
+
+/**
+ * 
+ * @brief  Propagates derivatives with respect to the argument.
+ * @param  params Parameters the argument is made of.
+ * @param  whatami Index of the parameter vector in the bond.
+ * @param  grad Derivatives with respect to the observations.
+ * @param  out Derivatives with respect to %params[whatami].
+ * 
+ * Each observation adds its derivative to the value of its group.
+ * 
+ * @see argument_maker
+ * 
+ */
+void group_argument_maker::addGradient(std::vector<argument_view> const &params, int whatami, 
+    double const *grad, std::vector<double> &out) const {
+    if(whatami != this->which) {
+        return;
+    }
+    for(size_t i = 0; i < groups.size(); ++i) {
+        out[groups[i]] += grad[i];
+    }
+}
+
+/**
+ * 
+ * @brief Indicates if the observations are sorted by group.
+ * @return True, if the maker works in range mode.
+ * 
+ */
+bool group_argument_maker::isRanged() const {
+    return ranged;
+}
+
+/**
+ *
+ * @brief Custom assignment operator.
+ * @param other Other %group_argument_maker object.
+ *
+ * Assigns the other group_argument_maker to this.
+ */
+group_argument_maker& group_argument_maker::operator=(group_argument_maker const &other) {
+	group_argument_maker temp(other);
+	swap(temp);
+
+	return *this;
+}
+
+/**
+ *
+ * @brief Builds the group offsets and, if the observations are not 
+ *        sorted by group, the observations ordered by group. 
+ *
+ * The latter is a counting sort, i.e. stable and linear in the number
+ * of observations.
+ *
+ */
+void group_argument_maker::index() {
+    int ngroups = groups.empty() ? 0 : *std::max_element(groups.begin(), groups.end()) + 1;
+    offsets.assign(ngroups + 1, 0);
+    for(size_t i = 0; i < groups.size(); ++i) {
+        ++offsets[groups[i] + 1];
+    }
+    for(int g = 0; g < ngroups; ++g) {
+        offsets[g + 1] += offsets[g];
+    }
+    ranged = true;
+    for(size_t i = 1; i < groups.size(); ++i) {
+        if(groups[i] < groups[i - 1]) {
+            ranged = false;
+            break;
+        }
+    }
+    members.clear();
+    if(!ranged) {
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        members.resize(groups.size());
+        for(size_t i = 0; i < groups.size(); ++i) {
+            members[next[groups[i]]++] = i;
+        }
+    }
+}
+
+/**
+ *
+ * @brief Writes the group value of each observation in [begin, end) 
+ *        into %out.
+ * @param values Group values.
+ * @param begin Index of the first observation.
+ * @param end Index one past the last observation.
+ * @param out Output, %out[0] receives the value of observation %begin.
+ *
+ * In range mode each group is a run that is filled with its value. 
+ * Otherwise the values are gathered through the group index, with
+ * AVX-512 or AVX2 gather instructions if available.
+ *
+ */
+void group_argument_maker::gather(double const *values, size_t begin, size_t end, double *out) const {
+    if(ranged) {
+        size_t i = begin;
+        while(i < end) {
+            int g = groups[i];
+            size_t stop = std::min(end, offsets[g + 1]);
+            std::fill(out + (i - begin), out + (stop - begin), values[g]);
+            i = stop;
+        }
+        return;
+    }
+    int const *idx = &groups[0];
+    size_t i = begin;
+#if defined(__AVX512F__)
+    for(; i + 8 <= end; i += 8) {
+        __m256i vidx = _mm256_loadu_si256((__m256i const *) (idx + i));
+        _mm512_storeu_pd(out + (i - begin), _mm512_i32gather_pd(vidx, values, 8));
+    }
+#elif defined(__AVX2__)
+    for(; i + 4 <= end; i += 4) {
+        __m128i vidx = _mm_loadu_si128((__m128i const *) (idx + i));
+        _mm256_storeu_pd(out + (i - begin), _mm256_i32gather_pd(values, vidx, 8));
+    }
+#endif
+    for(; i < end; ++i) {
+        out[i - begin] = values[idx[i]];
+    }
+}
+
+/**
+ *
+ * @brief Swaps the value from other to this.
+ * @param other.
+ *
+ */
+void group_argument_maker::swap(group_argument_maker const &other) {
+	this->which = other.which;
+	this->groups = other.groups;
+	this->offsets = other.offsets;
+	this->members = other.members;
+	this->ranged = other.ranged;
+}
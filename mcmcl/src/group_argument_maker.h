@@ -0,0 +1,244 @@
+/**
+ *
+ * @file group_argument_maker.h
+ * @author Lars Simon Zehnder
+ * 
+ * @created June 4, 2012, 2:10 PM
+ * 
+ * @brief Maps group-level parameters onto the observations of 
+ *        each group.
+ * 
+ * If y_{i,j} ~ N(mu_{i}, sigma^2), the %group_argument_maker makes
+ * an array of the same length as y with mu_{i} matched with each of
+ * the y_{i,j}s. The matching is stored as a compact array holding 
+ * the group index of each observation and the argument is made by 
+ * a gather over this array. If the observations are sorted by 
+ * group, the maker switches into a range mode, where each group 
+ * is a contiguous range of observations and no gather is needed.
+ * A scalar like sigma is mapped by putting all observations into 
+ * group zero.
+ * 
+ * @see argument_maker
+ * @see identity_argument_maker
+ * 
+ */
+#ifndef GROUP_ARGUMENT_MAKER_H
+#define	GROUP_ARGUMENT_MAKER_H
+
+#include "argument_maker.h"
+
+class group_argument_maker : public argument_maker {
+public:
+    
+    /**
+     *
+     * @brief Custom constructor.
+     * @param which Identifies the parameter holding the group values.
+     * @param groups Group index of each observation. 
+     * 
+     */
+    group_argument_maker (int const &which, std::vector<int> const &groups);
+    
+    /**
+     *
+     * @brief Copy constructor
+     * 
+     */
+    group_argument_maker (group_argument_maker const &other);
+    
+    /**
+     *
+     * @brief Default destructor
+     * 
+     */
+    ~group_argument_maker();
+    
+    /**
+     *
+     * @brief Gathers the group values for each observation.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    std::vector<double> getArgument(std::vector<argument_view> const &params); 
+    
+    /**
+     *
+     * @brief Gathers the group values into the storage %out.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    void fillArgument(std::vector<argument_view> const &params, double *out);
+    
+    /**
+     *
+     * @brief Makes a range of the argument available, a range within
+     *        a single group is a broadcast of the group value.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    argument_view makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage);
+    
+    /**
+     *
+     * @brief Returns the length of the argument, the number of 
+     *        observations.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    size_t getSize(std::vector<argument_view> const &params) const {
+        return groups.size();
+    }
+    
+    /**
+     *
+     * @brief Returns the group value of a single observation.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    double getArgumentAt(std::vector<argument_view> const &params, size_t i) {
+        return params[which][groups[i]];
+    }
+    
+    /**
+     *
+     * @brief The observations of group %which depend on coordinate 
+     *        %which.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool dependentTerms(int whatami, int which, std::vector<size_t> &terms) const;
+    
+    /**
+     *
+     * @brief The group values pass derivatives through.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool hasGradient() const {
+        return true;
+    }
+    
+    /**
+     *
+     * @brief Sums the derivatives of the observations of each group 
+     *        into the group value.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    void addGradient(std::vector<argument_view> const &params, int whatami, 
+        double const *grad, std::vector<double> &out) const;
+    
+    /**
+     *
+     * @brief Only parameter %which enters the argument.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool dependsOn(int whatami) const {
+        return whatami == which;
+    }
+    
+    /**
+     *
+     * @brief Each entry is the coordinate of parameter %which for its group.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool isSelection(int whatami) const {
+        return whatami == which;
+    }
+    
+    /**
+     *
+     * @brief Indicates if the observations are sorted by group.
+     * 
+     */
+    bool isRanged() const;
+    
+    /**
+     *
+     * @brief Custom assignment operator.
+     * @param other Other %group_argument_maker object.
+     *
+     */
+    group_argument_maker& operator=(group_argument_maker const &other);
+
+private:
+    /**
+     * @brief Stores the index of the parameter vector holding the 
+     *        group values.
+     */
+    int which;
+    
+    /**
+     * @brief Group index of each observation.
+     * 
+     */
+    std::vector<int> groups;
+    
+    /**
+     * @brief Start of each group in %members, in range mode start of 
+     *        each group in the observations. Has one entry more than 
+     *        there are groups.
+     * 
+     */
+    std::vector<size_t> offsets;
+    
+    /**
+     * @brief Observations ordered by group, empty in range mode.
+     * 
+     */
+    std::vector<size_t> members;
+    
+    /**
+     * @brief Determines if the observations are sorted by group.
+     * 
+     */
+    bool ranged;
+    
+    /**
+     *
+     * @brief Builds %offsets and %members from %groups.
+     *
+     */
+    void index();
+    
+    /**
+     *
+     * @brief Writes the group value of each observation in [begin, end)
+     *        into %out.
+     *
+     */
+    void gather(double const *values, size_t begin, size_t end, double *out) const;
+
+    /**
+     *
+     * @brief Swaps the value from other to this.
+     * @param other.
+     *
+     */
+    void swap(group_argument_maker const &other);
+};
+
+#endif	/* GROUP_ARGUMENT_MAKER_H */
+
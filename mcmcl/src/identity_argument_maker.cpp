@@ -17,6 +17,8 @@
  * 
  */
 
+#include <algorithm>
+
 #include "identity_argument_maker.h"
 
 /**
@@ -56,12 +58,108 @@ identity_argument_maker::~identity_argument_maker() {};
  * @see argument_maker
  * 
  */
-std::vector<double> identity_argument_maker::getArgument(std::vector<std::vector<double> > const &params) {
-    std::vector<double> temp(params[which]);
+std::vector<double> identity_argument_maker::getArgument(std::vector<argument_view> const &params) {
+    std::vector<double> temp(params[which].data, params[which].data + params[which].size());
     
     return temp;
 }
 
+/**
+ * 
+ * @brief  Copies the parameter vector into caller-owned storage.
+ * @param  params Parameters to be changed by the argument. 
+ * @param  out Storage the argument is written to.
+ * 
+ * Inherited from argument_maker.
+ * 
+ * @see argument_maker
+ * 
+ */
+void identity_argument_maker::fillArgument(std::vector<argument_view> const &params, double *out) {
+    std::copy(params[which].data, params[which].data + params[which].size(), out);
+}
+
+/**
+ * 
+ * @brief  Returns a view on the parameter vector.
+ * @param  params Parameters to be changed by the argument. 
+ * @param  storage Unused, the parameter vector is referenced directly.
+ * @return View on %params[which].
+ * 
+ * Inherited from argument_maker.
+ * 
+ * @see argument_maker
+ * 
+ */
+argument_view identity_argument_maker::makeArgument(std::vector<argument_view> const &params, double *storage) {
+    return params[which];
+}
+
+/**
+ * 
+ * @brief  Returns a view on a range of the parameter vector.
+ * @param  params Parameters to be changed by the argument. 
+ * @param  begin Index of the first entry.
+ * @param  end Index one past the last entry.
+ * @param  storage Unused, the parameter vector is referenced directly.
+ * @return View on the entries [begin, end) of %params[which].
+ * 
+ * Inherited from argument_maker.
+ * 
+ * @see argument_maker
+ * 
+ */
+argument_view identity_argument_maker::makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage) {
+    return params[which].slice(begin, end);
+}
+
+/**
+ * 
+ * @brief  Collects the entries depending on a parameter coordinate.
+ * @param  whatami Index of the parameter vector in the bond.
+ * @param  which Index of the coordinate in that parameter vector.
+ * @param  terms Container the dependent entries are appended to.
+ * @return Always true, the dependency is known.
+ * 
+ * The identity argument passes coordinates through, so only the 
+ * entry with the same index depends on it and only if %whatami is
+ * the parameter this argument is made of.
+ * 
+ * @see argument_maker
+ * 
+ */
+bool identity_argument_maker::dependentTerms(int whatami, int which, std::vector<size_t> &terms) const {
+    if(whatami == this->which) {
+        terms.push_back(which);
+    }
+    
+    return true;
+}
+
+/**
+ * 
+ * @brief  Propagates derivatives with respect to the argument.
+ * @param  params Parameters the argument is made of.
+ * @param  whatami Index of the parameter vector in the bond.
+ * @param  grad Derivatives with respect to the entries of the argument.
+ * @param  out Derivatives with respect to %params[whatami].
+ * 
+ * Entry i is coordinate i of the parameter, if %whatami is the 
+ * parameter this argument is made of.
+ * 
+ * @see argument_maker
+ * 
+ */
+void identity_argument_maker::addGradient(std::vector<argument_view> const &params, int whatami, 
+    double const *grad, std::vector<double> &out) const {
+    if(whatami != this->which) {
+        return;
+    }
+    for(size_t i = 0; i < params[which].size(); ++i) {
+        out[i] += grad[i];
+    }
+}
+
 /**
  *
  * @brief Custom assignment operator.
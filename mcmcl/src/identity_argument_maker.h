@@ -46,7 +46,120 @@ public:
      * 
      * @see argument_maker
      */
-    std::vector<double> getArgument(std::vector<std::vector<double> > const &params); 
+    std::vector<double> getArgument(std::vector<argument_view> const &params); 
+    
+    /**
+     *
+     * @brief Copies the parameter vector into the storage %out.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    void fillArgument(std::vector<argument_view> const &params, double *out);
+    
+    /**
+     *
+     * @brief Returns a view on the parameter vector, no copy is made.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    argument_view makeArgument(std::vector<argument_view> const &params, double *storage);
+    
+    /**
+     *
+     * @brief Returns a view on a range of the parameter vector.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    argument_view makeArgumentRange(std::vector<argument_view> const &params, size_t begin, size_t end, double *storage);
+    
+    /**
+     *
+     * @brief Returns the length of the argument.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    size_t getSize(std::vector<argument_view> const &params) const {
+        return params[which].size();
+    }
+    
+    /**
+     *
+     * @brief Returns a single entry of the identity argument.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    double getArgumentAt(std::vector<argument_view> const &params, size_t i) {
+        return params[which][i];
+    }
+    
+    /**
+     *
+     * @brief Entry %which of parameter %which is the only entry that 
+     *        depends on coordinate %which.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool dependentTerms(int whatami, int which, std::vector<size_t> &terms) const;
+    
+    /**
+     *
+     * @brief The identity passes derivatives through.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool hasGradient() const {
+        return true;
+    }
+    
+    /**
+     *
+     * @brief Adds the derivatives of the entries to the coordinates 
+     *        with the same index.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    void addGradient(std::vector<argument_view> const &params, int whatami, 
+        double const *grad, std::vector<double> &out) const;
+    
+    /**
+     *
+     * @brief Only parameter %which enters the argument.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool dependsOn(int whatami) const {
+        return whatami == which;
+    }
+    
+    /**
+     *
+     * @brief Entry i is coordinate i of parameter %which.
+     * 
+     * Inherited from argument_maker.
+     * 
+     * @see argument_maker
+     */
+    bool isSelection(int whatami) const {
+        return whatami == which;
+    }
     
     /**
      *
@@ -0,0 +1,165 @@
+/**
+ *
+ * @file mapped_file.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 2, 2012, 9:40 AM
+ *
+ * @brief Read-only memory mapping of a file.
+ *
+ * The %mapped_file maps a whole file into the address space, such
+ * that readers parse it in place, without copying it into buffers.
+ * Pages are read by the operating system when they are touched, in
+ * any order and from any thread. The mapping is released by
+ * @ref close or the destructor.
+ *
+ * @see csv_data_reader
+ *
+ */
+#ifndef MAPPED_FILE_H
+#define	MAPPED_FILE_H
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class mapped_file {
+public:
+
+    /**
+     *
+     * @brief Default constructor, maps nothing.
+     *
+     */
+    mapped_file() : addr(0), length(0) {};
+
+    /**
+     *
+     * @brief Destructor, releases the mapping.
+     *
+     */
+    ~mapped_file() {
+        close();
+    };
+
+    /**
+     *
+     * @brief  Maps a file.
+     * @param  path Path of the file.
+     * @param  sequential Tells the system that the file is read front
+     *         to back, such that it reads ahead.
+     * @return True, if the file is mapped. Otherwise @ref error tells
+     *         why.
+     *
+     * An empty file is mapped with a null @ref data.
+     *
+     */
+    bool open(std::string const &path, bool sequential = true) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            message = path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            message = path + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        if(length > 0) {
+            void *p = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED) {
+                message = path + ": " + std::strerror(errno);
+                length = 0;
+                ::close(fd);
+                return false;
+            }
+            addr = static_cast<char const*>(p);
+            if(sequential) {
+                madvise(p, length, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Releases the mapping, if any.
+     *
+     */
+    void close() {
+        if(addr != 0) {
+            munmap(const_cast<char*>(addr), length);
+        }
+        addr = 0;
+        length = 0;
+    }
+
+    /**
+     *
+     * @brief The first byte of the file, null if nothing is mapped.
+     *
+     */
+    char const *data() const {
+        return addr;
+    }
+
+    /**
+     *
+     * @brief Number of bytes of the file.
+     *
+     */
+    size_t size() const {
+        return length;
+    }
+
+    /**
+     *
+     * @brief Why the last @ref open failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the mapping is released once.
+     *
+     */
+    mapped_file(mapped_file const &other);
+    mapped_file& operator=(mapped_file const &other);
+
+    /**
+     *
+     * @brief Start of the mapping.
+     *
+     */
+    char const *addr;
+
+    /**
+     *
+     * @brief Length of the mapping.
+     *
+     */
+    size_t length;
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
+};
+
+#endif	/* MAPPED_FILE_H */
@@ -8,18 +8,25 @@
  * 
  * Interface class that defines terms in the posterior distribution.
  * A statistical model is considered to be a product of %mcmc_bonds.
- * The critical methods are the compute methods, which calculate 
- * differences of logged values of the terms, at the proposed new value
- * of the parameters minus the current value. Main inheriting class is
- * @ref basic_mcmc_bond. 
+ * A bond is updated in two phases: @ref propose computes the 
+ * difference of the logged value of the term at the proposed new 
+ * value of a parameter minus the current value, and afterwards 
+ * exactly one of @ref accept or @ref reject is called. A bond keeps
+ * only what it needs to undo the proposal, so neither phase copies
+ * the parameters. Main inheriting class is @ref basic_mcmc_bond. 
  * 
  * @see basic_mcmc_bond
  *
  */
 #ifndef MCMC_BOND_H
 #define	MCMC_BOND_H
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
+class mcmc_node;
+class thread_pool;
+
 class mcmc_bond {
 public:
     
@@ -37,23 +44,254 @@ public:
      *        bond should be computed. 
      * @param which The index of the parameter in @ref mcmc_parameter::value.
      * 
-     * This function computes the log likelihood and returns its value for
-     * the bond.
+     * This function computes the log likelihood difference for the 
+     * proposal and returns it. The bond remembers the proposal until
+     * @ref accept or @ref reject is called.
+     * 
+     */
+    virtual double propose(int whatami, double newpar, int which) {return newpar;};
+    
+    /*
+     * @brief Computes the difference in the posterior term for a 
+     *        joint proposal of several coordinates of a parameter.
+     * @param whatami Indicates the corresponding parameter for which
+     *        the bond is relevant.
+     * @param which The indices of the coordinates in 
+     *        @ref mcmc_parameter::value.
+     * @param newpar The proposed candidates, one per coordinate.
+     * 
+     * Finished by @ref accept or @ref reject like @ref propose.
+     * 
+     */
+    virtual double proposeBlock(int whatami, std::vector<size_t> const &which, 
+        std::vector<double> const &newpar) {return 0;};
+    
+    /*
+     * @brief Computes the difference in the posterior term for a 
+     *        proposal and may stop once it is certainly below a floor.
+     * @param whatami Indicates the corresponding parameter for which
+     *        the bond is relevant.
+     * @param newpar The newly proposed parameter candidate.
+     * @param which The index of the parameter in @ref mcmc_parameter::value.
+     * @param floor The proposal is rejected if the difference is below
+     *        %floor.
+     * 
+     * Returns the difference like @ref propose or, if the bond stopped
+     * early, an upper bound of it below %floor. Finished by 
+     * @ref accept or @ref reject, a proposal below %floor is always 
+     * rejected. The default computes the full difference.
+     * 
+     */
+    virtual double proposeBounded(int whatami, double newpar, int which, double floor) {
+        return propose(whatami, newpar, which);
+    };
+    
+    /*
+     * @brief Bounds the difference of a proposal from above without
+     *        computing it.
+     * @param whatami Indicates the corresponding parameter for which
+     *        the bond is relevant.
+     * @param newpar The newly proposed parameter candidate.
+     * @param which The index of the parameter in @ref mcmc_parameter::value.
+     * 
+     * Returns a bound of what @ref propose would return, HUGE_VAL if
+     * none is known. Leaves no proposal pending. Used to give the 
+     * bonds proposed to before this one a floor of their own, see 
+     * @ref proposeBounded. The default knows no bound.
      * 
      */
-    virtual double compute(int whatami, double newpar, int which) {return newpar;};
+    virtual double changeBound(int whatami, double newpar, int which) {
+        return HUGE_VAL;
+    };
     
     /*
-     * @brief Revises the bond's current value to the new value.
+     * @brief Accepts the last proposal.
      * 
      * To ensure performance %mcmc_bonds are holding their current
      * value until the next replication of the algorithm. If the 
-     * newly proposed parameter value is accepted the bonds current
-     * value is revised. Otherwise the current value remains for the 
-     * next replication. 
+     * newly proposed parameter value is accepted, the value computed
+     * for the proposal becomes the current value of the bond.
+     * 
+     */
+    virtual void accept() {};
+    
+    /*
+     * @brief Rejects the last proposal.
+     * 
+     * The bond returns to the state before the proposal, the current
+     * value remains for the next replication.
+     * 
+     */
+    virtual void reject() {};
+    
+    /*
+     * @brief Adds the derivatives of the logged bond with respect to a
+     *        parameter.
+     * @param whatami Indicates the corresponding parameter.
+     * @param grad One entry per coordinate of the parameter, the 
+     *        derivatives are added.
+     * @return True, if the bond computed the derivatives. Otherwise 
+     *         %grad is unchanged and the caller differentiates 
+     *         numerically through @ref proposeBlock.
+     * 
+     * The derivatives are taken at the state of the last proposal, if
+     * it is neither accepted nor rejected, else at the current state.
+     * 
+     */
+    virtual bool gradient(int whatami, std::vector<double> &grad) {return false;};
+    
+    /*
+     * @brief Collects the terms of the bond that depend on a 
+     *        coordinate of a parameter.
+     * @param whatami Indicates the corresponding parameter.
+     * @param which Index of the coordinate.
+     * @param terms The indices of the terms are appended.
+     * @return True, if the dependency is known. 
+     * 
+     * Coordinates without common terms in any bond are conditionally
+     * independent and can be updated concurrently, see 
+     * mcmc_parameter::setChromatic.
+     * 
+     */
+    virtual bool dependentTerms(int whatami, size_t which, std::vector<size_t> &terms) const {return false;};
+    
+    /*
+     * @brief Computes the difference in the terms of one coordinate.
+     * @param whatami Indicates the corresponding parameter.
+     * @param which Index of the coordinate.
+     * @param newpar The candidate for the coordinate.
+     * 
+     * Unlike @ref propose the bond keeps its state: the proposal needs
+     * no @ref accept or @ref reject, an accepted coordinate reaches the
+     * bond through @ref moveTo. Can be called concurrently for 
+     * coordinates without common terms, see @ref dependentTerms, if 
+     * no other proposal is pending.
+     * 
+     */
+    virtual double proposeCoordinate(int whatami, size_t which, double newpar) {return 0;};
+    
+    /*
+     * @brief Indicates if the bond is conjugate in a parameter.
+     * @param whatami Indicates the corresponding parameter.
+     * 
+     * A conjugate bond is, as a function of each coordinate x of the
+     * parameter, s_0 x + s_1 x^2 + s_2 log x + s_3 x^(-2) plus terms 
+     * free of x, see @ref addStatistics.
+     * 
+     */
+    virtual bool isConjugate(int whatami) const {return false;};
+    
+    /*
+     * @brief Adds the coefficients of the sufficient statistics of a
+     *        conjugate parameter.
+     * @param whatami Indicates the corresponding parameter.
+     * @param stats %CONJUGATE_STATS vectors with one entry per 
+     *        coordinate of the parameter, the coefficients s_j of the
+     *        bond are added to stats[j].
+     * 
+     * Only called if @ref isConjugate is true. Rejects a pending 
+     * proposal.
+     * 
+     */
+    virtual void addStatistics(int whatami, std::vector<std::vector<double> > &stats) {};
+    
+    /*
+     * @brief Moves a conjugate parameter to a value drawn outside the
+     *        bond.
+     * @param whatami Indicates the corresponding parameter.
+     * @param value The new value of all coordinates.
+     * @param change The logged bond at %value minus the one at the old
+     *        value, known from the statistics.
+     * 
+     * The bond takes the change instead of computing itself again.
+     * 
+     */
+    virtual void moveTo(int whatami, std::vector<double> const &value, double change) {};
+    
+    /*
+     * @brief Attaches the nodes the bond is computed from.
+     * @param nodes The nodes in the order of the bond's arguments,
+     *        owned by the caller, e.g. an @ref mcmc_model.
+     * 
+     * The bond reads the current values of the nodes. Afterwards it 
+     * only learns about changes through @ref propose.
+     * 
+     */
+    virtual void attach(std::vector<mcmc_node const*> const &nodes) {};
+    
+    /*
+     * @brief Exchanges the state with a copy of the bond.
+     * @param other A copy of the bond, see @ref clone, attached to 
+     *        nodes of the same sizes.
+     * @return True, if the states have been exchanged. Otherwise 
+     *         neither bond changed and the caller attaches both again.
+     * 
+     * The bonds exchange what they know about their non-constant 
+     * nodes, including their current values, after the values of the
+     * nodes have been exchanged. Rejects a pending proposal. Used for
+     * swaps between tempered replicas, see mcmc_model::swapState.
+     * 
+     */
+    virtual bool swapState(mcmc_bond &other) {return false;};
+    
+    /*
+     * @brief Returns the logged value of the bond at the current state
+     *        of its nodes.
+     * 
+     * Rejects a proposal that is neither accepted nor rejected. Used 
+     * e.g. for swaps between tempered replicas.
+     * 
+     */
+    virtual double currentValue() {return 0;};
+    
+    /*
+     * @brief Returns the number of terms of the bond, a measure of the
+     *        cost of a proposal.
+     * 
+     */
+    virtual size_t numTerms() const {return 1;};
+    
+    /*
+     * @brief Copies the bond without its nodes.
+     * @return The copy, owned by the caller. Its nodes are attached 
+     *         by the caller, see @ref attach.
+     * 
+     * Used to copy a model, e.g. for several chains. State that does
+     * not change in an update, like the likelihood and the argument
+     * makers, may be shared with the copy.
+     * 
+     */
+    virtual mcmc_bond *clone() const = 0;
+    
+    /*
+     * @brief Sets the pool used to split the bond's own computation.
+     * @param pool The pool, or null for serial computation. Not owned.
+     * 
+     * A bond may be computed on any thread of the pool, in parallel 
+     * with other bonds of the same parameter.
      * 
      */
-    virtual void revise() {};
+    virtual void setThreadPool(thread_pool *pool) {};
+};
+
+/*
+ * @brief Entry of the adjacency of a parameter: a bond, the index
+ *        of the parameter in the bond's nodes and the weight of the
+ *        logged bond in the posterior.
+ * 
+ * The weight is one, except for tempered bonds, see 
+ * mcmc_model::setInverseTemperature.
+ * 
+ * @see mcmc_model
+ * 
+ */
+struct bond_ref {
+    bond_ref() : bond(0), whatami(0), weight(1) {};
+    bond_ref(mcmc_bond *bond, int whatami, double weight = 1) : bond(bond), whatami(whatami), weight(weight) {};
+    
+    mcmc_bond *bond;
+    int whatami;
+    double weight;
 };
 
 #endif	/* MCMCBOND_H */
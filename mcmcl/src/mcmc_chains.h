@@ -0,0 +1,273 @@
+/**
+ *
+ * @file mcmc_chains.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 25, 2012, 2:30 PM
+ *
+ * @brief Runs several independent chains of a model concurrently.
+ *
+ * The %mcmc_chains copy a model once per chain, see
+ * mcmc_model::clone, and seed chain c with the common key and chain
+ * number c, see mcmc_model::seed. The random streams of all chains
+ * and parameters are disjoint parts of one @ref philox_engine
+ * sequence, so the chains are independent and each chain gives the
+ * same draws for any number of threads.
+ *
+ * The chains run as tasks on an own @ref thread_pool, one task per
+ * chain. If there are fewer chains than threads, the chains compute
+ * their bonds on a second pool with the remaining threads. A chain
+ * waiting for its bonds then only runs bond tasks, never another
+ * chain, so the chains do not wait for each other. @ref stop ends a
+ * run early from
+ * any thread: every chain finishes its current update and @ref run
+ * returns. An exception thrown by a chain stops the others and is
+ * rethrown by @ref run after all chains returned. The destructor joins
+ * the threads.
+ *
+ * Example:
+ * @code
+ * mcmc_chains chains(model, 4, 20120625);
+ * chains.startAdaptation(1000);
+ * chains.run(5000);
+ * std::cout << chains.accepted();
+ * @endcode
+ *
+ * @see mcmc_model
+ * @see thread_pool
+ *
+ */
+#ifndef MCMC_CHAINS_H
+#define	MCMC_CHAINS_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "thread_pool.h"
+
+class mcmc_chains {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param model The model, finalized or not. It is copied and not
+     *        used afterwards.
+     * @param nchains Number of chains.
+     * @param key Seed of the random streams.
+     * @param nthreads Number of threads, all cores if zero.
+     * @param setup Called with each copy and its chain number before
+     *        it is seeded, e.g. to set a @ref nuts_update. May be
+     *        empty.
+     *
+     */
+    mcmc_chains(mcmc_model const &model, size_t nchains, uint64_t key, size_t nthreads = 0,
+        std::function<void(mcmc_model&, size_t)> const &setup = std::function<void(mcmc_model&, size_t)>()) :
+    pool(std::min(threads(nthreads), std::max<size_t>(nchains, 1))),
+    bond_pool(threads(nthreads) - pool.size() + 1), done(nchains, 0), errors(nchains), stopping(false) {
+        for(size_t c = 0; c < nchains; ++c) {
+            chains.push_back(boost::shared_ptr<mcmc_model>(model.clone()));
+            chains[c]->finalize();
+            if(setup) {
+                setup(*chains[c], c);
+            }
+            chains[c]->seed(key, c);
+            if(bond_pool.size() > 1) {
+                chains[c]->setThreadPool(&bond_pool);
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief Default destructor, joins the threads.
+     *
+     */
+    ~mcmc_chains() {};
+
+    /**
+     *
+     * @brief Runs every chain for a number of updates.
+     * @param iterations Number of updates of each chain. Each update
+     *        is followed by mcmc_model::updateOutput.
+     *
+     * Returns when all chains are done or stopped. Can be called
+     * again to continue the chains.
+     *
+     */
+    void run(size_t iterations) {
+        stopping.store(false);
+        pool.run(chains.size(), [this, iterations](size_t c) {
+            try {
+                for(size_t it = 0; it < iterations && !stopping.load(std::memory_order_relaxed); ++it) {
+                    chains[c]->update();
+                    chains[c]->updateOutput();
+                    ++done[c];
+                }
+            } catch(...) {
+                errors[c] = std::current_exception();
+                stopping.store(true);
+            }
+        });
+        for(size_t c = 0; c < chains.size(); ++c) {
+            if(errors[c]) {
+                std::exception_ptr e = errors[c];
+                errors[c] = std::exception_ptr();
+                std::rethrow_exception(e);
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Stops a run after the current update of every chain.
+     *
+     * Can be called from any thread.
+     *
+     */
+    void stop() {
+        stopping.store(true);
+    }
+
+    /**
+     *
+     * @brief Starts the adaptation of the step sizes in all chains.
+     *
+     * @see mcmc_model::startAdaptation
+     *
+     */
+    void startAdaptation(size_t burnin) {
+        for(size_t c = 0; c < chains.size(); ++c) {
+            chains[c]->startAdaptation(burnin);
+        }
+    }
+
+    /**
+     *
+     * @brief  Reports the acceptance statistics of all chains.
+     * @return For each chain a header line and the statistics of its
+     *         parameters, see mcmc_model::accepted.
+     *
+     */
+    std::string accepted() {
+        std::ostringstream out;
+        for(size_t c = 0; c < chains.size(); ++c) {
+            out << "chain " << c << " (" << done[c] << " updates):\n" << chains[c]->accepted();
+        }
+
+        return out.str();
+    }
+
+    /**
+     *
+     * @brief Finishes all chains.
+     *
+     */
+    void finish() {
+        for(size_t c = 0; c < chains.size(); ++c) {
+            chains[c]->finish();
+        }
+    }
+
+    /**
+     *
+     * @brief Returns the model of chain c.
+     *
+     */
+    mcmc_model &chain(size_t c) {
+        return *chains[c];
+    }
+
+    /**
+     *
+     * @brief Number of chains.
+     *
+     */
+    size_t numChains() const {
+        return chains.size();
+    }
+
+    /**
+     *
+     * @brief Number of updates chain c has done.
+     *
+     */
+    size_t iterations(size_t c) const {
+        return done[c];
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the chains use the pools.
+     *
+     */
+    mcmc_chains(mcmc_chains const &other);
+    mcmc_chains& operator=(mcmc_chains const &other);
+
+    /**
+     *
+     * @brief  Number of threads of a run.
+     * @param  nthreads Number of threads, all cores if zero.
+     *
+     */
+    static size_t threads(size_t nthreads) {
+        return nthreads > 0 ? nthreads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     *
+     * @brief The pool running the chains, one thread per chain at
+     *        most. Declared first, such that it is destroyed last.
+     *
+     */
+    thread_pool pool;
+
+    /**
+     *
+     * @brief The pool computing the bonds of all chains, with the
+     *        threads not running chains. A single thread, i.e.
+     *        unused, if there are as many chains as threads.
+     *
+     */
+    thread_pool bond_pool;
+
+    /**
+     *
+     * @brief The models of the chains.
+     *
+     */
+    std::vector<boost::shared_ptr<mcmc_model> > chains;
+
+    /**
+     *
+     * @brief Number of updates of each chain.
+     *
+     */
+    std::vector<size_t> done;
+
+    /**
+     *
+     * @brief Exception thrown by each chain in the current run, if
+     *        any.
+     *
+     */
+    std::vector<std::exception_ptr> errors;
+
+    /**
+     *
+     * @brief Set to end a run early.
+     *
+     */
+    std::atomic<bool> stopping;
+};
+
+#endif	/* MCMC_CHAINS_H */
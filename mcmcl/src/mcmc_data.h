@@ -0,0 +1,145 @@
+/**
+ *
+ * @file mcmc_data.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 5, 2012, 11:30 AM
+ *
+ * @brief Constant node referencing data stored elsewhere.
+ *
+ * An %mcmc_data enters a model like a constant @ref mcmc_parameter,
+ * see mcmc_model::addParameter, but holds no values of its own: it
+ * refers to a column of a @ref data_frame, of a mapped
+ * @ref column_file or to any other contiguous array of doubles. Bonds
+ * read it in place, see mcmc_node::isConstant, and copies made for
+ * further chains refer to the same storage. A data set is therefore
+ * held once, whatever the number of bonds and chains.
+ *
+ * The storage has to outlive the node and all its copies and must not
+ * change while bonds refer to it. The owner of the storage can be
+ * handed to the node, which then keeps it alive.
+ *
+ * Example:
+ * @code
+ * boost::shared_ptr<column_file> file(new column_file());
+ * cached.open("data.csv", *file);
+ * size_t k = ...;
+ * size_t y = model.addParameter(boost::shared_ptr<mcmc_parameter>(
+ *     new mcmc_data(file->column(k), file->rows(), "y", file)));
+ * @endcode
+ *
+ * @see mcmc_node
+ * @see data_frame
+ *
+ */
+#ifndef MCMC_DATA_H
+#define	MCMC_DATA_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_parameter.h"
+#include "numa_vector.h"
+
+class mcmc_data : public mcmc_parameter {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param data The first value, referenced.
+     * @param length Number of values.
+     * @param name Name of the node.
+     * @param owner Kept alive by the node and its copies, e.g. the
+     *        data_frame or column_file holding the values. May be
+     *        null.
+     *
+     */
+    mcmc_data(double const *data, size_t length, std::string const &name,
+    boost::shared_ptr<void const> const &owner = boost::shared_ptr<void const>()) :
+    mcmc_parameter(std::vector<double>(), std::vector<double>(), name), data(data), length(length),
+    owner(owner) {
+        const_val = true;
+    };
+
+    /**
+     *
+     * @brief Custom constructor referencing a column of a data_frame.
+     * @param column The column, see data_frame::realValued.
+     * @param name Name of the node.
+     * @param owner Kept alive by the node and its copies. May be null.
+     *
+     */
+    mcmc_data(numa_vector<double> const &column, std::string const &name,
+    boost::shared_ptr<void const> const &owner = boost::shared_ptr<void const>()) :
+    mcmc_parameter(std::vector<double>(), std::vector<double>(), name), data(column.data()),
+    length(column.size()), owner(owner) {
+        const_val = true;
+    };
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    virtual ~mcmc_data() {};
+
+    /**
+     *
+     * @brief  Copies the node, the copy refers to the same storage.
+     * @return The copy, owned by the caller.
+     *
+     * Inherited from @ref mcmc_parameter.
+     *
+     */
+    virtual mcmc_parameter *clone() const {
+        return new mcmc_data(*this);
+    }
+
+    /**
+     *
+     * @brief Returns a view on the referenced values.
+     *
+     * Inherited from @ref mcmc_node.
+     *
+     */
+    virtual argument_view values() const {
+        return argument_view(data, 1, length);
+    }
+
+    /**
+     *
+     * @brief Always true, the values are data.
+     *
+     * Inherited from @ref mcmc_node.
+     *
+     */
+    virtual bool isConstant() const {
+        return true;
+    }
+
+private:
+
+    /**
+     *
+     * @brief The first referenced value.
+     *
+     */
+    double const *data;
+
+    /**
+     *
+     * @brief Number of values.
+     *
+     */
+    size_t length;
+
+    /**
+     *
+     * @brief Keeps the storage alive, may be null.
+     *
+     */
+    boost::shared_ptr<void const> owner;
+};
+
+#endif	/* MCMC_DATA_H */
@@ -1,24 +1,76 @@
-/* 
- * File:   MCMCInput.h
- * Author: simonzehnder
+/**
+ *
+ * @file mcmc_input.h
+ * @author Lars Simon Zehnder
+ *
+ * @created May 15, 2012, 3:27 PM
+ *
+ * @brief Interface of the data a model conditions on.
+ *
+ * An %mcmc_input offers named columns of equal length, as real numbers
+ * or, if all entries are whole numbers, as integers. The columns are
+ * %numa_vector objects owned by the input, such that they stay valid
+ * as long as the input does.
+ *
+ * @see data_frame
  *
- * Created on May 15, 2012, 3:27 PM
  */
-
 #ifndef MCMC_INPUT_H
 #define	MCMC_INPUT_H
 
-#include <numav/numa_vector.h>
-#include <mpfr.h>
+#include <string>
+#include "numa_vector.h"
 
-template<Datatype>
 class mcmc_input {
 public:
-    numa_vector<int> intValued(string name);
-    numa_vector<Datatype> realValued(string name, mpfr_prec_t = MPFR_PREC_DEFAULT);
-    
-    int MPFR_PREC_DEFAULT = 53;
-};
 
-#endif	/* MCMCINPUT_H */
+    virtual ~mcmc_input() {};
+
+    /**
+     *
+     * @brief Number of rows of the columns.
+     *
+     */
+    virtual size_t rows() const = 0;
+
+    /**
+     *
+     * @brief  The integer entries of a column.
+     * @param  name Name of the column.
+     * @return The column, or null if there is none with that name or
+     *         an entry is not a whole number. Then @ref error tells
+     *         why.
+     *
+     */
+    virtual numa_vector<int> const *intValued(std::string const &name) = 0;
+
+    /**
+     *
+     * @brief  The real entries of a column.
+     * @param  name Name of the column.
+     * @return The column, or null if there is none with that name.
+     *         Then @ref error tells why.
+     *
+     */
+    virtual numa_vector<double> const *realValued(std::string const &name) = 0;
+
+    /**
+     *
+     * @brief Why the last access failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+protected:
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
+};
 
+#endif	/* MCMC_INPUT_H */
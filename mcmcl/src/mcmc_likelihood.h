@@ -9,12 +9,30 @@
  * 
  * This interface class is used for logs of likelihoods as well as
  * for priors, so the name maybe misleading.
+ * 
+ * Vectorized implementations of common log-densities are provided
+ * in normal_likelihood.h, student_t_likelihood.h, poisson_likelihood.h,
+ * bernoulli_logit_likelihood.h, binomial_logit_likelihood.h, 
+ * gamma_likelihood.h, beta_likelihood.h and exponential_likelihood.h.
  *  
  */
 #ifndef MCMC_LIKELIHOOD_H
 #define	MCMC_LIKELIHOOD_H
 
+#include <cmath>
 #include <vector>
+#include "argument_view.h"
+
+/**
+ * 
+ * @brief Number of sufficient statistics of a conjugate argument.
+ * 
+ * The log-density of a term as a function of a conjugate argument x
+ * is s_0 x + s_1 x^2 + s_2 log x + s_3 x^(-2) plus terms free of x, 
+ * see mcmc_likelihood::sufficientStatistics.
+ * 
+ */
+static size_t const CONJUGATE_STATS = 4;
 
 class mcmc_likelihood {
 public:
@@ -42,10 +60,166 @@ public:
      * @see argument_maker 
      * 
      */
-    virtual double compute (std::vector<std::vector<double> > args) {
+    virtual double compute (std::vector<std::vector<double> > const &args) {
     	double temp = 0;
     	return temp;
     };
+    
+    /**
+     * 
+     * @brief Computes the likelihood of the model from views.
+     * @param args Views on the arguments, in the same column order 
+     *        as in @ref compute.
+     * 
+     * This is the allocation-free entry point used by the bonds. 
+     * Views may broadcast a scalar (stride zero). The default copies 
+     * the views into a rectangular vector and calls @ref compute, 
+     * inheriting classes should override it to read the views 
+     * in place.
+     * 
+     * @see argument_view
+     * 
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        size_t n = 0;
+        for(size_t k = 0; k < args.size(); ++k) {
+            if(args[k].size() > n) {
+                n = args[k].size();
+            }
+        }
+        std::vector<std::vector<double> > temp(args.size(), std::vector<double>(n));
+        for(size_t k = 0; k < args.size(); ++k) {
+            for(size_t i = 0; i < n; ++i) {
+                temp[k][i] = args[k][i];
+            }
+        }
+        
+        return compute(temp);
+    };
+    
+    /**
+     * 
+     * @brief  Makes views on the columns of a rectangular argument.
+     * @param  args A rectangular vector of arguments.
+     * @return One unit-stride view per column.
+     * 
+     */
+    static std::vector<argument_view> views (std::vector<std::vector<double> > const &args) {
+        std::vector<argument_view> temp(args.size());
+        for(size_t k = 0; k < args.size(); ++k) {
+            temp[k] = argument_view(args[k].empty() ? 0 : &args[k][0], 1, args[k].size());
+        }
+        
+        return temp;
+    };
+    
+    /**
+     * 
+     * @brief Indicates if the likelihood is a sum of per-term
+     *        contributions.
+     * 
+     * A separable likelihood satisfies compute(args) = sum_i 
+     * computeTerm(row_i), where row_i holds the i-th entry of 
+     * each argument vector. Bonds use this to recompute only the 
+     * terms touched by a proposal.
+     * 
+     * @see computeTerm
+     * 
+     */
+    virtual bool isSeparable () const {
+        return false;
+    };
+    
+    /**
+     * 
+     * @brief Computes the contribution of a single term.
+     * @param row The i-th entry of each argument vector, in the 
+     *        same column order as in @ref compute.
+     * 
+     * Only used if @ref isSeparable returns true.
+     * 
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return 0;
+    };
+    
+    /**
+     * 
+     * @brief Indicates if @ref gradient is implemented.
+     * 
+     * Bonds of likelihoods without gradient are differentiated 
+     * numerically.
+     * 
+     */
+    virtual bool hasGradient () const {
+        return false;
+    };
+    
+    /**
+     * 
+     * @brief Computes the derivatives of each term with respect to its
+     *        arguments.
+     * @param args Views on the arguments, as in @ref evaluate.
+     * @param grad One pointer per argument to storage for one entry 
+     *        per term. Entry i receives the derivative of term i with 
+     *        respect to the i-th entry of the argument. Arguments 
+     *        with a null pointer are skipped.
+     * 
+     * Only used if @ref isSeparable and @ref hasGradient return true.
+     * The derivative with respect to a broadcast argument is written 
+     * per term as well, reducing it is left to the caller.
+     * 
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {};
+    
+    /**
+     * 
+     * @brief Indicates if @ref sufficientStatistics is implemented for
+     *        an argument.
+     * @param arg Index of the argument.
+     * 
+     * Bonds of parameters entering only conjugate arguments let the
+     * parameter draw from its full conditional, see 
+     * mcmc_parameter::update.
+     * 
+     */
+    virtual bool isConjugate (size_t arg) const {
+        return false;
+    };
+    
+    /**
+     * 
+     * @brief Computes the coefficients of the sufficient statistics of
+     *        each term in an argument.
+     * @param args Views on the arguments, as in @ref evaluate.
+     * @param arg Index of the argument.
+     * @param stats %CONJUGATE_STATS pointers to storage for one entry 
+     *        per term. Entry i of stats[j] receives the coefficient 
+     *        s_j of term i, all entries are written.
+     * 
+     * Only used if @ref isSeparable and @ref isConjugate(arg) return 
+     * true. The coefficients do not depend on the argument itself.
+     * 
+     */
+    virtual void sufficientStatistics (std::vector<argument_view> const &args, size_t arg, 
+        std::vector<double*> const &stats) {};
+    
+    /**
+     * 
+     * @brief  Computes an upper bound of @ref evaluate without 
+     *         evaluating the terms.
+     * @param  args Views on the arguments, as in @ref evaluate.
+     * @return The bound, HUGE_VAL if none is known.
+     * 
+     * Bonds use the bound to stop the evaluation of a proposal that
+     * is certainly rejected, see mcmc_bond::proposeBounded. It has to
+     * cost much less than @ref evaluate, e.g. the maximum of a bounded 
+     * density times the number of terms.
+     * 
+     */
+    virtual double upperBound (std::vector<argument_view> const &args) {
+        return HUGE_VAL;
+    };
 };
 #endif	/* MCMC_LIKELIHOOD_H */
 
@@ -0,0 +1,605 @@
+/**
+ *
+ * @file mcmc_model.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 18, 2012, 2:15 PM
+ *
+ * @brief Owns the parameters and bonds of a statistical model.
+ *
+ * The %mcmc_model holds every @ref mcmc_parameter and every
+ * @ref mcmc_bond of a model exactly once. Bonds are added together
+ * with the indices of the parameters they are computed from and
+ * reference these parameters, nothing is copied.
+ *
+ * When the model is finalized, the parameter-to-bond adjacency is
+ * stored in compressed sparse row form: one contiguous array of
+ * @ref bond_ref, sorted by parameter, and the offsets of the rows.
+ * Each parameter walks its row linearly in an update. There is no
+ * limit on the number of bonds per parameter.
+ *
+ * Example:
+ * @code
+ * mcmc_model model;
+ * size_t y = model.addParameter(data);
+ * size_t mu = model.addParameter(mean);
+ * std::vector<size_t> nodes;
+ * nodes.push_back(y);
+ * nodes.push_back(mu);
+ * model.addBond(bond, nodes);
+ * model.finalize();
+ * model.update();
+ * @endcode
+ *
+ * @see mcmc_parameter
+ * @see mcmc_bond
+ * @see thread_pool
+ *
+ */
+#ifndef MCMC_MODEL_H
+#define	MCMC_MODEL_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_update.h"
+#include "mcmc_bond.h"
+#include "mcmc_parameter.h"
+
+class mcmc_model : public mcmc_update {
+public:
+
+    /**
+     *
+     * @brief Default constructor, constructs an empty model.
+     *
+     */
+    mcmc_model() : finalized(false), key(0), chain(0), beta(1) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    virtual ~mcmc_model() {};
+
+    /**
+     *
+     * @brief  Adds a parameter to the model.
+     * @param  par The parameter. Held by pointer, such that inheriting
+     *         classes are not sliced.
+     * @return Index of the parameter in the model.
+     *
+     * Data enters the model as constant parameters. The parameter gets
+     * its random stream, see @ref seed.
+     *
+     */
+    size_t addParameter(boost::shared_ptr<mcmc_parameter> const &par) {
+        parameters.push_back(par);
+        updates.push_back(0);
+        par->seed(key, stream(parameters.size() - 1, false));
+        finalized = false;
+
+        return parameters.size() - 1;
+    }
+
+    /**
+     *
+     * @brief  Adds a copy of a parameter to the model.
+     * @param  par The parameter.
+     * @return Index of the parameter in the model.
+     *
+     */
+    size_t addParameter(mcmc_parameter const &par) {
+        return addParameter(boost::shared_ptr<mcmc_parameter>(new mcmc_parameter(par)));
+    }
+
+    /**
+     *
+     * @brief  Adds a bond to the model.
+     * @param  bond The bond.
+     * @param  nodes Indices of the parameters the bond is computed
+     *         from, in the order of the bond's arguments.
+     * @param  tempered Determines if the bond is scaled by the inverse
+     *         temperature, see @ref setInverseTemperature. Usually
+     *         false for priors.
+     * @return Index of the bond in the model.
+     *
+     * The parameters are attached to the bond, see mcmc_bond::attach.
+     *
+     */
+    size_t addBond(boost::shared_ptr<mcmc_bond> const &bond, std::vector<size_t> const &nodes, bool tempered = true) {
+        std::vector<mcmc_node const*> attached(nodes.size());
+        for(size_t k = 0; k < nodes.size(); ++k) {
+            attached[k] = parameters[nodes[k]].get();
+        }
+        bond->attach(attached);
+        bonds.push_back(bond);
+        bond_nodes.push_back(nodes);
+        bond_tempered.push_back(tempered);
+        finalized = false;
+
+        return bonds.size() - 1;
+    }
+
+    /**
+     *
+     * @brief Builds the parameter-to-bond adjacency.
+     *
+     * Counts the bonds of each parameter, sets the row offsets and
+     * fills the rows in the order the bonds were added. Every
+     * parameter is pointed to its row. Has to be called after the
+     * last parameter or bond was added.
+     *
+     */
+    void finalize() {
+        offsets.assign(parameters.size() + 1, 0);
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            for(size_t k = 0; k < bond_nodes[b].size(); ++k) {
+                ++offsets[bond_nodes[b][k] + 1];
+            }
+        }
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        adjacency.resize(offsets.back());
+        adjacency_bonds.resize(offsets.back());
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            for(size_t k = 0; k < bond_nodes[b].size(); ++k) {
+                size_t a = next[bond_nodes[b][k]]++;
+                adjacency[a] = bond_ref(bonds[b].get(), k, bond_tempered[b] ? beta : 1.0);
+                adjacency_bonds[a] = b;
+            }
+        }
+        bond_ref const *first = adjacency.empty() ? 0 : &adjacency[0];
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->setBonds(first + offsets[i], first + offsets[i + 1]);
+        }
+        finalized = true;
+    }
+
+    /**
+     *
+     * @brief Updates all parameters in the order they were added.
+     *
+     * Parameters with a replaced update, see @ref setUpdate, run that
+     * update instead. Finalizes the model first, if necessary.
+     *
+     * @see mcmc_update.
+     *
+     */
+    virtual void update() {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            update(i);
+        }
+    }
+
+    /**
+     *
+     * @brief Updates the parameter with index i.
+     *
+     * Runs the update replacing the parameter's own, if any, see
+     * @ref setUpdate. Finalizes the model first, if necessary.
+     *
+     */
+    void update(size_t i) {
+        if(!finalized) {
+            finalize();
+        }
+        if(updates[i] != 0) {
+            updates[i]->update();
+        } else {
+            parameters[i]->update();
+        }
+    }
+
+    /**
+     *
+     * @brief Writes the output of all parameters.
+     *
+     */
+    virtual void updateOutput() {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->updateOutput();
+        }
+    }
+
+    /**
+     *
+     * @brief Finishes all parameters.
+     *
+     */
+    virtual void finish() {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->finish();
+        }
+    }
+
+    /**
+     *
+     * @brief  Reports the acceptance statistics of all parameters.
+     * @return One line per parameter, see mcmc_parameter::accepted.
+     *
+     */
+    virtual std::string accepted() {
+        std::string out;
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            if(!parameters[i]->const_val) {
+                out += (updates[i] != 0 ? updates[i]->accepted() : parameters[i]->accepted()) + "\n";
+            }
+        }
+
+        return out;
+    }
+
+    /**
+     *
+     * @brief Starts the adaptation of the step sizes of all parameters.
+     * @param burnin Number of updates after which the step sizes are
+     *        frozen.
+     *
+     * @see mcmc_parameter::startAdaptation
+     *
+     */
+    void startAdaptation(size_t burnin) {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->startAdaptation(burnin);
+        }
+    }
+
+    /**
+     *
+     * @brief Replaces the update of a parameter.
+     * @param i Index of the parameter.
+     * @param upd The update, e.g. a @ref nuts_update of the parameter,
+     *        or null for mcmc_parameter::update. Not owned.
+     *
+     */
+    void setUpdate(size_t i, mcmc_update *upd) {
+        updates[i] = upd;
+        if(upd != 0) {
+            upd->seed(key, stream(i, true));
+        }
+    }
+
+    /**
+     *
+     * @brief Replaces the update of a parameter by one owned by the
+     *        model.
+     * @param i Index of the parameter.
+     * @param upd The update.
+     *
+     */
+    void setUpdate(size_t i, boost::shared_ptr<mcmc_update> const &upd) {
+        owned_updates.push_back(upd);
+        setUpdate(i, upd.get());
+    }
+
+    /**
+     *
+     * @brief Sets the random streams of all parameters and updates.
+     * @param key Seed shared by all chains of a run.
+     * @param chain Number of the chain, below 2^31.
+     *
+     * Parameter i draws from the stream chain * 2^32 + i, the update
+     * replacing it from chain * 2^32 + 2^31 + i, see
+     * mcmc_update::seed. Different chains and different parameters
+     * therefore never share random numbers. Parameters added later
+     * get their streams when added. Models start with key and chain
+     * zero.
+     *
+     */
+    void seed(uint64_t key, uint64_t chain) {
+        this->key = key;
+        this->chain = chain;
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->seed(key, stream(i, false));
+            if(updates[i] != 0) {
+                updates[i]->seed(key, stream(i, true));
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Sets the inverse temperature of the tempered bonds.
+     * @param beta The inverse temperature, one for the posterior.
+     *
+     * The logged values of the tempered bonds enter the acceptance 
+     * probabilities of all updates multiplied by %beta. Costs one pass
+     * over the adjacency.
+     *
+     * @see mcmc_tempering
+     *
+     */
+    void setInverseTemperature(double beta) {
+        this->beta = beta;
+        for(size_t a = 0; a < adjacency.size(); ++a) {
+            adjacency[a].weight = bond_tempered[adjacency_bonds[a]] ? beta : 1.0;
+        }
+    }
+
+    /**
+     *
+     * @brief The inverse temperature of the tempered bonds.
+     *
+     */
+    double inverseTemperature() const {
+        return beta;
+    }
+
+    /**
+     *
+     * @brief  Sum of the logged values of the tempered bonds at the
+     *         current state, unscaled.
+     *
+     * @see mcmc_bond::currentValue
+     *
+     */
+    double temperedValue() {
+        double sum = 0;
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            if(bond_tempered[b]) {
+                sum += bonds[b]->currentValue();
+            }
+        }
+
+        return sum;
+    }
+
+    /**
+     *
+     * @brief Exchanges the values of the parameters with a copy of
+     *        the model.
+     * @param other A model with the same parameters and bonds, e.g. a
+     *        @ref clone.
+     *
+     * Constant parameters are not exchanged. The bonds exchange their
+     * copies of the parameters and their current values with the
+     * bonds of %other, see mcmc_bond::swapState, so nothing is
+     * computed again. Only a bond that cannot exchange its state is
+     * attached again in both models, see mcmc_bond::attach. The step
+     * sizes and all other tuning stay with the models.
+     *
+     * @see mcmc_tempering
+     *
+     */
+    void swapState(mcmc_model &other) {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            if(!parameters[i]->const_val) {
+                parameters[i]->value.swap(other.parameters[i]->value);
+            }
+        }
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            if(!bonds[b]->swapState(*other.bonds[b])) {
+                reattach(b);
+                other.reattach(b);
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief  Copies the model.
+     * @return A model with copies of all parameters and bonds, owned
+     *         by the caller.
+     *
+     * The copies are attached like the originals and the copy is
+     * finalized, if the model is. Replaced updates are not copied,
+     * they refer to the parameters of this model. The copy has the
+     * key, chain number and inverse temperature of this model and no
+     * thread pool.
+     *
+     * @see mcmc_chains
+     *
+     */
+    mcmc_model *clone() const {
+        mcmc_model *copy = new mcmc_model();
+        copy->key = key;
+        copy->chain = chain;
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            copy->addParameter(boost::shared_ptr<mcmc_parameter>(parameters[i]->clone()));
+        }
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            copy->addBond(boost::shared_ptr<mcmc_bond>(bonds[b]->clone()), bond_nodes[b], bond_tempered[b]);
+        }
+        copy->beta = beta;
+        if(finalized) {
+            copy->finalize();
+        }
+
+        return copy;
+    }
+
+    /**
+     *
+     * @brief Sets the pool used in the parameter updates.
+     * @param pool The pool, or null for serial updates. Not owned.
+     *
+     * Parameters compute their bonds in parallel, bonds split large
+     * data into chunks, see mcmc_parameter::acceptanceP.
+     *
+     */
+    void setThreadPool(thread_pool *pool) {
+        for(size_t i = 0; i < parameters.size(); ++i) {
+            parameters[i]->setThreadPool(pool);
+        }
+        for(size_t b = 0; b < bonds.size(); ++b) {
+            bonds[b]->setThreadPool(pool);
+        }
+    }
+
+    /**
+     *
+     * @brief Returns the parameter with index i.
+     *
+     */
+    mcmc_parameter &parameter(size_t i) {
+        return *parameters[i];
+    }
+
+    /**
+     *
+     * @brief Returns the bond with index b.
+     *
+     */
+    mcmc_bond &bond(size_t b) {
+        return *bonds[b];
+    }
+
+    /**
+     *
+     * @brief Number of parameters.
+     *
+     */
+    size_t numParameters() const {
+        return parameters.size();
+    }
+
+    /**
+     *
+     * @brief Number of bonds.
+     *
+     */
+    size_t numBonds() const {
+        return bonds.size();
+    }
+
+    /**
+     *
+     * @brief Number of bonds of the parameter with index i.
+     *
+     */
+    size_t numBonds(size_t i) const {
+        return offsets[i + 1] - offsets[i];
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, parameters point into %adjacency. See
+     *        @ref clone.
+     *
+     */
+    mcmc_model(mcmc_model const &other);
+    mcmc_model& operator=(mcmc_model const &other);
+
+    /**
+     *
+     * @brief Attaches bond b again to its parameters.
+     *
+     */
+    void reattach(size_t const b) {
+        std::vector<mcmc_node const*> attached(bond_nodes[b].size());
+        for(size_t k = 0; k < attached.size(); ++k) {
+            attached[k] = parameters[bond_nodes[b][k]].get();
+        }
+        bonds[b]->attach(attached);
+    }
+
+    /**
+     *
+     * @brief  Number of the random stream of parameter i or of the
+     *         update replacing it.
+     *
+     */
+    uint64_t stream(size_t i, bool replaced) const {
+        return (chain << 32) + (replaced ? (static_cast<uint64_t>(1) << 31) : 0) + i;
+    }
+
+    /**
+     *
+     * @brief The parameters of the model.
+     *
+     */
+    std::vector<boost::shared_ptr<mcmc_parameter> > parameters;
+
+    /**
+     *
+     * @brief The bonds of the model.
+     *
+     */
+    std::vector<boost::shared_ptr<mcmc_bond> > bonds;
+
+    /**
+     *
+     * @brief For each parameter the update replacing its own, if any.
+     *
+     */
+    std::vector<mcmc_update*> updates;
+
+    /**
+     *
+     * @brief Updates set by the owning @ref setUpdate.
+     *
+     */
+    std::vector<boost::shared_ptr<mcmc_update> > owned_updates;
+
+    /**
+     *
+     * @brief For each bond the indices of its parameters.
+     *
+     */
+    std::vector<std::vector<size_t> > bond_nodes;
+
+    /**
+     *
+     * @brief For each bond if it is tempered.
+     *
+     */
+    std::vector<bool> bond_tempered;
+
+    /**
+     *
+     * @brief Row offsets of %adjacency, one per parameter plus one.
+     *
+     */
+    std::vector<size_t> offsets;
+
+    /**
+     *
+     * @brief The bonds of all parameters, sorted by parameter.
+     *
+     */
+    std::vector<bond_ref> adjacency;
+
+    /**
+     *
+     * @brief Index of the bond of each entry of %adjacency.
+     *
+     */
+    std::vector<size_t> adjacency_bonds;
+
+    /**
+     *
+     * @brief Determines if %adjacency is up to date.
+     *
+     */
+    bool finalized;
+
+    /**
+     *
+     * @brief Seed of the random streams.
+     *
+     */
+    uint64_t key;
+
+    /**
+     *
+     * @brief Number of the chain, selects the random streams.
+     *
+     */
+    uint64_t chain;
+
+    /**
+     *
+     * @brief Inverse temperature of the tempered bonds.
+     *
+     */
+    double beta;
+};
+
+#endif	/* MCMC_MODEL_H */
+
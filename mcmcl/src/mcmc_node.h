@@ -12,12 +12,20 @@
  * to carry data. One basic inheriting class is 
  * @ref mcmc_parameter.
  * 
+ * Bonds read the values of a node through @ref values. Constant 
+ * nodes are read in place, the others are copied once per bond, such
+ * that proposals can be written into the copy. A node referencing 
+ * external storage, e.g. a column of a @ref data_frame, overrides
+ * @ref values, see @ref mcmc_data.
+ * 
  * @see mcmc_parameter
+ * @see mcmc_data
  * 
  */
 #ifndef MCMC_NODE_H
 #define	MCMC_NODE_H
 #include <vector>
+#include "argument_view.h"
 
 class mcmc_node {
     public:
@@ -42,6 +50,30 @@ class mcmc_node {
          * 
          */
         virtual void addBond(){};
+        
+        /**
+         * 
+         * @brief  Returns a contiguous view on the values.
+         * 
+         * The default refers to %value.
+         * 
+         */
+        virtual argument_view values() const {
+            return argument_view(value.empty() ? 0 : &value[0], 1, value.size());
+        };
+        
+        /**
+         * 
+         * @brief  Indicates if the values never change while bonds
+         *         refer to them.
+         * 
+         * Bonds read constant nodes through @ref values without 
+         * copying them. The default is false.
+         * 
+         */
+        virtual bool isConstant() const {
+            return false;
+        };
          
         /**
          *
@@ -17,6 +17,25 @@
  * class, a parameter knows how to update itself. It does this by 
  * looping over its components, and for each one attempting to make
  * a Gaussian move according to a random walk Metropolis proposal.
+ * Alternatively, blocks of components are moved jointly by an adaptive
+ * multivariate Gaussian random walk, see @ref setBlocks. A block costs
+ * one computation of each bond instead of one per component.
+ * 
+ * If all bonds are conjugate in the parameter, see 
+ * mcmc_bond::isConjugate, an update instead draws all components
+ * from their full conditionals, which are Normal or Gamma 
+ * distributions of the summed sufficient statistics. This costs one
+ * pass over the terms of each bond and accepts always. Parameters 
+ * whose full conditional has no closed form, e.g. with mixed 
+ * statistics or an improper flat posterior, fall back to the random 
+ * walk for good, see @ref conjugate_draws.
+ * 
+ * Conditionally independent components, e.g. group means, can take 
+ * their random walk steps in parallel, see @ref setChromatic.
+ * 
+ * During a burn-in phase the step sizes adapt to a target acceptance
+ * rate, see @ref startAdaptation. They are frozen afterwards, such that
+ * the chain keeps the posterior as stationary distribution.
  * 
  * @see mcmc_update
  * 
@@ -25,14 +44,46 @@
 #ifndef MCMC_PARAMETER_H
 #define	MCMC_PARAMETER_H
 
-#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/gamma_distribution.hpp>
 #include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
 #include <vector>
 #include <string>
+#include <sstream>
 #include "mcmc_update.h"
 #include "mcmc_bond.h"
+#include "mcmc_likelihood.h"
 #include "mcmc_node.h"
-#include "GLOBAL_VARS.h"
+#include "thread_pool.h"
+#include "block_proposal.h"
+#include "philox_engine.h"
+#include "philox_batch.h"
+
+/**
+ * 
+ * @brief Default target acceptance rate of componentwise moves.
+ * 
+ */
+static double const MCMC_ADAPT_TARGET = 0.44;
+
+/**
+ * 
+ * @brief Exponent of the decay of the adaptation gain.
+ * 
+ */
+static double const MCMC_ADAPT_DECAY = 0.6;
+
+/**
+ * 
+ * @brief Relative step of the central differences for bonds without
+ *        derivatives.
+ * 
+ */
+static double const MCMC_GRADIENT_STEP = 1e-6;
 
 class mcmc_parameter : public mcmc_update, public mcmc_node {
 public:
@@ -48,7 +99,14 @@ public:
      * 
      */
     mcmc_parameter(std::vector<double> const &initPar, std::vector<double> const &mss,
-    std::string const &name) : value(initPar), mss(mss), name(name) {};
+    std::string const &name) : mss(mss), name(name), const_val(false), conjugate_draws(true), 
+    accs(initPar.size(), 0), props(initPar.size(), 0), proposed(initPar.size()), turn(0), 
+    first_bond(0), last_bond(0), pool(0), evals(0), conjugate_failed(false), drew_conjugate(false), 
+    chromatic(false), coloured(false), seed_key(0), seed_stream(0), sweeps(0), 
+    adapting(false), burnin(0), iteration(0), 
+    target(MCMC_ADAPT_TARGET), gen(0, 0), uni_gen(0, 1) {
+        this->value = initPar;
+    };
     
     /**
      * 
@@ -57,13 +115,24 @@ public:
      * 
      * Copies the initial parameters, step sizes and the name of
      * the output file. These are the stateless indicators of
-     * the %mcmc_parameter class interface.
+     * the %mcmc_parameter class interface. The bonds are not copied,
+     * the random streams start anew.
      *
      */
-    mcmc_parameter(mcmc_parameter const &other) {
+    mcmc_parameter(mcmc_parameter const &other) : const_val(other.const_val), 
+    conjugate_draws(other.conjugate_draws), turn(0), first_bond(0), last_bond(0), pool(0), evals(0), 
+    conjugate_failed(false), drew_conjugate(false), chromatic(other.chromatic), coloured(false), 
+    seed_key(0), seed_stream(0), sweeps(0), adapting(other.adapting), burnin(other.burnin), 
+    iteration(0), target(other.target), gen(0, 0), uni_gen(0, 1) {
         this->value = other.value;
         this->mss = other.mss;
         this->name = other.name;
+        this->accs.resize(value.size(), 0);
+        this->props.resize(value.size(), 0);
+        this->proposed.resize(value.size());
+        this->adapt_steps.resize(other.adapt_steps.size(), 0);
+        this->blocks = other.blocks;
+        this->in_block = other.in_block;
     }
     
     /**
@@ -72,6 +141,55 @@ public:
      * 
      */
     virtual ~mcmc_parameter() {};
+    
+    /**
+     * 
+     * @brief  Copies the parameter, see the copy constructor.
+     * @return The copy, owned by the caller.
+     * 
+     * Inheriting classes override the function to copy themselves.
+     * 
+     */
+    virtual mcmc_parameter *clone() const {
+        return new mcmc_parameter(*this);
+    }
+
+    /**
+     *
+     * @brief Indicates if the parameter is constant, see %const_val.
+     *
+     * Bonds read constant parameters, i.e. data, in place.
+     *
+     * Inherited from @ref mcmc_node.
+     *
+     */
+    virtual bool isConstant() const {
+        return const_val;
+    }
+
+    /**
+     * 
+     * @brief Sets the random streams of the proposals and of the 
+     *        acceptance.
+     * @param key Seed shared by all streams of a run.
+     * @param stream Number of the stream. The parameter uses the 
+     *        streams 2 * stream and 2 * stream + 1.
+     * 
+     * The proposals and thresholds of the componentwise steps are drawn
+     * a sweep at a time from the blocks above %PHILOX_SWEEP_BASE of the
+     * first stream, see @ref philox_sweep.
+     * 
+     * Inherited from @ref mcmc_update.
+     * 
+     */
+    virtual void seed(uint64_t key, uint64_t stream) {
+        gen = philox_engine(key, 2 * stream);
+        uni_gen = philox_engine(key, 2 * stream + 1);
+        dist.reset();
+        seed_key = key;
+        seed_stream = stream;
+        sweeps = 0;
+    }
     /**
      * @brief Informs about acceptance of a step in the algorithm
      * 
@@ -79,21 +197,101 @@ public:
      * mcmc procedure can be used for performance analysis in 
      * regard to convergence of the posterior distribution
      * 
-     * @return Information of acceptance.
+     * @return Information of acceptance: the name, the phase and for 
+     *         each component the acceptance rate since the last change
+     *         of the phase and the current step size.
      *  
      */
     virtual std::string accepted() {
-    	std::string out = "accepted";
-    	return out;
+        std::ostringstream out;
+        out << name << (adapting ? " (adapting)" : "") << (drew_conjugate ? " (conjugate)" : "") << ":";
+        for(size_t k = 0; k < value.size(); ++k) {
+            out << " " << acceptanceRate(k) << "/" << mss[k];
+        }
+        
+        return out.str();
     };
     
+    /**
+     * 
+     * @brief  Acceptance rate of a component.
+     * @param  k Index of the component.
+     * @return Accepted over proposed moves since the last change of the
+     *         phase, zero if nothing was proposed.
+     * 
+     */
+    double acceptanceRate(size_t k) const {
+        return props[k] > 0 ? static_cast<double>(accs[k]) / props[k] : 0.0;
+    }
+    
+    /**
+     * 
+     * @brief Starts the adaptation of the step sizes.
+     * @param burnin Number of updates after which the step sizes are
+     *        frozen.
+     * @param target Target acceptance rate of the componentwise moves.
+     * 
+     * After each componentwise move the logged step size of the 
+     * component follows a Robbins-Monro recursion,
+     * log mss += t^(-%MCMC_ADAPT_DECAY) * (min(1, a) - target), with a the 
+     * acceptance probability of the move and t the number of moves of
+     * the component. Blocks adapt their covariance meanwhile.
+     * 
+     */
+    void startAdaptation(size_t burnin, double target = MCMC_ADAPT_TARGET) {
+        this->adapting = true;
+        this->burnin = burnin;
+        this->target = target;
+        iteration = 0;
+        adapt_steps.assign(value.size(), 0);
+        resetStatistics();
+        for(size_t b = 0; b < blocks.size(); ++b) {
+            blocks[b].setAdaptive(true);
+        }
+    }
+    
+    /**
+     * 
+     * @brief Freezes the step sizes and block covariances.
+     * 
+     * Called after the burn-in by @ref update. Resets the acceptance 
+     * statistics, which afterwards describe the frozen chain.
+     * 
+     */
+    void stopAdaptation() {
+        adapting = false;
+        resetStatistics();
+        for(size_t b = 0; b < blocks.size(); ++b) {
+            blocks[b].setAdaptive(false);
+        }
+    }
+    
+    /**
+     * 
+     * @brief Determines if the step sizes are adapting.
+     * 
+     */
+    bool isAdapting() const {
+        return adapting;
+    }
+    
     /**
      * 
      * @brief Updates parameters 
      * 
      * Inherited from @ref mcmc_update interface class. Note, that
      * parameters are proposed and accepted independently from each 
-     * other in this implementation.
+     * other in this implementation. Every proposal is followed by 
+     * either @ref takeStep or @ref rejectStep, such that all bonds
+     * finish the proposal before the next one starts. If blocks are
+     * set, each block is updated jointly first and the remaining 
+     * components one by one, or colour by colour, see 
+     * @ref setChromatic. The uniform of a componentwise step is drawn
+     * before the bonds and compared in log space, such that a proposal
+     * can be rejected before all bonds are evaluated, see 
+     * @ref proposeEarly. A conjugate parameter is drawn from its
+     * full conditional instead, see @ref drawConjugate. Ends the 
+     * adaptation after the burn-in.
      *  
      * @see mcmc_update.
      * 
@@ -102,14 +300,40 @@ public:
         if(const_val) {
             return;
         }
-        while(turn < value.size()) {
+        drew_conjugate = conjugate_draws && drawConjugate();
+        for(size_t b = 0; !drew_conjugate && b < blocks.size(); ++b) {
+            updateBlock(blocks[b]);
+        }
+        if(!drew_conjugate) {
+            drawSweep();
+        }
+        bool swept = !drew_conjugate && chromatic && makeColours();
+        if(swept) {
+            rejectStep();
+            for(size_t c = 0; c < colours.size(); ++c) {
+                updateColour(colours[c]);
+            }
+        }
+        for(turn = 0; !drew_conjugate && !swept && turn < value.size(); ++turn) {
+            if(!in_block.empty() && in_block[turn]) {
+                continue;
+            }
             candidate = proposal()[0];
             proposed[turn] = candidate;
-            double ap = acceptanceP();
-            if(ap > uni_dist(uni_gen)) {
-                //takeStep();
+            double logu = std::log(sweep_uniforms[turn]);
+            double lr = proposeEarly(logu);
+            ++props[turn];
+            if(lr > logu) {
+                takeStep();
+            } else {
+                rejectStep();
+            }
+            if(adapting) {
+                adaptStep(turn, std::exp(lr));
             }
-            ++turn;
+        }
+        if(adapting && ++iteration >= burnin) {
+            stopAdaptation();
         }
     }
     
@@ -126,7 +350,7 @@ public:
      * @return A proposal for new parameter value(s).
      */
     virtual std::vector<double> proposal() {
-        double res = value[turn] +  dist(gen) * mss[turn];
+        double res = value[turn] + sweep_normals[turn] * mss[turn];
         std::vector<double> temp(1, res);
         
         return temp;
@@ -143,25 +367,40 @@ public:
      * The @ref mcmc_bond gets the index of %this - the %mcmc_parameter that 
      * handles over the new proposal @ref candidate and which of the 
      * parameters in %mcmc_parameter::value is in turn. 
+     * The bonds may be computed in parallel, see @ref proposeBonds.
      * 
      * @return Acceptance probability.
      * 
      */
     virtual double acceptanceP() {
-        double lr = 0;
-        for (size_t i = 0; i < bonds.size(); ++i) {
-            lr += bonds[i].compute(whatami[i], candidate, turn);
-        }
-        
-        return exp(lr);
+        return std::exp(proposeBonds([this](bond_ref const &b) {
+            return b.bond->propose(b.whatami, candidate, turn);
+        }));
     } 
     
+    /**
+     * 
+     * @brief  Computes the acceptance probability for a proposal of a
+     *         block.
+     * @param  block The block.
+     * @param  cand The candidates, one per coordinate of the block.
+     * @return Acceptance probability.
+     * 
+     * @see acceptanceP
+     * 
+     */
+    virtual double blockAcceptanceP(block_proposal const &block, std::vector<double> const &cand) {
+        return std::exp(proposeBonds([this, &block, &cand](bond_ref const &b) {
+            return b.bond->proposeBlock(b.whatami, block.coordinates(), cand);
+        }));
+    }
+    
     /**
      * 
      * @brief Changes all necessary variables after acceptance.
      * 
      * After a newly proposed parameter has been accepted the bonds
-     * current value must be revised and the new parameter value has 
+     * must accept the proposal and the new parameter value has 
      * to be stored in its appropriate container %value. Furthermore,
      * the counter for acceptance is incremented by one for the 
      * parameter at hand. 
@@ -169,181 +408,1199 @@ public:
      */
     void takeStep() {
         value[turn] = candidate;
-        for(size_t i = 0; i < bonds.size(); ++i) {
-             bonds[turn].revise();    
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+             b->bond->accept();    
         }
         ++accs[turn];
     }
     
     /**
      * 
-     * @brief Adds a bond to the bond container.
-     * @param bond An object inheriting from the 
-     *        @ref mcmc_bond interface class.
-     * @param which Identifies the corresponding parameter
-     *        for which the bond should be relevant.
+     * @brief Proposes and accepts or rejects a block jointly.
+     * @param block The block.
      * 
-     * All bonds are stored to the @ref bonds vector. 
+     * The proposal adapts to the chain afterwards.
      * 
      */
-    virtual void addBond(mcmc_bond const &bond, int const &which) {
-        if(numbonds < GLOBAL_VARS_H::MCMC_MAX_BONDS) {
-            bonds.push_back(bond);
-            ++numbonds;
+    void updateBlock(block_proposal &block) {
+        block_z.resize(block.size());
+        for(size_t k = 0; k < block.size(); ++k) {
+            block_z[k] = dist(gen);
         }
-    } 
+        block.draw(value, block_z, block_cand);
+        double ap = blockAcceptanceP(block, block_cand);
+        if(ap > uni_dist(uni_gen)) {
+            std::vector<size_t> const &coords = block.coordinates();
+            for(size_t k = 0; k < coords.size(); ++k) {
+                ++props[coords[k]];
+                value[coords[k]] = block_cand[k];
+                proposed[coords[k]] = block_cand[k];
+                ++accs[coords[k]];
+            }
+            for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+                b->bond->accept();
+            }
+        } else {
+            std::vector<size_t> const &coords = block.coordinates();
+            for(size_t k = 0; k < coords.size(); ++k) {
+                ++props[coords[k]];
+            }
+            rejectStep();
+        }
+        block.adapt(value);
+    }
     
     /**
      * 
-     * @brief Cleans up and closes file streams. 
+     * @brief Rolls all bonds back after rejection.
+     * 
+     * The parameter value has not been changed by the proposal, the 
+     * bonds discard their undo records.
      * 
      */
-    virtual void finish() {};
+    void rejectStep() {
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+             b->bond->reject();    
+        }
+    }
     
     /**
-     * @brief Stores parameter values. 
+     * 
+     * @brief  Proposes a state for all components jointly.
+     * @param  q The proposed state, one entry per component.
+     * @param  grad Receives the derivatives of the logged posterior
+     *         with respect to the components at %q.
+     * @return The logged posterior at %q minus the one at %value.
+     * 
+     * Used by gradient-based updates, see @ref nuts_update. Bonds that
+     * do not compute their derivatives are differentiated by central
+     * differences, 2 d + 2 proposals to the bond for d components 
+     * instead of one, see @ref numericGradients. The proposal has to be finished by 
+     * @ref acceptState or @ref rejectStep. An invalid state, e.g. 
+     * outside the support, returns minus infinity.
      * 
      */
-    std::vector<double> value;
+    double proposeState(std::vector<double> const &q, std::vector<double> &grad) {
+        all_coords.resize(value.size());
+        for(size_t k = 0; k < value.size(); ++k) {
+            all_coords[k] = k;
+        }
+        bond_grads.resize(last_bond - first_bond);
+        bond_numeric.resize(last_bond - first_bond);
+        double lr = proposeBonds([this, &q](bond_ref const &b) {
+            std::vector<double> &g = bond_grads[&b - first_bond];
+            g.assign(q.size(), 0.0);
+            
+            return proposeWithGradient(b, q, g, bond_numeric[&b - first_bond]);
+        });
+        grad.assign(q.size(), 0.0);
+        for(size_t i = 0; i < bond_grads.size(); ++i) {
+            for(size_t k = 0; k < q.size(); ++k) {
+                grad[k] += first_bond[i].weight * bond_grads[i][k];
+            }
+        }
+        
+        return std::isnan(lr) ? -HUGE_VAL : lr;
+    }
     
     /**
      * 
-     * @brief Step sizes for the parameters.
+     * @brief Moves all components to a state and accepts it in all
+     *        bonds.
+     * @param q The new state, one entry per component.
      * 
-     * Stores the provided step sizes of the 
-     * parameters. Step sizes take corresponding data 
-     * types as their parameters.
+     * Counts one accepted move of each component.
      * 
      */
-    std::vector<double> mss;
+    void acceptState(std::vector<double> const &q) {
+        all_coords.resize(value.size());
+        for(size_t k = 0; k < value.size(); ++k) {
+            all_coords[k] = k;
+        }
+        proposeBonds([this, &q](bond_ref const &b) {
+            return b.bond->proposeBlock(b.whatami, all_coords, q);
+        });
+        value = q;
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+            b->bond->accept();
+        }
+        for(size_t k = 0; k < value.size(); ++k) {
+            ++props[k];
+            ++accs[k];
+        }
+    }
     
     /**
-     *
-     * @brief Filename into which the updated parameters
-     *        should be stored.
      * 
-     * If given, the updated parameters are stored via 
-     * the inherited function @output() into a file called
-     * <name>.out.
+     * @brief  Proposes candidates for some components jointly.
+     * @param  which The components.
+     * @param  cand The candidates, one per component.
+     * @return The logged posterior at the candidates minus the one at
+     *         %value, minus infinity for an invalid state.
+     * 
+     * Used by updates other than the random walk, see 
+     * @ref slice_update. The proposal has to be finished by 
+     * @ref acceptCoordinates or @ref rejectStep.
+     * 
      */
-    std::string name;
+    double proposeCoordinates(std::vector<size_t> const &which, std::vector<double> const &cand) {
+        double lr = proposeBonds([&which, &cand](bond_ref const &b) {
+            return b.bond->proposeBlock(b.whatami, which, cand);
+        });
+        
+        return std::isnan(lr) ? -HUGE_VAL : lr;
+    }
     
     /**
      * 
-     * @brief Container for all bonds needed for the parameter update.
+     * @brief Accepts the last proposal of @ref proposeCoordinates.
+     * @param which The components of the proposal.
+     * @param cand The candidates of the proposal.
+     * 
+     * Counts one accepted move of each component.
      * 
      */
-    std::vector<mcmc_bond> bonds; 
+    void acceptCoordinates(std::vector<size_t> const &which, std::vector<double> const &cand) {
+        for(size_t k = 0; k < which.size(); ++k) {
+            value[which[k]] = cand[k];
+            ++props[which[k]];
+            ++accs[which[k]];
+        }
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+            b->bond->accept();
+        }
+    }
     
     /**
-     *
-     * @brief Defining constant parameter.
      * 
-     * Note: constant parameters are not being
-     * updated. 
+     * @brief Number of bonds of the parameter.
      * 
      */
-    bool const_val;
+    size_t numBonds() const {
+        return last_bond - first_bond;
+    }
     
     /**
-     *
-     * @brief Stores the number of acceptances for a certain
-     *        parameter.
      * 
-     * The number of acceptances for a parameter is important
-     * for tuning an MCMC algorithm. 
+     * @brief Number of bond evaluations, i.e. proposals to a bond, 
+     *        since the construction.
+     * 
+     * Counts the proposals of all updates of the parameter, the cost
+     * of an update in likelihood computations. Central differences in
+     * @ref proposeState are not counted.
      * 
      */
-    std::vector<int> accs;
+    size_t evaluations() const {
+        return evals;
+    }
     
-private:
+    /**
+     * 
+     * @brief Number of bonds differentiated by central differences in
+     *        the last @ref proposeState.
+     * 
+     * These bonds do not compute their derivatives, e.g. a likelihood
+     * or an %argument_maker without @c hasGradient, and cost 2 d + 2 
+     * proposals per state for d components. Reported by 
+     * nuts_update::accepted.
+     * 
+     */
+    size_t numericGradients() const {
+        return std::count(bond_numeric.begin(), bond_numeric.end(), 1);
+    }
     
     /**
      * 
-     * @brief Temporary variable used in @link candidate().
+     * @brief Counts one rejected move of each component.
+     * 
+     * Called by gradient-based updates that keep the state.
      * 
-     * To ensure performance the temporary variable should
-     * not be constructed in each step and sub-step of the 
-     * algorithm.
-     *  
      */
-    double candidate;  
+    void rejectState() {
+        rejectStep();
+        for(size_t k = 0; k < value.size(); ++k) {
+            ++props[k];
+        }
+    }
     
     /**
      * 
-     * @brief Container to store all temporary proposed values.
+     * @brief Adds a bond to the bond container.
+     * @param bond An object inheriting from the 
+     *        @ref mcmc_bond interface class.
+     * @param which Identifies the corresponding parameter
+     *        for which the bond should be relevant.
      * 
-     * To ensure performance the temporary variable should
-     * not be constructed in each step and sub-step of the 
-     * algorithm.
+     * All bonds are stored to the @ref bonds vector. The bond is
+     * referenced, not copied, so it has to outlive the parameter.
+     * Parameters owned by an @ref mcmc_model get their bonds from the 
+     * model instead.
      * 
      */
-    std::vector<double> proposed;
+    virtual void addBond(mcmc_bond &bond, int const &which) {
+        bonds.push_back(bond_ref(&bond, which));
+        setBonds(&bonds[0], &bonds[0] + bonds.size());
+    } 
     
     /**
-     *
-     * @brief Variable identifying which parameter is at turn
-     *        to be updated.
+     * 
+     * @brief Sets the bonds walked in an update.
+     * @param first First entry of a contiguous list of bonds.
+     * @param last One past the last entry.
+     * 
+     * The list is owned by the caller, usually the adjacency of an
+     * @ref mcmc_model.
      * 
      */
-    size_t turn;
+    void setBonds(bond_ref const *first, bond_ref const *last) {
+        first_bond = first;
+        last_bond = last;
+        coloured = false;
+        bond_order.clear();
+    }
     
     /**
      * 
-     * @brief Holds the number of bonds in the parameters update.
+     * @brief Sets the pool used to compute the bonds in parallel.
+     * @param pool The pool, or null for serial computation. Not owned.
      * 
      */
-    int numbonds;
+    void setThreadPool(thread_pool *pool) {
+        this->pool = pool;
+    }
     
     /**
-     *
-     * @brief Random number generator for the parameter proposal.
      * 
-     * It is used a Mersenne-Twister algorithm from the boost random
-     * library.
+     * @brief Sets blocks of components that are updated jointly.
+     * @param blocks For each block the indices of its components. 
+     *        Components in no block are updated one by one, an empty
+     *        list switches back to componentwise updates.
      * 
      */
-    boost::random::mt19937 gen;
+    void setBlocks(std::vector<std::vector<size_t> > const &blocks) {
+        this->blocks.clear();
+        in_block.assign(value.size(), false);
+        for(size_t b = 0; b < blocks.size(); ++b) {
+            this->blocks.push_back(block_proposal(blocks[b], mss));
+            for(size_t k = 0; k < blocks[b].size(); ++k) {
+                in_block[blocks[b][k]] = true;
+            }
+        }
+    }
     
     /**
-     *
-     * @brief Random number generator for the parameter acceptance.
      * 
-     * It is used a Mersenne-Twister algorithm from the boost random
-     * library.
+     * @brief Updates all components as one block.
      * 
      */
-    boost::random::mt19937 uni_gen;
+    void setBlock() {
+        std::vector<std::vector<size_t> > all(1);
+        for(size_t k = 0; k < value.size(); ++k) {
+            all[0].push_back(k);
+        }
+        setBlocks(all);
+    }
     
     /**
-     *
-     * @brief Gaussian distribution object for the parameter proposal.
      * 
-     * The Gaussian distribution is from the boost random library.
+     * @brief Updates conditionally independent components in parallel.
+     * @param on Switches the chromatic update on or off.
+     * 
+     * At the first update the components are coloured greedily, such 
+     * that no term of any bond depends on two components of the same
+     * colour, see mcmc_bond::dependentTerms. The colours are updated 
+     * in turn and the components of a colour concurrently, in chunks 
+     * of %CHROMATIC_CHUNK components on the @ref thread_pool, each with
+     * a random walk step as in @ref update. Since the components of a
+     * colour are independent given the others, this is a systematic
+     * scan in another order and keeps the posterior.
+     * 
+     * The draws of component k in the t-th sweep are addressed by t and
+     * k, see @ref drawSweep, and the chain is the same for any number
+     * of threads. If a bond does not know its 
+     * dependent terms or a term depends on more than 
+     * %CHROMATIC_MAX_CLIQUE components, the components are updated 
+     * one by one.
      * 
      */
-    boost::random::normal_distribution<double> dist;
+    void setChromatic(bool on = true) {
+        chromatic = on;
+        coloured = false;
+    }
     
     /**
-     *
-     * @brief Gaussian distribution object for the parameter acceptance.
      * 
-     * The uniform distribution is from the boost random library.
+     * @brief  Number of colours of the chromatic update, zero if it is
+     *         off or not possible.
      * 
      */
-    boost::random::uniform_01<double> uni_dist;
+    size_t numColours() {
+        return chromatic && makeColours() ? colours.size() : 0;
+    }
+    
+    /**
+     * 
+     * @brief Number of components updated by one task of the chromatic
+     *        update.
+     * 
+     */
+    static size_t const CHROMATIC_CHUNK = 256;
+    
+    /**
+     * 
+     * @brief Largest number of components a term may depend on in the
+     *        chromatic update.
+     * 
+     */
+    static size_t const CHROMATIC_MAX_CLIQUE = 64;
+    
+    /**
+     * 
+     * @brief Number of components drawn by one task of @ref drawSweep.
+     * 
+     */
+    static size_t const SWEEP_CHUNK = 4096;
+    
+    /**
+     * 
+     * @brief Smallest number of bonds computed in parallel.
+     * 
+     */
+    static size_t const PARALLEL_MIN_BONDS = 4;
+    
+    /**
+     * 
+     * @brief Cleans up and closes file streams. 
+     * 
+     */
+    virtual void finish() {};
+    
+    /**
+     * 
+     * @brief Step sizes for the parameters.
+     * 
+     * Stores the provided step sizes of the 
+     * parameters. Step sizes take corresponding data 
+     * types as their parameters.
+     * 
+     */
+    std::vector<double> mss;
     
     /**
      *
-     * @brief States for each bond its corresponding parameter. 
+     * @brief Filename into which the updated parameters
+     *        should be stored.
+     * 
+     * If given, the updated parameters are stored via 
+     * the inherited function @output() into a file called
+     * <name>.out.
+     */
+    std::string name;
+    
+    /**
+     * 
+     * @brief Container for the bonds added by @ref addBond.
      * 
-     * When a new @ref mcmc_bond is added to the bond vector %bonds, the 
-     * %whatami vector holds the corresponding parameter for which this bond
-     * is relevant.  
+     * Bonds are held by pointer, such that the overridden methods of
+     * inheriting classes are called. Each entry also holds the index
+     * of the parameter in the bond.
      * 
-     * @see mcmc_bond 
      */
-    std::vector<int> whatami;
+    std::vector<bond_ref> bonds; 
+    
+    /**
+     *
+     * @brief Defining constant parameter.
+     * 
+     * Note: constant parameters are not being
+     * updated. 
+     * 
+     */
+    bool const_val;
+    
+    /**
+     * 
+     * @brief Determines if a conjugate parameter is drawn from its full
+     *        conditional.
+     * 
+     * True by default. If false, the parameter always takes random 
+     * walk steps, e.g. to compare both.
+     * 
+     */
+    bool conjugate_draws;
+    
+    /**
+     *
+     * @brief Stores the number of acceptances for a certain
+     *        parameter.
+     * 
+     * The number of acceptances for a parameter is important
+     * for tuning an MCMC algorithm. 
+     * 
+     */
+    std::vector<int> accs;
+    
+    /**
+     *
+     * @brief Stores the number of proposals for each component, the
+     *        denominator of the acceptance rate.
+     * 
+     */
+    std::vector<int> props;
+    
+private:
+    
+    /**
+     * 
+     * @brief Moves the logged step size of a component towards the 
+     *        target acceptance rate.
+     * @param k Index of the component.
+     * @param ap Acceptance probability of the last move.
+     * 
+     */
+    void adaptStep(size_t k, double ap) {
+        double alpha = ap >= 1 ? 1.0 : (ap >= 0 ? ap : 0.0);
+        double gain = std::pow(static_cast<double>(++adapt_steps[k]), -MCMC_ADAPT_DECAY);
+        mss[k] *= std::exp(gain * (alpha - target));
+    }
+    
+    /**
+     * 
+     * @brief  Colours the components for the chromatic update, once 
+     *         after the bonds are set.
+     * @return True, if the colouring is possible.
+     * 
+     * Components with a common term in a bond are adjacent. Each 
+     * component, in index order, gets the smallest colour none of its
+     * neighbours has. Components in blocks are not coloured.
+     * 
+     */
+    bool makeColours() {
+        if(coloured) {
+            return !colours.empty();
+        }
+        coloured = true;
+        colours.clear();
+        std::vector<std::vector<size_t> > adjacent(value.size());
+        std::vector<std::pair<size_t, size_t> > owners;
+        std::vector<size_t> terms;
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+            owners.clear();
+            for(size_t k = 0; k < value.size(); ++k) {
+                if(!in_block.empty() && in_block[k]) {
+                    continue;
+                }
+                terms.clear();
+                if(!b->bond->dependentTerms(b->whatami, k, terms)) {
+                    return false;
+                }
+                for(size_t t = 0; t < terms.size(); ++t) {
+                    owners.push_back(std::make_pair(terms[t], k));
+                }
+            }
+            std::sort(owners.begin(), owners.end());
+            for(size_t first = 0, last = 0; first < owners.size(); first = last) {
+                while(last < owners.size() && owners[last].first == owners[first].first) {
+                    ++last;
+                }
+                if(last - first > CHROMATIC_MAX_CLIQUE) {
+                    return false;
+                }
+                for(size_t i = first; i < last; ++i) {
+                    for(size_t j = first; j < last; ++j) {
+                        if(owners[i].second != owners[j].second) {
+                            adjacent[owners[i].second].push_back(owners[j].second);
+                        }
+                    }
+                }
+            }
+        }
+        std::vector<size_t> colour(value.size(), 0);
+        std::vector<size_t> used;
+        for(size_t k = 0; k < value.size(); ++k) {
+            if(!in_block.empty() && in_block[k]) {
+                continue;
+            }
+            used.clear();
+            for(size_t j = 0; j < adjacent[k].size(); ++j) {
+                if(adjacent[k][j] < k) {
+                    used.push_back(colour[adjacent[k][j]]);
+                }
+            }
+            std::sort(used.begin(), used.end());
+            size_t c = 0;
+            for(size_t j = 0; j < used.size() && used[j] <= c; ++j) {
+                if(used[j] == c) {
+                    ++c;
+                }
+            }
+            colour[k] = c;
+            if(colours.size() <= c) {
+                colours.resize(c + 1);
+            }
+            colours[c].push_back(k);
+        }
+        
+        return true;
+    }
+    
+    /**
+     * 
+     * @brief Draws the proposal noise and the acceptance thresholds of
+     *        all components for the next sweep.
+     * 
+     * Component k in the t-th sweep since the last @ref seed gets a 
+     * standard normal and a uniform from its own counter of the 
+     * proposal stream, see @ref philox_sweep. The draws are vectorized
+     * and, for many components, computed in chunks of %SWEEP_CHUNK on
+     * the @ref thread_pool, with the same result.
+     * 
+     */
+    void drawSweep() {
+        size_t d = value.size();
+        sweep_normals.resize(d);
+        sweep_uniforms.resize(d);
+        size_t nchunks = (d + SWEEP_CHUNK - 1) / SWEEP_CHUNK;
+        std::function<void(size_t)> chunk = [this, d](size_t c) {
+            size_t first = c * SWEEP_CHUNK;
+            philox_sweep(seed_key, 2 * seed_stream, sweeps, first, std::min(d, first + SWEEP_CHUNK) - first,
+                &sweep_normals[first], &sweep_uniforms[first]);
+        };
+        if(pool != 0 && nchunks > 1) {
+            pool->run(nchunks, chunk);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                chunk(c);
+            }
+        }
+        ++sweeps;
+    }
+    
+    /**
+     * 
+     * @brief Takes a random walk step in each component of a colour.
+     * @param coords The components of the colour, in index order.
+     * 
+     * Each bond sums the changes of the accepted components per chunk
+     * and takes their sum, in chunk order, through mcmc_bond::moveTo.
+     * 
+     */
+    void updateColour(std::vector<size_t> const &coords) {
+        size_t nbonds = last_bond - first_bond;
+        size_t nchunks = (coords.size() + CHROMATIC_CHUNK - 1) / CHROMATIC_CHUNK;
+        colour_changes.resize(nbonds);
+        for(size_t i = 0; i < nbonds; ++i) {
+            colour_changes[i].assign(nchunks, 0.0);
+        }
+        evals += nbonds * coords.size();
+        std::function<void(size_t)> chunk = [this, &coords, nbonds](size_t c) {
+            static thread_local std::vector<double> diffs;
+            diffs.resize(nbonds);
+            size_t end = std::min(coords.size(), (c + 1) * CHROMATIC_CHUNK);
+            for(size_t i = c * CHROMATIC_CHUNK; i < end; ++i) {
+                size_t k = coords[i];
+                double cand = value[k] + sweep_normals[k] * mss[k];
+                double lr = 0;
+                for(size_t b = 0; b < nbonds; ++b) {
+                    diffs[b] = first_bond[b].bond->proposeCoordinate(first_bond[b].whatami, k, cand);
+                    lr += first_bond[b].weight * diffs[b];
+                }
+                double ap = std::exp(lr);
+                ++props[k];
+                if(lr > std::log(sweep_uniforms[k])) {
+                    value[k] = cand;
+                    ++accs[k];
+                    for(size_t b = 0; b < nbonds; ++b) {
+                        colour_changes[b][c] += diffs[b];
+                    }
+                }
+                if(adapting) {
+                    adaptStep(k, ap);
+                }
+            }
+        };
+        if(pool != 0) {
+            pool->run(nchunks, chunk);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                chunk(c);
+            }
+        }
+        for(size_t b = 0; b < nbonds; ++b) {
+            double change = 0;
+            for(size_t c = 0; c < nchunks; ++c) {
+                change += colour_changes[b][c];
+            }
+            first_bond[b].bond->moveTo(first_bond[b].whatami, value, change);
+        }
+    }
+    
+    /**
+     * 
+     * @brief Resets the acceptance statistics.
+     * 
+     */
+    void resetStatistics() {
+        accs.assign(value.size(), 0);
+        props.assign(value.size(), 0);
+    }
+    
+    /**
+     * 
+     * @brief  Proposes to all bonds and sums their differences.
+     * @param  propose Function proposing to one bond, returns its 
+     *         difference.
+     * @return The logged difference of all bonds.
+     * 
+     * If a @ref thread_pool is set and the parameter has at least 
+     * %PARALLEL_MIN_BONDS bonds, the bonds are computed in parallel.
+     * Their differences are weighted, see bond_ref, and summed in the
+     * order of the bonds in either case, so the result does not depend
+     * on the number of threads.
+     * 
+     */
+    template<class Propose>
+    double proposeBonds(Propose const &propose) {
+        double lr = 0;
+        size_t nbonds = last_bond - first_bond;
+        evals += nbonds;
+        if(pool != 0 && nbonds >= PARALLEL_MIN_BONDS) {
+            partials.resize(nbonds);
+            pool->run(nbonds, [this, &propose](size_t i) {
+                partials[i] = first_bond[i].weight * propose(first_bond[i]);
+            });
+            for(size_t i = 0; i < nbonds; ++i) {
+                lr += partials[i];
+            }
+        } else {
+            for (bond_ref const *b = first_bond; b != last_bond; ++b) {
+                lr += b->weight * propose(*b);
+            }
+        }
+        
+        return lr;
+    }
+    
+    /**
+     * 
+     * @brief  Proposes %candidate for the component in turn and stops
+     *         as soon as the proposal is certainly rejected.
+     * @param  logu Logged uniform threshold, drawn before the bonds.
+     * @return The logged difference of all bonds or, if the proposal 
+     *         is rejected early, an upper bound of it below %logu.
+     * 
+     * The bonds are proposed to with the fewest terms first, see 
+     * mcmc_bond::numTerms. Each one gets the difference it has to 
+     * reach for acceptance as floor, given the bonds before it and the
+     * bounds of the bonds after it, see mcmc_bond::changeBound, and may
+     * stop below it, see mcmc_bond::proposeBounded, e.g. after a part 
+     * of its data. Once the difference so far plus the bounds of the 
+     * rest is below %logu, the remaining bonds are not proposed to. A 
+     * bond without a bound leaves the bonds before it without floor.
+     * The early rejection keeps the chain, the accepted proposals are 
+     * those of @ref acceptanceP. If the bonds are computed in parallel,
+     * see @ref proposeBonds, all of them are evaluated. While adapting
+     * no bond stops early, the step sizes adapt to the full
+     * difference, see @ref adaptStep.
+     * 
+     */
+    double proposeEarly(double logu) {
+        size_t nbonds = last_bond - first_bond;
+        if(pool != 0 && nbonds >= PARALLEL_MIN_BONDS) {
+            return proposeBonds([this](bond_ref const &b) {
+                return b.bond->propose(b.whatami, candidate, turn);
+            });
+        }
+        if(bond_order.size() != nbonds) {
+            bond_order.resize(nbonds);
+            bond_terms.resize(nbonds);
+            for(size_t i = 0; i < nbonds; ++i) {
+                bond_order[i] = i;
+                bond_terms[i] = first_bond[i].bond->numTerms();
+            }
+            std::stable_sort(bond_order.begin(), bond_order.end(), [this](size_t a, size_t b) {
+                return bond_terms[a] < bond_terms[b];
+            });
+        }
+        evals += nbonds;
+        bond_rest.assign(nbonds, HUGE_VAL);
+        if(nbonds > 0 && !adapting) {
+            bond_rest[nbonds - 1] = 0;
+        }
+        for(size_t j = nbonds; j > 1 && bond_rest[j - 1] < HUGE_VAL; --j) {
+            bond_ref const &b = first_bond[bond_order[j - 1]];
+            double bound = b.weight > 0 ? b.weight * b.bond->changeBound(b.whatami, candidate, turn) : 0.0;
+            bond_rest[j - 2] = bound < HUGE_VAL ? bond_rest[j - 1] + bound : HUGE_VAL;
+        }
+        double lr = 0;
+        for(size_t j = 0; j < nbonds; ++j) {
+            bond_ref const &b = first_bond[bond_order[j]];
+            bool bounded = bond_rest[j] < HUGE_VAL && b.weight > 0;
+            double floor = bounded ? (logu - lr - bond_rest[j]) / b.weight : -HUGE_VAL;
+            lr += b.weight * b.bond->proposeBounded(b.whatami, candidate, turn, floor);
+            if(bounded && lr + bond_rest[j] < logu) {
+                return lr + bond_rest[j];
+            }
+        }
+        
+        return lr;
+    }
+    
+    /**
+     * 
+     * @brief  Draws all components from their full conditionals.
+     * @return True, if the parameter has been drawn. False, if a bond 
+     *         is not conjugate or a full conditional has no closed 
+     *         form, then nothing has changed.
+     * 
+     * The bonds add their sufficient statistics, in parallel like in
+     * @ref proposeBonds, and the weighted sums determine for each 
+     * component x the logged full conditional 
+     * s_0 x + s_1 x^2 + s_2 log x + s_3 x^(-2). It is Normal if only 
+     * s_0 and s_1 < 0 are used, Gamma if only s_0 < 0 and s_2 > -1 
+     * are used, and x^(-2) is Gamma if only s_2 < -1 and s_3 < 0 are 
+     * used, as for a standard deviation. Each bond takes the change 
+     * of its value from its own statistics, see mcmc_bond::moveTo.
+     * 
+     */
+    bool drawConjugate() {
+        size_t nbonds = last_bond - first_bond;
+        if(conjugate_failed || nbonds == 0) {
+            return false;
+        }
+        for(bond_ref const *b = first_bond; b != last_bond; ++b) {
+            if(!b->bond->isConjugate(b->whatami)) {
+                conjugate_failed = true;
+                return false;
+            }
+        }
+        bond_stats.resize(nbonds);
+        for(size_t i = 0; i < nbonds; ++i) {
+            bond_stats[i].resize(CONJUGATE_STATS);
+            for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+                bond_stats[i][j].assign(value.size(), 0.0);
+            }
+        }
+        evals += nbonds;
+        if(pool != 0 && nbonds >= PARALLEL_MIN_BONDS) {
+            pool->run(nbonds, [this](size_t i) {
+                first_bond[i].bond->addStatistics(first_bond[i].whatami, bond_stats[i]);
+            });
+        } else {
+            for(size_t i = 0; i < nbonds; ++i) {
+                first_bond[i].bond->addStatistics(first_bond[i].whatami, bond_stats[i]);
+            }
+        }
+        total_stats.assign(CONJUGATE_STATS, std::vector<double>(value.size(), 0.0));
+        for(size_t i = 0; i < nbonds; ++i) {
+            for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+                for(size_t k = 0; k < value.size(); ++k) {
+                    total_stats[j][k] += first_bond[i].weight * bond_stats[i][j][k];
+                }
+            }
+        }
+        drawn.resize(value.size());
+        for(size_t k = 0; k < value.size(); ++k) {
+            drawn[k] = drawFullConditional(k);
+            if(std::isnan(drawn[k])) {
+                conjugate_failed = true;
+                return false;
+            }
+        }
+        for(size_t i = 0; i < nbonds; ++i) {
+            double change = 0;
+            for(size_t j = 0; j < CONJUGATE_STATS; ++j) {
+                for(size_t k = 0; k < value.size(); ++k) {
+                    if(bond_stats[i][j][k] != 0) {
+                        change += bond_stats[i][j][k] * (statistic(j, drawn[k]) - statistic(j, value[k]));
+                    }
+                }
+            }
+            first_bond[i].bond->moveTo(first_bond[i].whatami, drawn, change);
+        }
+        value = drawn;
+        for(size_t k = 0; k < value.size(); ++k) {
+            ++props[k];
+            ++accs[k];
+        }
+        
+        return true;
+    }
+    
+    /**
+     * 
+     * @brief  Draws a component from its full conditional.
+     * @param  k Index of the component.
+     * @return The draw, or NaN if the statistics in %total_stats 
+     *         determine no proper Normal or Gamma distribution.
+     * 
+     */
+    double drawFullConditional(size_t k) {
+        double s0 = total_stats[0][k];
+        double s1 = total_stats[1][k];
+        double s2 = total_stats[2][k];
+        double s3 = total_stats[3][k];
+        if(s2 == 0 && s3 == 0 && s1 < 0) {
+            double prec = -2 * s1;
+            
+            return s0 / prec + dist(gen) / std::sqrt(prec);
+        }
+        if(s1 == 0 && s3 == 0 && s0 < 0 && s2 > -1) {
+            return boost::random::gamma_distribution<double>(s2 + 1, -1 / s0)(gen);
+        }
+        if(s0 == 0 && s1 == 0 && s3 < 0 && s2 < -1) {
+            return 1 / std::sqrt(boost::random::gamma_distribution<double>(-0.5 * (s2 + 1), -1 / s3)(gen));
+        }
+        
+        return NAN;
+    }
+    
+    /**
+     * 
+     * @brief  Evaluates a sufficient statistic: x, x^2, log x or 
+     *         x^(-2) for j = 0, ..., 3.
+     * 
+     */
+    static double statistic(size_t j, double x) {
+        switch(j) {
+            case 0: return x;
+            case 1: return x * x;
+            case 2: return std::log(x);
+            default: return 1 / (x * x);
+        }
+    }
+    
+    /**
+     * 
+     * @brief  Proposes a state to a single bond and adds its 
+     *         derivatives.
+     * @param  b The bond.
+     * @param  q The proposed state.
+     * @param  g The derivatives are added, one entry per component.
+     * @param  numeric Set, if the derivatives are central differences.
+     * @return The logged difference of the bond.
+     * 
+     * If the bond does not compute its derivatives, they are central
+     * differences with a step relative to the coordinate, and %q is 
+     * proposed again afterwards: 2 d + 2 proposals, each as costly as
+     * the first one, for d components.
+     * 
+     */
+    double proposeWithGradient(bond_ref const &b, std::vector<double> const &q, std::vector<double> &g,
+        char &numeric) const {
+        double lr = b.bond->proposeBlock(b.whatami, all_coords, q);
+        numeric = !b.bond->gradient(b.whatami, g);
+        if(!numeric) {
+            return lr;
+        }
+        std::vector<double> x(q);
+        for(size_t k = 0; k < q.size(); ++k) {
+            double h = MCMC_GRADIENT_STEP * std::max(1.0, std::fabs(q[k]));
+            x[k] = q[k] + h;
+            double up = b.bond->proposeBlock(b.whatami, all_coords, x);
+            x[k] = q[k] - h;
+            double down = b.bond->proposeBlock(b.whatami, all_coords, x);
+            x[k] = q[k];
+            g[k] += (up - down) / (2 * h);
+        }
+        
+        return b.bond->proposeBlock(b.whatami, all_coords, q);
+    }
+    
+    /**
+     * 
+     * @brief Temporary variable used in @link candidate().
+     * 
+     * To ensure performance the temporary variable should
+     * not be constructed in each step and sub-step of the 
+     * algorithm.
+     *  
+     */
+    double candidate;  
+    
+    /**
+     * 
+     * @brief Container to store all temporary proposed values.
+     * 
+     * To ensure performance the temporary variable should
+     * not be constructed in each step and sub-step of the 
+     * algorithm.
+     * 
+     */
+    std::vector<double> proposed;
+    
+    /**
+     *
+     * @brief Variable identifying which parameter is at turn
+     *        to be updated.
+     * 
+     */
+    size_t turn;
+    
+    /**
+     * 
+     * @brief First entry of the bonds walked in an update.
+     * 
+     */
+    bond_ref const *first_bond;
+    
+    /**
+     * 
+     * @brief One past the last entry of the bonds walked in an update.
+     * 
+     */
+    bond_ref const *last_bond;
+    
+    /**
+     * 
+     * @brief Pool for the parallel computation of the bonds, not owned.
+     * 
+     */
+    thread_pool *pool;
+    
+    /**
+     * 
+     * @brief Number of bond evaluations, see @ref evaluations.
+     * 
+     */
+    size_t evals;
+    
+    /**
+     * 
+     * @brief Differences of the single bonds in a parallel 
+     *        computation, reduced in order.
+     * 
+     */
+    std::vector<double> partials;
+    
+    /**
+     * 
+     * @brief Indices of all components, proposed jointly by 
+     *        @ref proposeState.
+     * 
+     */
+    std::vector<size_t> all_coords;
+    
+    /**
+     * 
+     * @brief Derivatives of the single bonds in @ref proposeState,
+     *        reduced in order.
+     * 
+     */
+    std::vector<std::vector<double> > bond_grads;
+    
+    /**
+     * 
+     * @brief Per bond, set if @ref proposeState differentiated it by
+     *        central differences, see @ref numericGradients.
+     * 
+     */
+    std::vector<char> bond_numeric;
+    
+    /**
+     * 
+     * @brief Determines if a full conditional had no closed form, the 
+     *        parameter takes random walk steps afterwards.
+     * 
+     */
+    bool conjugate_failed;
+    
+    /**
+     * 
+     * @brief Determines if the last update was a conjugate draw.
+     * 
+     */
+    bool drew_conjugate;
+    
+    /**
+     * 
+     * @brief Coefficients of the sufficient statistics of each bond, 
+     *        one vector per statistic.
+     * 
+     */
+    std::vector<std::vector<std::vector<double> > > bond_stats;
+    
+    /**
+     * 
+     * @brief Weighted sums of %bond_stats.
+     * 
+     */
+    std::vector<std::vector<double> > total_stats;
+    
+    /**
+     * 
+     * @brief Draws from the full conditionals.
+     * 
+     */
+    std::vector<double> drawn;
+    
+    /**
+     * 
+     * @brief Determines if the chromatic update is on.
+     * 
+     */
+    bool chromatic;
+    
+    /**
+     * 
+     * @brief Determines if %colours is up to date.
+     * 
+     */
+    bool coloured;
+    
+    /**
+     * 
+     * @brief The components of each colour, empty if the chromatic 
+     *        update is not possible.
+     * 
+     */
+    std::vector<std::vector<size_t> > colours;
+    
+    /**
+     * 
+     * @brief Changes of each bond per chunk of a colour.
+     * 
+     */
+    std::vector<std::vector<double> > colour_changes;
+    
+    /**
+     * 
+     * @brief Key and stream of the last @ref seed, addressing the draws
+     *        of the sweeps.
+     * 
+     */
+    uint64_t seed_key, seed_stream;
+    
+    /**
+     * 
+     * @brief Number of sweeps since the last @ref seed.
+     * 
+     */
+    uint64_t sweeps;
+    
+    /**
+     * 
+     * @brief The bonds in the order of @ref proposeEarly, empty until 
+     *        the first proposal after @ref setBonds, and their number
+     *        of terms.
+     * 
+     */
+    std::vector<size_t> bond_order, bond_terms;
+    
+    /**
+     * 
+     * @brief The weighted bounds of the bonds after each one in 
+     *        @ref proposeEarly, HUGE_VAL if not known.
+     * 
+     */
+    std::vector<double> bond_rest;
+    
+    /**
+     * 
+     * @brief Standard normals and uniforms of the current sweep, one
+     *        per component.
+     * 
+     */
+    std::vector<double> sweep_normals, sweep_uniforms;
+    
+    /**
+     * 
+     * @brief Blocks of components updated jointly.
+     * 
+     */
+    std::vector<block_proposal> blocks;
+    
+    /**
+     * 
+     * @brief Determines for each component if it belongs to a block.
+     * 
+     */
+    std::vector<bool> in_block;
+    
+    /**
+     * 
+     * @brief Standard normal draws for a block proposal.
+     * 
+     */
+    std::vector<double> block_z;
+    
+    /**
+     * 
+     * @brief Candidates of a block proposal.
+     * 
+     */
+    std::vector<double> block_cand;
+    
+    /**
+     * 
+     * @brief Determines if the step sizes are adapting.
+     * 
+     */
+    bool adapting;
+    
+    /**
+     * 
+     * @brief Number of updates after which the adaptation stops.
+     * 
+     */
+    size_t burnin;
+    
+    /**
+     * 
+     * @brief Number of updates since the adaptation started.
+     * 
+     */
+    size_t iteration;
+    
+    /**
+     * 
+     * @brief Target acceptance rate of the adaptation.
+     * 
+     */
+    double target;
+    
+    /**
+     * 
+     * @brief Number of adapted moves of each component.
+     * 
+     */
+    std::vector<size_t> adapt_steps;
+    
+    /**
+     *
+     * @brief Random number generator for the parameter proposal.
+     * 
+     * A stream of the counter-based @ref philox_engine, see @ref seed.
+     * 
+     */
+    philox_engine gen;
+    
+    /**
+     *
+     * @brief Random number generator for the parameter acceptance.
+     * 
+     * A stream of the counter-based @ref philox_engine, see @ref seed.
+     * 
+     */
+    philox_engine uni_gen;
+    
+    /**
+     *
+     * @brief Gaussian distribution object for the parameter proposal.
+     * 
+     * The Gaussian distribution is from the boost random library.
+     * 
+     */
+    boost::random::normal_distribution<double> dist;
+    
+    /**
+     *
+     * @brief Gaussian distribution object for the parameter acceptance.
+     * 
+     * The uniform distribution is from the boost random library.
+     * 
+     */
+    boost::random::uniform_01<double> uni_dist;
 };
 
 
@@ -0,0 +1,429 @@
+/**
+ *
+ * @file mcmc_sampler.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 30, 2012, 11:05 AM
+ *
+ * @brief Runs the updates of a model according to a schedule.
+ *
+ * The %mcmc_sampler drives a single chain. A sweep updates the
+ * parameters of the model, each as often as its repeat count, see
+ * @ref setRepeats. In the systematic scan the parameters come in the
+ * order they were added, each repeated in place. In the random scan a
+ * sweep draws as many updates as the systematic scan does, each
+ * parameter with probability proportional to its repeat count.
+ * Constant parameters are never updated.
+ *
+ * The first %burnin sweeps are not written, afterwards every %thin-th
+ * sweep is followed by mcmc_model::updateOutput. The adaptation of the
+ * step sizes is set on the model and its updates, see
+ * mcmc_model::startAdaptation. A run ends when the model has done a
+ * given number of sweeps in total, when the wall-clock time of the run
+ * is spent or when @ref stop is called, and calls mcmc_model::finish.
+ *
+ * The time of every update is measured and summed per parameter, see
+ * @ref timing, which shows which parameters dominate the cost of a
+ * sweep. The schedule is built when a run starts, the sweeps
+ * themselves do not allocate.
+ *
+ * Example:
+ * @code
+ * mcmc_sampler sampler(model);
+ * sampler.setRepeats(sigma, 5);
+ * sampler.setBurnin(1000);
+ * sampler.setThinning(10);
+ * model.startAdaptation(1000);
+ * sampler.run(11000, 60.0);
+ * std::cout << sampler.timing();
+ * @endcode
+ *
+ * @see mcmc_model
+ * @see mcmc_chains
+ *
+ */
+#ifndef MCMC_SAMPLER_H
+#define	MCMC_SAMPLER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/random/uniform_01.hpp>
+#include "mcmc_model.h"
+#include "philox_engine.h"
+
+/**
+ *
+ * @brief Offset of the random stream of the scan within the streams
+ *        of a chain, see mcmc_model::seed.
+ *
+ */
+static uint64_t const SAMPLER_STREAM = 0xFFFFFFFFu;
+
+class mcmc_sampler {
+public:
+
+    /**
+     *
+     * @brief The order of the updates in a sweep.
+     *
+     */
+    enum scan_order {
+        SYSTEMATIC_SCAN,
+        RANDOM_SCAN
+    };
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param model The model, referenced. Has to outlive the sampler.
+     * @param scan The order of the updates in a sweep.
+     *
+     * The random scan draws from key and chain zero until @ref seed is
+     * called, as the model does.
+     *
+     */
+    mcmc_sampler(mcmc_model &model, scan_order scan = SYSTEMATIC_SCAN) : model(model), scan(scan),
+    burnin(0), thin(1), sweeps(0), outputs(0), stopping(false), gen(0, 2 * SAMPLER_STREAM) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    ~mcmc_sampler() {};
+
+    /**
+     *
+     * @brief Sets the random streams of the model and of the scan.
+     * @param key Seed shared by all chains of a run.
+     * @param chain Number of the chain, below 2^31.
+     *
+     * The scan draws from the last stream of the chain, which no
+     * parameter uses.
+     *
+     * @see mcmc_model::seed
+     *
+     */
+    void seed(uint64_t key, uint64_t chain) {
+        model.seed(key, chain);
+        gen = philox_engine(key, 2 * ((chain << 32) + SAMPLER_STREAM));
+    }
+
+    /**
+     *
+     * @brief Sets the number of updates of a parameter per sweep.
+     * @param i Index of the parameter.
+     * @param times Number of updates, zero leaves it out.
+     *
+     * Parameters start with one update per sweep.
+     *
+     */
+    void setRepeats(size_t i, size_t times) {
+        if(repeats.size() < model.numParameters()) {
+            repeats.resize(model.numParameters(), 1);
+        }
+        repeats[i] = times;
+    }
+
+    /**
+     *
+     * @brief Sets the number of sweeps before the first output.
+     *
+     */
+    void setBurnin(size_t burnin) {
+        this->burnin = burnin;
+    }
+
+    /**
+     *
+     * @brief Sets the number of sweeps per output after the burn-in,
+     *        at least one.
+     *
+     */
+    void setThinning(size_t thin) {
+        this->thin = std::max<size_t>(thin, 1);
+    }
+
+    /**
+     *
+     * @brief  Runs sweeps until a budget is spent.
+     * @param  total Number of sweeps of the model, the burn-in and
+     *         earlier runs included, after which the run ends. Zero
+     *         for no limit.
+     * @param  seconds Wall-clock time of this run after which it ends,
+     *         checked after every sweep. Zero for no limit.
+     * @return Number of sweeps of this run.
+     *
+     * With neither limit the run lasts until @ref stop is called. Can
+     * be called again to continue.
+     *
+     */
+    size_t run(size_t total, double seconds = 0) {
+        makeSchedule();
+        stopping.store(false);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t before = sweeps;
+        while((total == 0 || sweeps < total) && !stopping.load(std::memory_order_relaxed)) {
+            sweep();
+            ++sweeps;
+            if(sweeps > burnin && (sweeps - burnin) % thin == 0) {
+                model.updateOutput();
+                ++outputs;
+            }
+            if(seconds > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= seconds) {
+                break;
+            }
+        }
+        model.finish();
+
+        return sweeps - before;
+    }
+
+    /**
+     *
+     * @brief Stops a run after the current sweep.
+     *
+     * Can be called from any thread.
+     *
+     */
+    void stop() {
+        stopping.store(true);
+    }
+
+    /**
+     *
+     * @brief Number of sweeps of all runs.
+     *
+     */
+    size_t numSweeps() const {
+        return sweeps;
+    }
+
+    /**
+     *
+     * @brief Number of sweeps that were written.
+     *
+     */
+    size_t numOutputs() const {
+        return outputs;
+    }
+
+    /**
+     *
+     * @brief Wall-clock seconds spent in the updates of parameter i.
+     *
+     */
+    double updateTime(size_t i) const {
+        return i < seconds.size() ? seconds[i] : 0.0;
+    }
+
+    /**
+     *
+     * @brief Number of updates of parameter i.
+     *
+     */
+    size_t numUpdates(size_t i) const {
+        return i < counts.size() ? counts[i] : 0;
+    }
+
+    /**
+     *
+     * @brief Resets the times and numbers of the updates.
+     *
+     */
+    void resetTiming() {
+        std::fill(seconds.begin(), seconds.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+    }
+
+    /**
+     *
+     * @brief  Reports the cost of the updates.
+     * @return One line per updated parameter with its total time, its
+     *         share of the time of all updates and the mean time of an
+     *         update.
+     *
+     */
+    std::string timing() const {
+        double all = 0;
+        for(size_t i = 0; i < seconds.size(); ++i) {
+            all += seconds[i];
+        }
+        std::ostringstream out;
+        for(size_t i = 0; i < seconds.size(); ++i) {
+            if(counts[i] == 0) {
+                continue;
+            }
+            out << model.parameter(i).name << ": " << seconds[i] << " s ("
+                << (all > 0 ? 100 * seconds[i] / all : 0.0) << "%), "
+                << 1e6 * seconds[i] / counts[i] << " us per update\n";
+        }
+
+        return out.str();
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable.
+     *
+     */
+    mcmc_sampler(mcmc_sampler const &other);
+    mcmc_sampler& operator=(mcmc_sampler const &other);
+
+    /**
+     *
+     * @brief Builds the updates of a systematic sweep and, for the
+     *        random scan, the cumulative repeat counts.
+     *
+     */
+    void makeSchedule() {
+        size_t npars = model.numParameters();
+        repeats.resize(npars, 1);
+        seconds.resize(npars, 0.0);
+        counts.resize(npars, 0);
+        order.clear();
+        cumulative.clear();
+        candidates.clear();
+        size_t sum = 0;
+        for(size_t i = 0; i < npars; ++i) {
+            if(model.parameter(i).const_val || repeats[i] == 0) {
+                continue;
+            }
+            order.insert(order.end(), repeats[i], i);
+            sum += repeats[i];
+            cumulative.push_back(sum);
+            candidates.push_back(i);
+        }
+    }
+
+    /**
+     *
+     * @brief Runs the updates of one sweep and measures each.
+     *
+     */
+    void sweep() {
+        if(scan == RANDOM_SCAN && !cumulative.empty()) {
+            double total = static_cast<double>(cumulative.back());
+            for(size_t u = 0; u < order.size(); ++u) {
+                size_t pick = static_cast<size_t>(uni_dist(gen) * total);
+                order[u] = candidates[std::upper_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin()];
+            }
+        }
+        std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+        for(size_t u = 0; u < order.size(); ++u) {
+            size_t i = order[u];
+            model.update(i);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            seconds[i] += std::chrono::duration<double>(now - last).count();
+            ++counts[i];
+            last = now;
+        }
+    }
+
+    /**
+     *
+     * @brief The model, not owned.
+     *
+     */
+    mcmc_model &model;
+
+    /**
+     *
+     * @brief The order of the updates in a sweep.
+     *
+     */
+    scan_order scan;
+
+    /**
+     *
+     * @brief Number of sweeps before the first output.
+     *
+     */
+    size_t burnin;
+
+    /**
+     *
+     * @brief Number of sweeps per output.
+     *
+     */
+    size_t thin;
+
+    /**
+     *
+     * @brief Number of sweeps of all runs.
+     *
+     */
+    size_t sweeps;
+
+    /**
+     *
+     * @brief Number of sweeps written.
+     *
+     */
+    size_t outputs;
+
+    /**
+     *
+     * @brief Set to end a run early.
+     *
+     */
+    std::atomic<bool> stopping;
+
+    /**
+     *
+     * @brief Number of updates of each parameter per sweep.
+     *
+     */
+    std::vector<size_t> repeats;
+
+    /**
+     *
+     * @brief The parameters of the current sweep, in order.
+     *
+     */
+    std::vector<size_t> order;
+
+    /**
+     *
+     * @brief The updated parameters and the cumulative sums of their
+     *        repeat counts, for the random scan.
+     *
+     */
+    std::vector<size_t> candidates, cumulative;
+
+    /**
+     *
+     * @brief Seconds spent in the updates of each parameter.
+     *
+     */
+    std::vector<double> seconds;
+
+    /**
+     *
+     * @brief Number of updates of each parameter.
+     *
+     */
+    std::vector<size_t> counts;
+
+    /**
+     *
+     * @brief Random number generator of the random scan.
+     *
+     */
+    philox_engine gen;
+
+    /**
+     *
+     * @brief Uniform distribution on [0, 1).
+     *
+     */
+    boost::random::uniform_01<double> uni_dist;
+};
+
+#endif	/* MCMC_SAMPLER_H */
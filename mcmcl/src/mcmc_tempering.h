@@ -0,0 +1,486 @@
+/**
+ *
+ * @file mcmc_tempering.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 26, 2012, 10:20 AM
+ *
+ * @brief Parallel tempering (replica exchange) of a model.
+ *
+ * The %mcmc_tempering run K copies of a model, the replicas, at the
+ * inverse temperatures 1 = beta_0 > ... > beta_{K-1}, see
+ * mcmc_model::setInverseTemperature. Hot replicas see a flattened
+ * posterior and move between modes, swaps pass their states down
+ * the ladder to the cold replica, which samples the posterior.
+ *
+ * The replicas update in parallel on an own @ref thread_pool, one task
+ * per replica, for a number of updates. If there are fewer replicas
+ * than threads, the replicas compute their bonds on a second pool with
+ * the remaining threads, as in @ref mcmc_chains. Then neighbouring levels try
+ * to swap, the even pairs and the odd pairs in turn (deterministic
+ * even-odd scheme). A swap exchanges the states of the two replicas,
+ * see mcmc_model::swapState, and each replica stays at its level.
+ * The step sizes, block covariances, slice widths and NUTS step sizes
+ * of a replica are therefore tuned at its own temperature, and the
+ * output of the cold replica is the cold trace. The bonds exchange
+ * their copies of the parameters and their current values along with
+ * the parameters, so an accepted swap swaps vectors and computes no
+ * bond again. The probability of a swap of levels k and k + 1 is
+ * min(1, exp((beta_k - beta_{k+1}) (L_{k+1} - L_k))), with L the sum
+ * of the tempered bonds of a replica, see mcmc_model::temperedValue.
+ *
+ * During the burn-in the ladder adapts every %ADAPT_ROUNDS swap rounds:
+ * the rejection rates of the pairs are summed along the ladder and the
+ * inner temperatures are moved, interpolated in log(beta), such that
+ * every pair gets the same share of the sum (Syed, Bouchard-Cote,
+ * Deligiannidis and Doucet, 2019). The rates of the pairs become
+ * uniform. beta_0 and beta_{K-1} stay fixed.
+ *
+ * Only the replica at level 0, beta = 1, writes its output. Replica k
+ * is seeded like chain k of @ref mcmc_chains, the swaps draw from the
+ * stream 2^64 - 1.
+ *
+ * Example:
+ * @code
+ * mcmc_tempering pt(model, 8, 0.01, 20120626);
+ * pt.startAdaptation(2000);
+ * pt.run(10000);
+ * std::cout << pt.accepted();
+ * @endcode
+ *
+ * @see mcmc_model
+ * @see mcmc_chains
+ *
+ */
+#ifndef MCMC_TEMPERING_H
+#define	MCMC_TEMPERING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/random/uniform_01.hpp>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "philox_engine.h"
+#include "thread_pool.h"
+
+class mcmc_tempering {
+public:
+
+    /**
+     *
+     * @brief Number of swap rounds between two adaptations of the
+     *        ladder.
+     *
+     */
+    static size_t const ADAPT_ROUNDS = 100;
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param model The model, finalized or not. It is copied and not
+     *        used afterwards.
+     * @param nreplicas Number of replicas, K.
+     * @param beta_min Inverse temperature of the hottest replica.
+     * @param key Seed of the random streams.
+     * @param nthreads Number of threads, all cores if zero.
+     * @param setup Called with each copy and its replica number before
+     *        it is seeded. May be empty.
+     *
+     * The ladder starts geometric, beta_k = beta_min^(k / (K - 1)).
+     *
+     */
+    mcmc_tempering(mcmc_model const &model, size_t nreplicas, double beta_min, uint64_t key,
+        size_t nthreads = 0, std::function<void(mcmc_model&, size_t)> const &setup = std::function<void(mcmc_model&, size_t)>()) :
+    pool(std::min(threads(nthreads), std::max<size_t>(nreplicas, 1))),
+    bond_pool(threads(nthreads) - pool.size() + 1), betas(nreplicas, 1.0), accept_sums(nreplicas, 0.0), tries(nreplicas, 0),
+    swap_gen(key, ~static_cast<uint64_t>(0)), done(0), rounds(0), adapting(false), burnin(0),
+    errors(nreplicas), stopping(false) {
+        for(size_t k = 1; k < nreplicas; ++k) {
+            betas[k] = std::pow(beta_min, static_cast<double>(k) / (nreplicas - 1));
+        }
+        for(size_t k = 0; k < nreplicas; ++k) {
+            replicas.push_back(boost::shared_ptr<mcmc_model>(model.clone()));
+            replicas[k]->finalize();
+            if(setup) {
+                setup(*replicas[k], k);
+            }
+            replicas[k]->seed(key, k);
+            replicas[k]->setInverseTemperature(betas[k]);
+            if(bond_pool.size() > 1) {
+                replicas[k]->setThreadPool(&bond_pool);
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief Default destructor, joins the threads.
+     *
+     */
+    ~mcmc_tempering() {};
+
+    /**
+     *
+     * @brief Runs every replica for a number of updates.
+     * @param iterations Number of updates of each replica.
+     * @param interval Number of updates between two swap rounds.
+     *
+     * The replica at beta = 1 calls mcmc_model::updateOutput after each
+     * of its updates. Returns when done or stopped, an exception of a
+     * replica is rethrown. Can be called again to continue.
+     *
+     */
+    void run(size_t iterations, size_t interval = 1) {
+        stopping.store(false);
+        interval = std::max(interval, static_cast<size_t>(1));
+        for(size_t it = 0; it < iterations && !stopping.load(); it += interval) {
+            size_t steps = std::min(interval, iterations - it);
+            pool.run(replicas.size(), [this, steps](size_t r) {
+                try {
+                    for(size_t s = 0; s < steps && !stopping.load(std::memory_order_relaxed); ++s) {
+                        replicas[r]->update();
+                        if(r == 0) {
+                            replicas[r]->updateOutput();
+                        }
+                    }
+                } catch(...) {
+                    errors[r] = std::current_exception();
+                    stopping.store(true);
+                }
+            });
+            for(size_t r = 0; r < replicas.size(); ++r) {
+                if(errors[r]) {
+                    std::exception_ptr e = errors[r];
+                    errors[r] = std::exception_ptr();
+                    std::rethrow_exception(e);
+                }
+            }
+            if(stopping.load()) {
+                return;
+            }
+            done += steps;
+            swap();
+            if(adapting && done >= burnin) {
+                stopAdaptation();
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Stops a run after the current update of every replica.
+     *
+     * Can be called from any thread.
+     *
+     */
+    void stop() {
+        stopping.store(true);
+    }
+
+    /**
+     *
+     * @brief Starts the adaptation of the ladder and of the step sizes
+     *        of all replicas.
+     * @param burnin Number of updates after which both are frozen.
+     *
+     * @see mcmc_model::startAdaptation
+     *
+     */
+    void startAdaptation(size_t burnin) {
+        this->burnin = done + burnin;
+        adapting = true;
+        resetStatistics();
+        for(size_t k = 0; k < replicas.size(); ++k) {
+            replicas[k]->startAdaptation(burnin);
+        }
+    }
+
+    /**
+     *
+     * @brief Freezes the ladder.
+     *
+     * Called by @ref run after the burn-in. Resets the swap statistics.
+     *
+     */
+    void stopAdaptation() {
+        adapting = false;
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief  Mean swap probability of the levels k and k + 1 since
+     *         the last change of the ladder or the phase.
+     *
+     */
+    double swapRate(size_t k) const {
+        return tries[k] > 0 ? accept_sums[k] / tries[k] : 0.0;
+    }
+
+    /**
+     *
+     * @brief Inverse temperature of level k.
+     *
+     */
+    double inverseTemperature(size_t k) const {
+        return betas[k];
+    }
+
+    /**
+     *
+     * @brief Returns the replica at level k, the cold one for k = 0.
+     *
+     */
+    mcmc_model &replica(size_t k) {
+        return *replicas[k];
+    }
+
+    /**
+     *
+     * @brief Number of replicas.
+     *
+     */
+    size_t numReplicas() const {
+        return replicas.size();
+    }
+
+    /**
+     *
+     * @brief  Reports the ladder and the cold replica.
+     * @return One line with the inverse temperatures and the swap
+     *         rates in between, followed by the acceptance statistics
+     *         of the cold replica, see mcmc_model::accepted.
+     *
+     */
+    std::string accepted() {
+        std::ostringstream out;
+        out << "ladder" << (adapting ? " (adapting)" : "") << ":";
+        for(size_t k = 0; k < betas.size(); ++k) {
+            out << " " << betas[k];
+            if(k + 1 < betas.size()) {
+                out << " <" << swapRate(k) << ">";
+            }
+        }
+        out << "\n" << replica(0).accepted();
+
+        return out.str();
+    }
+
+    /**
+     *
+     * @brief Finishes all replicas.
+     *
+     */
+    void finish() {
+        for(size_t k = 0; k < replicas.size(); ++k) {
+            replicas[k]->finish();
+        }
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the replicas use the pools.
+     *
+     */
+    mcmc_tempering(mcmc_tempering const &other);
+    mcmc_tempering& operator=(mcmc_tempering const &other);
+
+    /**
+     *
+     * @brief  Number of threads of a run.
+     * @param  nthreads Number of threads, all cores if zero.
+     *
+     */
+    static size_t threads(size_t nthreads) {
+        return nthreads > 0 ? nthreads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     *
+     * @brief One round of swaps of the even or the odd pairs.
+     *
+     */
+    void swap() {
+        for(size_t k = rounds % 2; k + 1 < replicas.size(); k += 2) {
+            mcmc_model &lo = *replicas[k];
+            mcmc_model &hi = *replicas[k + 1];
+            double logr = (betas[k] - betas[k + 1]) * (hi.temperedValue() - lo.temperedValue());
+            double p = logr >= 0 ? 1.0 : std::exp(logr);
+            accept_sums[k] += p;
+            ++tries[k];
+            if(uni_dist(swap_gen) < p) {
+                lo.swapState(hi);
+            }
+        }
+        ++rounds;
+        if(adapting && rounds % ADAPT_ROUNDS == 0) {
+            adaptLadder();
+        }
+    }
+
+    /**
+     *
+     * @brief Moves the inner temperatures such that the rejection
+     *        rates of all pairs are equal.
+     *
+     * The cumulated rejection rates at the levels are a monotone map
+     * of log(beta). The new inner levels are at equidistant values of
+     * this map, interpolated linearly.
+     *
+     */
+    void adaptLadder() {
+        size_t K = betas.size();
+        if(K < 3) {
+            return;
+        }
+        std::vector<double> cum(K, 0.0);
+        for(size_t k = 0; k + 1 < K; ++k) {
+            if(tries[k] == 0) {
+                return;
+            }
+            cum[k + 1] = cum[k] + 1 - swapRate(k);
+        }
+        if(!(cum[K - 1] > 0)) {
+            return;
+        }
+        std::vector<double> adapted(betas);
+        size_t k = 0;
+        for(size_t j = 1; j + 1 < K; ++j) {
+            double target = cum[K - 1] * j / (K - 1);
+            while(k + 2 < K && cum[k + 1] < target) {
+                ++k;
+            }
+            double gap = cum[k + 1] - cum[k];
+            double t = gap > 0 ? (target - cum[k]) / gap : 0.0;
+            adapted[j] = std::exp(std::log(betas[k]) + t * (std::log(betas[k + 1]) - std::log(betas[k])));
+        }
+        betas.swap(adapted);
+        for(size_t j = 0; j < K; ++j) {
+            replicas[j]->setInverseTemperature(betas[j]);
+        }
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief Resets the swap statistics.
+     *
+     */
+    void resetStatistics() {
+        std::fill(accept_sums.begin(), accept_sums.end(), 0.0);
+        std::fill(tries.begin(), tries.end(), 0);
+    }
+
+    /**
+     *
+     * @brief The pool running the replicas, one thread per replica at
+     *        most. Declared first, such that it is destroyed last.
+     *
+     */
+    thread_pool pool;
+
+    /**
+     *
+     * @brief The pool computing the bonds of all replicas, with the
+     *        threads not running replicas. A single thread, i.e.
+     *        unused, if there are as many replicas as threads.
+     *
+     */
+    thread_pool bond_pool;
+
+    /**
+     *
+     * @brief The models of the replicas, replica k at level k.
+     *
+     */
+    std::vector<boost::shared_ptr<mcmc_model> > replicas;
+
+    /**
+     *
+     * @brief The inverse temperature of each level, decreasing.
+     *
+     */
+    std::vector<double> betas;
+
+    /**
+     *
+     * @brief Sums of the swap probabilities of each pair of levels.
+     *
+     */
+    std::vector<double> accept_sums;
+
+    /**
+     *
+     * @brief Number of swap attempts of each pair of levels.
+     *
+     */
+    std::vector<size_t> tries;
+
+    /**
+     *
+     * @brief Random number generator of the swaps.
+     *
+     */
+    philox_engine swap_gen;
+
+    /**
+     *
+     * @brief Uniform distribution of the swaps.
+     *
+     */
+    boost::random::uniform_01<double> uni_dist;
+
+    /**
+     *
+     * @brief Number of updates of each replica.
+     *
+     */
+    size_t done;
+
+    /**
+     *
+     * @brief Number of swap rounds.
+     *
+     */
+    size_t rounds;
+
+    /**
+     *
+     * @brief Determines if the ladder adapts.
+     *
+     */
+    bool adapting;
+
+    /**
+     *
+     * @brief Number of updates after which the adaptation stops.
+     *
+     */
+    size_t burnin;
+
+    /**
+     *
+     * @brief Exception thrown by each replica in the current run, if
+     *        any.
+     *
+     */
+    std::vector<std::exception_ptr> errors;
+
+    /**
+     *
+     * @brief Set to end a run early.
+     *
+     */
+    std::atomic<bool> stopping;
+};
+
+#endif	/* MCMC_TEMPERING_H */
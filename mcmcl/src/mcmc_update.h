@@ -18,6 +18,9 @@
 #ifndef MCMC_UPDATE_H
 #define	MCMC_UPDATE_H
 
+#include <stdint.h>
+#include <string>
+
 class mcmc_update {
 public:
     
@@ -72,6 +75,20 @@ public:
      * 
      */
     virtual void finish() {};
+    
+    /**
+     * 
+     * @brief Sets the random stream of the update.
+     * @param key Seed shared by all streams of a run.
+     * @param stream Number of the stream, unique per update and chain.
+     * 
+     * Updates drawing random numbers use @ref philox_engine streams,
+     * which are disjoint for different numbers.
+     * 
+     * @see mcmc_model::seed
+     * 
+     */
+    virtual void seed(uint64_t key, uint64_t stream) {};
 };
 
 #endif	/* MCMCUPDATE_H */
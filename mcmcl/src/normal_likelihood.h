@@ -0,0 +1,195 @@
+/**
+ *
+ * @file normal_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 11, 2012, 4:05 PM
+ *
+ * @brief Log-density of the Normal distribution.
+ *
+ * Columns: observations y, means mu and standard deviations sigma.
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef NORMAL_LIKELIHOOD_H
+#define	NORMAL_LIKELIHOOD_H
+
+#include <cmath>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Normal log-density kernel for the instruction set V.
+ *
+ * A broadcast sigma is inverted and logged once.
+ *
+ */
+template<class V>
+class normal_kernel {
+public:
+
+    normal_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), mu(args[1]), sd(args[2]),
+    inv_sd(V::set1(sd.scalar ? 1.0 / args[2][0] : 0.0)),
+    log_sd(V::set1(sd.scalar ? std::log(args[2][0]) : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg d = V::sub(y(i), mu(i));
+        typename V::reg z = sd.scalar ? V::mul(d, inv_sd) : V::div(d, sd(i));
+        typename V::reg l = sd.scalar ? log_sd : V::log(sd(i));
+
+        return V::sub(V::fnmadd(V::set1(0.5), V::mul(z, z), V::set1(-0.91893853320467274178)), l);
+    }
+
+    simd_column<V> y, mu, sd;
+    typename V::reg inv_sd, log_sd;
+};
+
+class normal_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~normal_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y, mu and sigma.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y, mu and sigma.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        return simd_sum<normal_kernel>(args);
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-density of a single observation.
+     * @param row y, mu and sigma of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        double z = (row[0] - row[1]) / row[2];
+
+        return -0.5 * z * z - std::log(row[2]) - 0.91893853320467274178;
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y, mu and sigma.
+     * @param grad Derivatives with respect to y, mu and sigma.
+     *
+     * With z = (y - mu) / sigma these are -z / sigma, z / sigma and
+     * (z^2 - 1) / sigma.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            double inv = 1.0 / args[2][i];
+            double z = (args[0][i] - args[1][i]) * inv;
+            if(grad[0]) {
+                grad[0][i] = -z * inv;
+            }
+            if(grad[1]) {
+                grad[1][i] = z * inv;
+            }
+            if(grad[2]) {
+                grad[2][i] = (z * z - 1) * inv;
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief All arguments are conjugate.
+     *
+     */
+    virtual bool isConjugate (size_t arg) const {
+        return arg < 3;
+    };
+
+    /**
+     *
+     * @brief Computes the coefficients of the sufficient statistics.
+     * @param args Views on y, mu and sigma.
+     * @param arg Index of the argument.
+     * @param stats Coefficients of x, x^2, log x and x^(-2).
+     *
+     * In y or mu a term is quadratic, -x^2 / (2 sigma^2) + x c / sigma^2
+     * with c the other one of them. In sigma it is 
+     * -log sigma - (y - mu)^2 / (2 sigma^2).
+     *
+     */
+    virtual void sufficientStatistics (std::vector<argument_view> const &args, size_t arg,
+        std::vector<double*> const &stats) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            if(arg == 2) {
+                double d = args[0][i] - args[1][i];
+                stats[0][i] = 0;
+                stats[1][i] = 0;
+                stats[2][i] = -1;
+                stats[3][i] = -0.5 * d * d;
+            } else {
+                double prec = 1.0 / (args[2][i] * args[2][i]);
+                stats[0][i] = args[1 - arg][i] * prec;
+                stats[1][i] = -0.5 * prec;
+                stats[2][i] = 0;
+                stats[3][i] = 0;
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief  Bounds the log-likelihood by the mode of every term.
+     * @param  args Views on y, mu and sigma.
+     * @return n (-log sigma - log(2 pi) / 2) for a broadcast sigma,
+     *         else HUGE_VAL.
+     *
+     */
+    virtual double upperBound (std::vector<argument_view> const &args) {
+        if(!args[2].isScalar()) {
+            return HUGE_VAL;
+        }
+
+        return args[0].size() * (-std::log(args[2][0]) - 0.91893853320467274178);
+    };
+};
+#endif	/* NORMAL_LIKELIHOOD_H */
+
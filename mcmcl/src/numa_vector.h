@@ -0,0 +1,314 @@
+/**
+ *
+ * @file numa_vector.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 4, 2012, 10:20 AM
+ *
+ * @brief Array whose pages are placed on chosen NUMA nodes.
+ *
+ * Linux places a page on the node of the thread that first writes it.
+ * The %numa_vector reserves its memory without touching it, such that
+ * the placement is decided by @ref assign: with a @ref thread_pool the
+ * entries are written chunk by chunk as tasks of the pool, task c
+ * writing the entries of chunk c. A bond evaluating the same chunks
+ * on the same pool, see basic_mcmc_bond::CHUNK_TERMS, deals task c
+ * to the same thread, so with pinned threads, see thread_pool, each
+ * thread reads mostly local memory. Tasks stolen by other threads
+ * read remote memory, but stay correct.
+ *
+ * Alternatively the pages are bound to a node with @ref bind or
+ * spread over all nodes with @ref interleave, before or after they
+ * are written. Both call mbind directly, without libnuma, and fail on
+ * systems without NUMA support, where the pages stay where they are.
+ *
+ * Only types that can be copied bytewise are stored, the entries are
+ * zero until assigned.
+ *
+ * @see data_frame
+ *
+ */
+#ifndef NUMA_VECTOR_H
+#define	NUMA_VECTOR_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+/**
+ *
+ * @brief  Number of NUMA nodes of the system.
+ * @return The number of nodes in /sys/devices/system/node, at least
+ *         one.
+ *
+ */
+inline int numa_nodes() {
+    int n = 0;
+    DIR *dir = opendir("/sys/devices/system/node");
+    if(dir != 0) {
+        while(struct dirent *e = readdir(dir)) {
+            if(std::strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+                ++n;
+            }
+        }
+        closedir(dir);
+    }
+
+    return n > 0 ? n : 1;
+}
+
+template<class T>
+class numa_vector {
+public:
+
+    /**
+     *
+     * @brief Default constructor, an empty vector.
+     *
+     */
+    numa_vector() : addr(0), n(0), bytes(0) {};
+
+    /**
+     *
+     * @brief Custom constructor, reserves n entries, see @ref allocate.
+     *
+     */
+    explicit numa_vector(size_t n) : addr(0), n(0), bytes(0) {
+        allocate(n);
+    };
+
+    /**
+     *
+     * @brief Destructor, releases the memory.
+     *
+     */
+    ~numa_vector() {
+        release();
+    };
+
+    /**
+     *
+     * @brief  Reserves n entries, without placing any page.
+     * @return True, if the memory is reserved. Otherwise @ref error
+     *         tells why and the vector is empty.
+     *
+     * Former entries are released.
+     *
+     */
+    bool allocate(size_t n) {
+        release();
+        if(n == 0) {
+            return true;
+        }
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t length = (n * sizeof(T) + page - 1) / page * page;
+        void *p = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(p == MAP_FAILED) {
+            message = std::strerror(errno);
+            return false;
+        }
+        addr = static_cast<T*>(p);
+        this->n = n;
+        bytes = length;
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief  Binds the pages to a node, moving the ones already
+     *         placed.
+     * @param  node Index of the node.
+     * @return True, if the system accepted the binding.
+     *
+     */
+    bool bind(int node) {
+        if(node < 0) {
+            message = "invalid node";
+            return false;
+        }
+        std::vector<unsigned long> mask(node / (8 * sizeof(unsigned long)) + 1, 0);
+        mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+
+        return policy(MPOL_BIND, mask);
+    }
+
+    /**
+     *
+     * @brief  Spreads the pages round-robin over all nodes, moving the
+     *         ones already placed.
+     * @return True, if the system accepted the policy.
+     *
+     */
+    bool interleave() {
+        int nodes = numa_nodes();
+        std::vector<unsigned long> mask(nodes / (8 * sizeof(unsigned long)) + 1, 0);
+        for(int node = 0; node < nodes; ++node) {
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        }
+
+        return policy(MPOL_INTERLEAVE, mask);
+    }
+
+    /**
+     *
+     * @brief Copies the entries from an array.
+     * @param src The %size() entries to copy.
+     * @param pool The pool writing the chunks, or null to write them
+     *        on the calling thread.
+     * @param chunk Number of entries per task, zero for a single task.
+     *
+     * The first write of a page places it, unless a policy is set.
+     *
+     */
+    void assign(T const *src, thread_pool *pool = 0, size_t chunk = 0) {
+        if(n == 0) {
+            return;
+        }
+        if(chunk == 0 || chunk > n) {
+            chunk = n;
+        }
+        size_t nchunks = (n + chunk - 1) / chunk;
+        std::function<void(size_t)> task = [this, src, chunk](size_t c) {
+            size_t begin = c * chunk;
+            size_t end = std::min(n, begin + chunk);
+            std::memcpy(addr + begin, src + begin, (end - begin) * sizeof(T));
+        };
+        if(pool != 0 && nchunks > 1) {
+            pool->run(nchunks, task);
+        } else {
+            for(size_t c = 0; c < nchunks; ++c) {
+                task(c);
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Number of entries.
+     *
+     */
+    size_t size() const {
+        return n;
+    }
+
+    /**
+     *
+     * @brief The first entry, null if the vector is empty.
+     *
+     */
+    T *data() {
+        return addr;
+    }
+
+    T const *data() const {
+        return addr;
+    }
+
+    T &operator[](size_t i) {
+        return addr[i];
+    }
+
+    T const &operator[](size_t i) const {
+        return addr[i];
+    }
+
+    T const *begin() const {
+        return addr;
+    }
+
+    T const *end() const {
+        return addr + n;
+    }
+
+    /**
+     *
+     * @brief Why the last @ref allocate, @ref bind or @ref interleave
+     *        failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the memory is released once.
+     *
+     */
+    numa_vector(numa_vector const &other);
+    numa_vector& operator=(numa_vector const &other);
+
+    /**
+     *
+     * @brief Releases the memory, if any.
+     *
+     */
+    void release() {
+        if(addr != 0) {
+            munmap(addr, bytes);
+        }
+        addr = 0;
+        n = 0;
+        bytes = 0;
+    }
+
+    /**
+     *
+     * @brief Sets a memory policy on the pages.
+     *
+     */
+    bool policy(int mode, std::vector<unsigned long> const &mask) {
+        if(addr == 0) {
+            return true;
+        }
+        unsigned long maxnode = mask.size() * 8 * sizeof(unsigned long) + 1;
+        if(syscall(SYS_mbind, addr, bytes, mode, &mask[0], maxnode, MPOL_MF_MOVE) != 0) {
+            message = std::strerror(errno);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief The entries.
+     *
+     */
+    T *addr;
+
+    /**
+     *
+     * @brief Number of entries.
+     *
+     */
+    size_t n;
+
+    /**
+     *
+     * @brief Length of the mapping, whole pages.
+     *
+     */
+    size_t bytes;
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
+};
+
+#endif	/* NUMA_VECTOR_H */
@@ -0,0 +1,636 @@
+/**
+ *
+ * @file nuts_update.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 22, 2012, 11:10 AM
+ *
+ * @brief Hamiltonian Monte Carlo update of a parameter with the
+ *        No-U-Turn sampler.
+ *
+ * The %nuts_update moves all components of an @ref mcmc_parameter
+ * jointly along a Hamiltonian trajectory, which follows the gradient
+ * of the logged posterior (Hoffman and Gelman, 2014, algorithm 6).
+ * The trajectory is doubled forwards or backwards in time until it
+ * makes a U-turn or reaches %NUTS_MAX_DEPTH doublings and the new
+ * state is drawn from it. The momenta have the covariance
+ * diag(1 / mss^2), so the step sizes of the parameter scale the
+ * components like in the random walk.
+ *
+ * The leapfrog step size is found by doubling or halving at the first
+ * update and adapts to a target mean acceptance statistic by dual
+ * averaging during the burn-in, see @ref startAdaptation. It is
+ * frozen afterwards.
+ *
+ * Each leapfrog step costs one computation of all bonds of the
+ * parameter and of their derivatives, see
+ * mcmc_parameter::proposeState. Derivatives are analytic for the
+ * built-in likelihoods and argument makers, other bonds are
+ * differentiated numerically at 2 d + 2 computations for d components,
+ * which @ref accepted reports.
+ *
+ * Example:
+ * @code
+ * nuts_update nuts(model.parameter(beta));
+ * nuts.startAdaptation(1000);
+ * model.setUpdate(beta, &nuts);
+ * @endcode
+ *
+ * @see mcmc_parameter
+ * @see mcmc_likelihood::gradient
+ *
+ */
+#ifndef NUTS_UPDATE_H
+#define	NUTS_UPDATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
+#include "mcmc_update.h"
+#include "mcmc_parameter.h"
+#include "philox_engine.h"
+
+/**
+ *
+ * @brief Default largest number of doublings of a trajectory.
+ *
+ */
+static size_t const NUTS_MAX_DEPTH = 10;
+
+/**
+ *
+ * @brief Default target of the mean acceptance statistic.
+ *
+ */
+static double const NUTS_TARGET = 0.8;
+
+/**
+ *
+ * @brief Largest error in the Hamiltonian before a trajectory is
+ *        considered divergent.
+ *
+ */
+static double const NUTS_MAX_DELTA = 1000;
+
+class nuts_update : public mcmc_update {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param par The parameter, referenced. Has to outlive the update.
+     * @param max_depth Largest number of doublings of a trajectory.
+     *
+     */
+    nuts_update(mcmc_parameter &par, size_t max_depth = NUTS_MAX_DEPTH) : par(par),
+    max_depth(max_depth), eps(0), adapting(false), burnin(0), iteration(0), target(NUTS_TARGET),
+    mu(0), hbar(0), log_eps_bar(0), updates(0), divergences(0), depths(0), accept_stats(0),
+    near(max_depth + 1), cands(max_depth + 1), gen(0, 0), uni_gen(0, 1) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    virtual ~nuts_update() {};
+
+    /**
+     *
+     * @brief Starts the adaptation of the step size.
+     * @param burnin Number of updates after which the step size is
+     *        frozen.
+     * @param target Target of the mean acceptance statistic.
+     *
+     * Dual averaging with the constants of Hoffman and Gelman,
+     * gamma = 0.05, t0 = 10 and kappa = 0.75.
+     *
+     */
+    void startAdaptation(size_t burnin, double target = NUTS_TARGET) {
+        this->adapting = true;
+        this->burnin = burnin;
+        this->target = target;
+        iteration = 0;
+        hbar = 0;
+        log_eps_bar = 0;
+        if(eps > 0) {
+            mu = std::log(10 * eps);
+        }
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief Freezes the step size at the adapted value.
+     *
+     */
+    void stopAdaptation() {
+        if(adapting && iteration > 0) {
+            eps = std::exp(log_eps_bar);
+        }
+        adapting = false;
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief Determines if the step size is adapting.
+     *
+     */
+    bool isAdapting() const {
+        return adapting;
+    }
+
+    /**
+     *
+     * @brief Sets the random streams of the momenta and of the 
+     *        trajectory.
+     * @param key Seed shared by all streams of a run.
+     * @param stream Number of the stream. The update uses the streams
+     *        2 * stream and 2 * stream + 1.
+     *
+     * Inherited from @ref mcmc_update.
+     *
+     */
+    virtual void seed(uint64_t key, uint64_t stream) {
+        gen = philox_engine(key, 2 * stream);
+        uni_gen = philox_engine(key, 2 * stream + 1);
+        dist.reset();
+    }
+
+    /**
+     *
+     * @brief The leapfrog step size, zero before the first update.
+     *
+     */
+    double stepSize() const {
+        return eps;
+    }
+
+    /**
+     *
+     * @brief Draws a new state of the parameter.
+     *
+     * Inherited from @ref mcmc_update. Either accepts the drawn state
+     * in all bonds or rejects, if the trajectory did not move.
+     *
+     */
+    virtual void update() {
+        if(par.const_val) {
+            return;
+        }
+        size_t d = par.value.size();
+        minv.resize(d);
+        for(size_t k = 0; k < d; ++k) {
+            minv[k] = par.mss[k] * par.mss[k];
+        }
+        start.q = par.value;
+        start.logp = par.proposeState(start.q, start.grad);
+        start.p.resize(d);
+        if(!(eps > 0)) {
+            initStepSize();
+        }
+        for(size_t k = 0; k < d; ++k) {
+            start.p[k] = dist(gen) / par.mss[k];
+        }
+        h0 = hamiltonian(start);
+        double logu = h0 + std::log(1 - uni_dist(uni_gen));
+        minus = start;
+        plus = start;
+        cand = start;
+        bool moved = false;
+        double n = 1;
+        tree_stats all;
+        size_t depth = 0;
+        for(bool go = true; go && depth < max_depth;) {
+            double v = uni_dist(uni_gen) < 0.5 ? -1.0 : 1.0;
+            tree_stats t;
+            buildTree(v < 0 ? minus : plus, logu, v, depth, first, drawn, t);
+            if(t.s && t.n > 0 && uni_dist(uni_gen) < t.n / n) {
+                cand.swap(drawn);
+                moved = true;
+            }
+            n += t.n;
+            all.alpha += t.alpha;
+            all.nalpha += t.nalpha;
+            divergences += t.s ? 0 : t.divergent;
+            depth += t.s ? 1 : 0;
+            go = t.s && noUturn(minus, plus);
+        }
+        if(moved) {
+            par.acceptState(cand.q);
+        } else {
+            par.rejectState();
+        }
+        double stat = all.nalpha > 0 ? all.alpha / all.nalpha : 0.0;
+        ++updates;
+        depths += depth;
+        accept_stats += stat;
+        if(adapting) {
+            adaptStepSize(stat);
+            if(++iteration >= burnin) {
+                stopAdaptation();
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief  Informs about the sampler.
+     * @return The name of the parameter, the phase, the step size and
+     *         since the last change of the phase the mean tree depth,
+     *         the mean acceptance statistic and the number of
+     *         divergent trajectories. The number of bonds
+     *         differentiated numerically, if any.
+     *
+     * The depth of a tree is the number of doublings of the
+     * trajectory the state is drawn from. A doubling whose subtree
+     * stopped, e.g. at a divergence, is not part of it.
+     *
+     */
+    virtual std::string accepted() {
+        std::ostringstream out;
+        out << par.name << " (nuts" << (adapting ? ", adapting" : "") << "): step " << eps;
+        if(updates > 0) {
+            out << ", depth " << static_cast<double>(depths) / updates
+                << ", accept " << accept_stats / updates
+                << ", divergent " << divergences;
+        }
+        if(par.numericGradients() > 0) {
+            out << ", numeric gradients " << par.numericGradients();
+        }
+
+        return out.str();
+    }
+
+private:
+
+    /**
+     *
+     * @brief A point of a trajectory: position, momentum, logged
+     *        posterior relative to the current state and its
+     *        derivatives.
+     *
+     */
+    struct phase_point {
+        phase_point() : logp(0) {};
+
+        void swap(phase_point &other) {
+            q.swap(other.q);
+            p.swap(other.p);
+            grad.swap(other.grad);
+            std::swap(logp, other.logp);
+        }
+
+        std::vector<double> q;
+        std::vector<double> p;
+        std::vector<double> grad;
+        double logp;
+    };
+
+    /**
+     *
+     * @brief Statistics of a subtree: number of points in the slice,
+     *        no U-turn nor divergence, sum and number of acceptance
+     *        statistics.
+     *
+     */
+    struct tree_stats {
+        tree_stats() : n(0), s(true), divergent(0), alpha(0), nalpha(0) {};
+
+        double n;
+        bool s;
+        size_t divergent;
+        double alpha;
+        double nalpha;
+    };
+
+    /**
+     *
+     * @brief Builds a subtree of 2^j leapfrog steps from an edge of
+     *        the trajectory.
+     * @param edge The edge, moved to the far end of the subtree.
+     * @param logu Logged slice variable.
+     * @param v Direction in time, -1 or 1.
+     * @param j Depth of the subtree.
+     * @param first Receives the point of the subtree next to the
+     *        former edge.
+     * @param chosen Receives the point drawn from the subtree.
+     * @param t Receives the statistics of the subtree.
+     *
+     * The second half of a subtree of depth j is built into %near[j]
+     * and %cands[j], at most one subtree of each depth is built at a
+     * time. The doublings of the whole trajectory use %first and
+     * %drawn.
+     *
+     */
+    void buildTree(phase_point &edge, double logu, double v, size_t j,
+        phase_point &first, phase_point &chosen, tree_stats &t) {
+        if(j == 0) {
+            leapfrog(edge, v * eps);
+            double h = hamiltonian(edge);
+            t.n = logu <= h ? 1 : 0;
+            t.s = logu < NUTS_MAX_DELTA + h;
+            t.divergent = t.s ? 0 : 1;
+            t.alpha = h - h0 < 0 ? std::exp(h - h0) : 1.0;
+            t.nalpha = 1;
+            first = edge;
+            chosen = edge;
+            return;
+        }
+        buildTree(edge, logu, v, j - 1, first, chosen, t);
+        if(!t.s) {
+            return;
+        }
+        tree_stats t2;
+        buildTree(edge, logu, v, j - 1, near[j], cands[j], t2);
+        if(t.n + t2.n > 0 && uni_dist(uni_gen) < t2.n / (t.n + t2.n)) {
+            chosen.swap(cands[j]);
+        }
+        t.n += t2.n;
+        t.alpha += t2.alpha;
+        t.nalpha += t2.nalpha;
+        t.divergent += t2.divergent;
+        t.s = t2.s && (v < 0 ? noUturn(edge, first) : noUturn(first, edge));
+    }
+
+    /**
+     *
+     * @brief One leapfrog step of the Hamiltonian dynamics.
+     * @param x The point, moved by the step.
+     * @param h The step size, negative backwards in time.
+     *
+     */
+    void leapfrog(phase_point &x, double h) {
+        for(size_t k = 0; k < x.q.size(); ++k) {
+            x.p[k] += 0.5 * h * x.grad[k];
+            x.q[k] += h * minv[k] * x.p[k];
+        }
+        x.logp = par.proposeState(x.q, x.grad);
+        for(size_t k = 0; k < x.q.size(); ++k) {
+            x.p[k] += 0.5 * h * x.grad[k];
+        }
+    }
+
+    /**
+     *
+     * @brief  The negative Hamiltonian, logged posterior minus kinetic
+     *         energy.
+     *
+     */
+    double hamiltonian(phase_point const &x) const {
+        double kin = 0;
+        for(size_t k = 0; k < x.p.size(); ++k) {
+            kin += minv[k] * x.p[k] * x.p[k];
+        }
+        double h = x.logp - 0.5 * kin;
+
+        return std::isnan(h) ? -HUGE_VAL : h;
+    }
+
+    /**
+     *
+     * @brief  Determines if the trajectory between two points has not
+     *         made a U-turn.
+     * @param  lo The earlier point.
+     * @param  hi The later point.
+     *
+     */
+    bool noUturn(phase_point const &lo, phase_point const &hi) const {
+        double dlo = 0, dhi = 0;
+        for(size_t k = 0; k < lo.q.size(); ++k) {
+            double dq = hi.q[k] - lo.q[k];
+            dlo += dq * minv[k] * lo.p[k];
+            dhi += dq * minv[k] * hi.p[k];
+        }
+
+        return dlo >= 0 && dhi >= 0;
+    }
+
+    /**
+     *
+     * @brief Finds a step size with an acceptance probability of
+     *        one leapfrog step near one half.
+     *
+     * Starts at one and doubles or halves, at most 100 times.
+     *
+     */
+    void initStepSize() {
+        eps = 1;
+        for(size_t k = 0; k < start.p.size(); ++k) {
+            start.p[k] = dist(gen) / par.mss[k];
+        }
+        double hs = hamiltonian(start);
+        phase_point x = start;
+        leapfrog(x, eps);
+        double a = hamiltonian(x) - hs > std::log(0.5) ? 1 : -1;
+        for(size_t i = 0; i < 100 && a * (hamiltonian(x) - hs) > -a * std::log(2.0); ++i) {
+            eps *= std::pow(2.0, a);
+            x = start;
+            leapfrog(x, eps);
+        }
+        mu = std::log(10 * eps);
+    }
+
+    /**
+     *
+     * @brief One step of the dual averaging of the logged step size.
+     * @param stat Mean acceptance statistic of the last trajectory.
+     *
+     */
+    void adaptStepSize(double stat) {
+        double m = iteration + 1;
+        double eta = 1 / (m + 10);
+        hbar = (1 - eta) * hbar + eta * (target - stat);
+        double log_eps = mu - std::sqrt(m) / 0.05 * hbar;
+        double w = std::pow(m, -0.75);
+        log_eps_bar = w * log_eps + (1 - w) * log_eps_bar;
+        eps = std::exp(log_eps);
+    }
+
+    /**
+     *
+     * @brief Resets the statistics reported by @ref accepted.
+     *
+     */
+    void resetStatistics() {
+        updates = 0;
+        divergences = 0;
+        depths = 0;
+        accept_stats = 0;
+    }
+
+    /**
+     *
+     * @brief The parameter, not owned.
+     *
+     */
+    mcmc_parameter &par;
+
+    /**
+     *
+     * @brief Largest number of doublings of a trajectory.
+     *
+     */
+    size_t max_depth;
+
+    /**
+     *
+     * @brief The leapfrog step size.
+     *
+     */
+    double eps;
+
+    /**
+     *
+     * @brief Determines if the step size is adapting.
+     *
+     */
+    bool adapting;
+
+    /**
+     *
+     * @brief Number of updates after which the adaptation stops.
+     *
+     */
+    size_t burnin;
+
+    /**
+     *
+     * @brief Number of updates since the adaptation started.
+     *
+     */
+    size_t iteration;
+
+    /**
+     *
+     * @brief Target of the mean acceptance statistic.
+     *
+     */
+    double target;
+
+    /**
+     *
+     * @brief Logged step size the dual averaging shrinks towards.
+     *
+     */
+    double mu;
+
+    /**
+     *
+     * @brief Running mean of target minus acceptance statistic.
+     *
+     */
+    double hbar;
+
+    /**
+     *
+     * @brief Weighted mean of the logged step sizes, the final one.
+     *
+     */
+    double log_eps_bar;
+
+    /**
+     *
+     * @brief Number of updates since the last change of the phase.
+     *
+     */
+    size_t updates;
+
+    /**
+     *
+     * @brief Number of divergent trajectories.
+     *
+     */
+    size_t divergences;
+
+    /**
+     *
+     * @brief Sum of the tree depths.
+     *
+     */
+    size_t depths;
+
+    /**
+     *
+     * @brief Sum of the mean acceptance statistics.
+     *
+     */
+    double accept_stats;
+
+    /**
+     *
+     * @brief Negative Hamiltonian at the start of the trajectory.
+     *
+     */
+    double h0;
+
+    /**
+     *
+     * @brief Inverse mass matrix, the squared step sizes.
+     *
+     */
+    std::vector<double> minv;
+
+    /**
+     *
+     * @brief Start, edges and drawn point of the trajectory.
+     *
+     */
+    phase_point start, minus, plus, cand;
+
+    /**
+     *
+     * @brief First and drawn point of the last doubling.
+     *
+     */
+    phase_point first, drawn;
+
+    /**
+     *
+     * @brief Per depth, the first point of a second half.
+     *
+     */
+    std::vector<phase_point> near;
+
+    /**
+     *
+     * @brief Per depth, the point drawn from a second half.
+     *
+     */
+    std::vector<phase_point> cands;
+
+    /**
+     *
+     * @brief Random number generator for the momenta.
+     *
+     */
+    philox_engine gen;
+
+    /**
+     *
+     * @brief Random number generator for the slice, the directions
+     *        and the draws from the trajectory.
+     *
+     */
+    philox_engine uni_gen;
+
+    /**
+     *
+     * @brief Standard normal distribution of the momenta.
+     *
+     */
+    boost::random::normal_distribution<double> dist;
+
+    /**
+     *
+     * @brief Uniform distribution on [0, 1).
+     *
+     */
+    boost::random::uniform_01<double> uni_dist;
+};
+
+#endif	/* NUTS_UPDATE_H */
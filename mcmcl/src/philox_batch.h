@@ -0,0 +1,218 @@
+/**
+ *
+ * @file philox_batch.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 29, 2012, 10:20 AM
+ *
+ * @brief Vectorized Philox draws of the proposal noise and acceptance
+ *        thresholds of a whole sweep.
+ *
+ * A sweep of a parameter draws one standard normal and one uniform per
+ * component. @ref philox_sweep computes them from one Philox4x32-10
+ * block each, addressed by the sweep and the component instead of the
+ * order of the calls: component k in sweep t is block
+ * %PHILOX_SWEEP_BASE + t 2^32 + k of the stream. The stream already
+ * identifies the chain and the parameter, see mcmc_model::seed, so
+ * every draw of a run has its own counter. Any part of a sweep can be
+ * drawn on any thread with the same result.
+ *
+ * The lanes of a vector register encrypt consecutive counters, see
+ * %philox_lanes, and turn the four words of each block into a normal
+ * by the Box-Muller transform of the first 64 and the third 32 bits and
+ * into a uniform in [0, 1) from the fourth 32 bits. Every lane
+ * computes the same instructions, so a draw does not depend on the
+ * lane it is computed in, only on the instruction set compiled for.
+ *
+ * @see philox_engine
+ * @see simd_math.h
+ *
+ */
+#ifndef PHILOX_BATCH_H
+#define	PHILOX_BATCH_H
+
+#include <stdint.h>
+#include <cstddef>
+#include "philox_engine.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief First block of the sweep draws in a stream.
+ *
+ * The blocks below are left to sequential draws of a
+ * @ref philox_engine on the same stream.
+ *
+ */
+static uint64_t const PHILOX_SWEEP_BASE = static_cast<uint64_t>(1) << 63;
+
+/**
+ *
+ * @brief Coefficients (-1)^k/(2k+1)! of the Taylor series of sin,
+ *        highest first.
+ *
+ */
+#define PHILOX_SIN_COEFFS_N 11
+static double const PHILOX_SIN_COEFFS[PHILOX_SIN_COEFFS_N] = {
+    1.0 / 51090942171709440000.0, -1.0 / 121645100408832000.0, 1.0 / 355687428096000.0,
+    -1.0 / 1307674368000.0, 1.0 / 6227020800.0, -1.0 / 39916800.0, 1.0 / 362880.0,
+    -1.0 / 5040.0, 1.0 / 120.0, -1.0 / 6.0, 1.0
+};
+
+/**
+ *
+ * @brief  Box-Muller transform, sqrt(-2 log u1) cos(2 pi u2).
+ * @param  u1 Uniform in (0, 1].
+ * @param  u2 Uniform in [0, 1).
+ *
+ * The cosine is reduced to sin(y) for |y| <= pi/2, which the series
+ * gives to double precision.
+ *
+ */
+template<class V>
+inline typename V::reg philox_box_muller(typename V::reg u1, typename V::reg u2) {
+    typename V::reg r = V::sqrt(V::mul(V::set1(-2.0), V::log(u1)));
+    /* cos(2 pi a) = -sin(2 pi (a - 1/4)) for a = |u2 - round(u2)| in [0, 1/2] */
+    typename V::reg a = V::abs(V::sub(u2, V::round(u2)));
+    typename V::reg y = V::mul(V::sub(a, V::set1(0.25)), V::set1(6.28318530717958647693));
+    typename V::reg y2 = V::mul(y, y);
+    typename V::reg p = V::set1(PHILOX_SIN_COEFFS[0]);
+    for(int k = 1; k < PHILOX_SIN_COEFFS_N; ++k) {
+        p = V::fmadd(p, y2, V::set1(PHILOX_SIN_COEFFS[k]));
+    }
+
+    return V::fnmadd(r, V::mul(y, p), V::zero());
+}
+
+/**
+ *
+ * @brief Encrypts V::width consecutive counters of a stream and turns
+ *        them into normals and uniforms.
+ *
+ * The key is passed as the 20 round keys, two per round.
+ *
+ */
+template<class V>
+struct philox_lanes;
+
+template<>
+struct philox_lanes<simd_scalar> {
+    static void draw(uint32_t const *rk, uint32_t const *s, uint64_t position, double *normals, double *uniforms) {
+        uint32_t c[4] = {static_cast<uint32_t>(position), static_cast<uint32_t>(position >> 32), s[0], s[1]};
+        uint32_t w[4];
+        /* the first round key is the key */
+        philox_engine::block(c, rk, w);
+        uint64_t m = (static_cast<uint64_t>(w[1]) << 20) | (w[0] >> 12);
+        double u1 = 1.0 - static_cast<double>(m) * (1.0 / 4503599627370496.0);
+        double u2 = w[2] * (1.0 / 4294967296.0);
+        normals[0] = philox_box_muller<simd_scalar>(u1, u2);
+        uniforms[0] = w[3] * (1.0 / 4294967296.0);
+    }
+};
+
+#if defined(__AVX2__)
+template<>
+struct philox_lanes<simd_avx2> {
+    static void draw(uint32_t const *rk, uint32_t const *s, uint64_t position, double *normals, double *uniforms) {
+        __m256i lo = _mm256_set1_epi64x(0xFFFFFFFFLL);
+        __m256i p = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(position)), _mm256_set_epi64x(3, 2, 1, 0));
+        __m256i c0 = _mm256_and_si256(p, lo);
+        __m256i c1 = _mm256_srli_epi64(p, 32);
+        __m256i c2 = _mm256_set1_epi64x(s[0]);
+        __m256i c3 = _mm256_set1_epi64x(s[1]);
+        for(int r = 0; r < 10; ++r) {
+            __m256i p0 = _mm256_mul_epu32(c0, _mm256_set1_epi64x(0xD2511F53LL));
+            __m256i p1 = _mm256_mul_epu32(c2, _mm256_set1_epi64x(0xCD9E8D57LL));
+            __m256i n0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1), _mm256_set1_epi64x(rk[2 * r]));
+            __m256i n2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3), _mm256_set1_epi64x(rk[2 * r + 1]));
+            c1 = _mm256_and_si256(p1, lo);
+            c3 = _mm256_and_si256(p0, lo);
+            c0 = n0;
+            c2 = n2;
+        }
+        /* the bits as mantissa of a double in [1, 2) */
+        __m256i one = _mm256_set1_epi64x(0x3FF0000000000000LL);
+        __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(c1, 20), _mm256_srli_epi64(c0, 12)), one));
+        __m256d u1 = _mm256_sub_pd(_mm256_set1_pd(2.0), m);
+        __m256d u2 = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_slli_epi64(c2, 20), one)), _mm256_set1_pd(1.0));
+        __m256d u3 = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_slli_epi64(c3, 20), one)), _mm256_set1_pd(1.0));
+        simd_avx2::store(normals, philox_box_muller<simd_avx2>(u1, u2));
+        simd_avx2::store(uniforms, u3);
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+template<>
+struct philox_lanes<simd_avx512> {
+    static void draw(uint32_t const *rk, uint32_t const *s, uint64_t position, double *normals, double *uniforms) {
+        __m512i lo = _mm512_set1_epi64(0xFFFFFFFFLL);
+        __m512i p = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(position)), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+        __m512i c0 = _mm512_and_si512(p, lo);
+        __m512i c1 = _mm512_srli_epi64(p, 32);
+        __m512i c2 = _mm512_set1_epi64(s[0]);
+        __m512i c3 = _mm512_set1_epi64(s[1]);
+        for(int r = 0; r < 10; ++r) {
+            __m512i p0 = _mm512_mul_epu32(c0, _mm512_set1_epi64(0xD2511F53LL));
+            __m512i p1 = _mm512_mul_epu32(c2, _mm512_set1_epi64(0xCD9E8D57LL));
+            __m512i n0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(p1, 32), c1), _mm512_set1_epi64(rk[2 * r]));
+            __m512i n2 = _mm512_xor_si512(_mm512_xor_si512(_mm512_srli_epi64(p0, 32), c3), _mm512_set1_epi64(rk[2 * r + 1]));
+            c1 = _mm512_and_si512(p1, lo);
+            c3 = _mm512_and_si512(p0, lo);
+            c0 = n0;
+            c2 = n2;
+        }
+        __m512i one = _mm512_set1_epi64(0x3FF0000000000000LL);
+        __m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_or_si512(_mm512_slli_epi64(c1, 20), _mm512_srli_epi64(c0, 12)), one));
+        __m512d u1 = _mm512_sub_pd(_mm512_set1_pd(2.0), m);
+        __m512d u2 = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_slli_epi64(c2, 20), one)), _mm512_set1_pd(1.0));
+        __m512d u3 = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_slli_epi64(c3, 20), one)), _mm512_set1_pd(1.0));
+        simd_avx512::store(normals, philox_box_muller<simd_avx512>(u1, u2));
+        simd_avx512::store(uniforms, u3);
+    }
+};
+#endif
+
+/**
+ *
+ * @brief Draws the normals and uniforms of a range of components in
+ *        a sweep.
+ * @param key Seed shared by all streams of a run.
+ * @param stream Number of the stream.
+ * @param sweep Number of the sweep, below 2^31.
+ * @param first First component, the range has to stay below 2^32.
+ * @param count Number of components.
+ * @param normals Receives %count standard normals.
+ * @param uniforms Receives %count uniforms in [0, 1).
+ *
+ * Uses the native instruction set, a last partial register is
+ * computed in full and stored in part.
+ *
+ */
+inline void philox_sweep(uint64_t key, uint64_t stream, uint64_t sweep, size_t first, size_t count,
+    double *normals, double *uniforms) {
+    uint32_t rk[20];
+    uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+    for(int r = 0; r < 10; ++r) {
+        rk[2 * r] = k0;
+        rk[2 * r + 1] = k1;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    uint32_t s[2] = {static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+    uint64_t base = PHILOX_SWEEP_BASE + (sweep << 32) + first;
+    size_t i = 0;
+    for(; i + simd_native::width <= count; i += simd_native::width) {
+        philox_lanes<simd_native>::draw(rk, s, base + i, normals + i, uniforms + i);
+    }
+    if(i < count) {
+        double z[simd_native::width], u[simd_native::width];
+        philox_lanes<simd_native>::draw(rk, s, base + i, z, u);
+        for(size_t j = 0; i + j < count; ++j) {
+            normals[i + j] = z[j];
+            uniforms[i + j] = u[j];
+        }
+    }
+}
+
+#endif	/* PHILOX_BATCH_H */
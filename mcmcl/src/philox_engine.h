@@ -0,0 +1,161 @@
+/**
+ *
+ * @file philox_engine.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 25, 2012, 9:40 AM
+ *
+ * @brief Counter-based random number engine Philox4x32-10.
+ *
+ * The %philox_engine encrypts a 128-bit counter with a 64-bit key in
+ * ten rounds of the Philox bijection (Salmon, Moraes, Dror and Shaw,
+ * 2011) and returns the four 32-bit words of each block. The upper
+ * half of the counter is the number of the stream, the lower half the
+ * position in it. Since the map is a bijection for a fixed key, two
+ * streams with different numbers never share a block: they are
+ * disjoint parts of one sequence of period 2^130, each of length
+ * 2^66 words. No state is shared, a stream is constructed in constant
+ * time from its number.
+ *
+ * The class fulfills the requirements of a uniform random number
+ * generator of boost random, e.g. for
+ * boost::random::normal_distribution.
+ *
+ * @see mcmc_update::seed
+ *
+ */
+#ifndef PHILOX_ENGINE_H
+#define	PHILOX_ENGINE_H
+
+#include <stdint.h>
+
+class philox_engine {
+public:
+
+    typedef uint32_t result_type;
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param key Seed shared by all streams of a run.
+     * @param stream Number of the stream.
+     *
+     */
+    explicit philox_engine(uint64_t key = 0, uint64_t stream = 0) : position(0), next(4) {
+        k[0] = static_cast<uint32_t>(key);
+        k[1] = static_cast<uint32_t>(key >> 32);
+        s[0] = static_cast<uint32_t>(stream);
+        s[1] = static_cast<uint32_t>(stream >> 32);
+    };
+
+    /**
+     *
+     * @brief Returns the next word of the stream.
+     *
+     */
+    result_type operator()() {
+        if(next == 4) {
+            uint32_t ctr[4] = {static_cast<uint32_t>(position), static_cast<uint32_t>(position >> 32), s[0], s[1]};
+            block(ctr, k, out);
+            ++position;
+            next = 0;
+        }
+
+        return out[next++];
+    }
+
+    /**
+     *
+     * @brief Skips n words in constant time.
+     *
+     */
+    void discard(uint64_t n) {
+        uint64_t pending = next == 4 ? 0 : 4 - next;
+        if(n < pending) {
+            next += static_cast<int>(n);
+            return;
+        }
+        n -= pending;
+        position += n / 4;
+        next = 4;
+        for(uint64_t i = 0; i < n % 4; ++i) {
+            (*this)();
+        }
+    }
+
+    static result_type min() {
+        return 0;
+    }
+
+    static result_type max() {
+        return 0xFFFFFFFFu;
+    }
+
+    /**
+     *
+     * @brief Encrypts one counter.
+     * @param ctr The counter, four words.
+     * @param key The key, two words.
+     * @param out Receives the four words of the block.
+     *
+     */
+    static void block(uint32_t const *ctr, uint32_t const *key, uint32_t *out) {
+        uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+        uint32_t k0 = key[0], k1 = key[1];
+        for(int r = 0; r < 10; ++r) {
+            uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+            uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+            uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+private:
+
+    /**
+     *
+     * @brief The key.
+     *
+     */
+    uint32_t k[2];
+
+    /**
+     *
+     * @brief Number of the stream, the upper half of the counter.
+     *
+     */
+    uint32_t s[2];
+
+    /**
+     *
+     * @brief Number of the next block, the lower half of the counter.
+     *
+     */
+    uint64_t position;
+
+    /**
+     *
+     * @brief Index of the next word in %out, four if used up.
+     *
+     */
+    int next;
+
+    /**
+     *
+     * @brief The current block.
+     *
+     */
+    uint32_t out[4];
+};
+
+#endif	/* PHILOX_ENGINE_H */
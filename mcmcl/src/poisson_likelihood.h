@@ -0,0 +1,179 @@
+/**
+ *
+ * @file poisson_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 12, 2012, 10:40 AM
+ *
+ * @brief Log-probability of the Poisson distribution.
+ *
+ * Columns: counts y and rates lambda.
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef POISSON_LIKELIHOOD_H
+#define	POISSON_LIKELIHOOD_H
+
+#include <cmath>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Poisson log-probability kernel for the instruction set V,
+ *        without the log(y!) term.
+ *
+ */
+template<class V>
+class poisson_kernel {
+public:
+
+    poisson_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), lambda(args[1]),
+    log_lambda(V::set1(lambda.scalar ? std::log(args[1][0]) : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg l = lambda.scalar ? log_lambda : V::log(lambda(i));
+
+        return V::fmadd(y(i), l, V::sub(V::zero(), lambda(i)));
+    }
+
+    simd_column<V> y, lambda;
+    typename V::reg log_lambda;
+};
+
+class poisson_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Constructor.
+     * @param normalized If false, the term log(y!), which depends on
+     *        the data only, is left out. Differences of bond values
+     *        are not affected by this.
+     *
+     */
+    poisson_likelihood (bool normalized = true) : normalized(normalized) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~poisson_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y and lambda.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y and lambda.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        double sum = simd_sum<poisson_kernel>(args);
+        if(normalized) {
+            for(size_t i = 0; i < args[0].size(); ++i) {
+                sum -= log_factorial(args[0][i]);
+            }
+        }
+
+        return sum;
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-probability of a single observation.
+     * @param row y and lambda of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        return row[0] * std::log(row[1]) - row[1] - (normalized ? log_factorial(row[0]) : 0.0);
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y and lambda.
+     * @param grad Derivatives with respect to y and lambda. The 
+     *        counts are discrete, their derivative is set to zero.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            if(grad[0]) {
+                grad[0][i] = 0;
+            }
+            if(grad[1]) {
+                grad[1][i] = args[0][i] / args[1][i] - 1;
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief The rates are conjugate.
+     *
+     */
+    virtual bool isConjugate (size_t arg) const {
+        return arg == 1;
+    };
+
+    /**
+     *
+     * @brief Computes the coefficients of the sufficient statistics.
+     * @param args Views on y and lambda.
+     * @param arg Index of the argument, one.
+     * @param stats Coefficients of x, x^2, log x and x^(-2).
+     *
+     * In lambda a term is y log lambda - lambda.
+     *
+     */
+    virtual void sufficientStatistics (std::vector<argument_view> const &args, size_t arg,
+        std::vector<double*> const &stats) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            stats[0][i] = -1;
+            stats[1][i] = 0;
+            stats[2][i] = args[0][i];
+            stats[3][i] = 0;
+        }
+    };
+
+    /**
+     *
+     * @brief Determines if log(y!) is included.
+     *
+     */
+    bool normalized;
+};
+#endif	/* POISSON_LIKELIHOOD_H */
+
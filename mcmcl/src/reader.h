@@ -1,4 +1,4 @@
-/* 
+/*
  * File:   Reader.h
  * Author: simonzehnder
  *
@@ -7,18 +7,184 @@
 #ifndef READER_H
 #define	READER_H
 
+#include <string>
+#include <vector>
 
 using namespace std;
 
+/**
+ *
+ * @brief Named columns of numbers read from a file.
+ *
+ * Every column holds one entry per row, missing entries are NaN.
+ *
+ */
+struct column_table {
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    size_t rows() const {
+        return columns.empty() ? 0 : columns[0].size();
+    }
+
+    /**
+     *
+     * @brief  Index of the column with a name.
+     * @return The index, or the number of columns if there is none.
+     *
+     */
+    size_t find(std::string const &name) const {
+        size_t k = 0;
+        while(k < names.size() && names[k] != name) {
+            ++k;
+        }
+
+        return k;
+    }
+
+    /**
+     *
+     * @brief The names of the columns.
+     *
+     */
+    std::vector<std::string> names;
+
+    /**
+     *
+     * @brief The columns.
+     *
+     */
+    std::vector<std::vector<double> > columns;
+};
+
 class reader {
 public:
-    
+
     virtual ~reader(){};
-    //numa_vector<numa_vector<Datatype>* > 
+    //numa_vector<numa_vector<Datatype>* >
     virtual void read(string& path){};
-    
-    
+
+    /**
+     *
+     * @brief  Reads a file into named columns.
+     * @param  path Path of the file.
+     * @param  table Receives the columns.
+     * @return True, if the file has been read. Otherwise @ref error
+     *         tells why and %table is empty.
+     *
+     */
+    virtual bool read(std::string const &path, column_table &table) {
+        table = column_table();
+        message = "reading is not implemented";
+
+        return false;
+    };
+
+    /**
+     *
+     * @brief Why the last read failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+protected:
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
 };
 
-#endif	/* READER_H */
+/**
+ *
+ * @brief Source of the rows of named columns, read a range at a time.
+ *
+ * For data that is not held in memory as a whole, see
+ * streaming_bond. Ranges can be read in any order, calls do not share
+ * a position and report their errors to the caller, such that copies
+ * of a model can read the same source from their own threads.
+ *
+ */
+class chunk_reader {
+public:
+
+    virtual ~chunk_reader() {};
+
+    /**
+     *
+     * @brief Number of rows.
+     *
+     */
+    virtual size_t rows() const = 0;
+
+    /**
+     *
+     * @brief Number of columns.
+     *
+     */
+    virtual size_t numColumns() const = 0;
+
+    /**
+     *
+     * @brief The name of column k.
+     *
+     */
+    virtual std::string const &name(size_t k) const = 0;
 
+    /**
+     *
+     * @brief  Reads a range of rows of a column.
+     * @param  k Index of the column.
+     * @param  first Index of the first row.
+     * @param  count Number of rows.
+     * @param  out Receives the %count entries.
+     * @param  message Receives why the rows could not be read.
+     * @return True, if the rows have been read.
+     *
+     * Safe to call from several threads at once.
+     *
+     */
+    virtual bool readRows(size_t k, size_t first, size_t count, double *out, std::string &message) const = 0;
+
+    /**
+     *
+     * @brief  Index of the column with a name.
+     * @return The index, or the number of columns if there is none.
+     *
+     */
+    size_t find(std::string const &name) const {
+        size_t k = 0;
+        while(k < numColumns() && this->name(k) != name) {
+            ++k;
+        }
+
+        return k;
+    }
+
+    /**
+     *
+     * @brief Why opening the source failed.
+     *
+     */
+    std::string const &error() const {
+        return message;
+    }
+
+protected:
+
+    /**
+     *
+     * @brief Message of the last error of opening the source.
+     *
+     */
+    std::string message;
+};
+
+#endif	/* READER_H */
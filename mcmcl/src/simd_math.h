@@ -0,0 +1,434 @@
+/**
+ *
+ * @file simd_math.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 11, 2012, 9:30 AM
+ *
+ * @brief Vectorized arithmetic and elementary functions for the
+ *        built-in log-densities.
+ *
+ * Each instruction set is described by a struct with the same static
+ * interface: a register type, its width and the operations used by
+ * the density kernels, including log and exp. %simd_scalar works on
+ * plain doubles and is always available, %simd_avx2 and %simd_avx512
+ * are compiled if the compiler targets these instruction sets.
+ * %simd_native is the widest available one.
+ *
+ * A density kernel is a class template over the instruction set that
+ * returns the log-density of the terms [i, i + width) from its call
+ * operator. @ref simd_sum runs a kernel over all terms with the native
+ * instruction set and finishes the tail with the scalar one.
+ *
+ * The vectorized log expects positive normal numbers and maps zero to
+ * -inf and negative numbers to NaN. The vectorized exp saturates below
+ * -708 and above 709.
+ *
+ * @see normal_likelihood
+ *
+ */
+#ifndef SIMD_MATH_H
+#define	SIMD_MATH_H
+
+#include <cmath>
+#include <vector>
+#include "argument_view.h"
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/**
+ *
+ * @brief Coefficients 1/(2k+1) of the series
+ *        log((1+s)/(1-s)) = 2s(1 + s^2/3 + s^4/5 + ...).
+ *
+ */
+#define SIMD_LOG_COEFFS_N 10
+static double const SIMD_LOG_COEFFS[SIMD_LOG_COEFFS_N] = {
+    1.0 / 21, 1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13,
+    1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3
+};
+
+/**
+ *
+ * @brief Coefficients 1/k! of the Taylor series of exp, highest first.
+ *
+ */
+#define SIMD_EXP_COEFFS_N 13
+static double const SIMD_EXP_COEFFS[SIMD_EXP_COEFFS_N] = {
+    1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880,
+    1.0 / 40320, 1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24,
+    1.0 / 6, 1.0 / 2, 1.0, 1.0
+};
+
+/**
+ *
+ * @brief Columns are prefetched if all arguments together exceed this
+ *        size in bytes, i.e. do not fit into a typical L2 cache.
+ *
+ */
+static size_t const SIMD_PREFETCH_BYTES = 256 * 1024;
+
+/**
+ *
+ * @brief Distance in doubles the columns are prefetched ahead.
+ *
+ */
+static size_t const SIMD_PREFETCH_DISTANCE = 128;
+
+static double const SIMD_LN2_HI = 6.93147180369123816490e-01;
+static double const SIMD_LN2_LO = 1.90821492927058770002e-10;
+static double const SIMD_LOG2E = 1.44269504088896338700e+00;
+static double const SIMD_SQRT2 = 1.41421356237309504880e+00;
+
+/**
+ *
+ * @brief  Evaluates log(m) * 1 + e * log(2) for a mantissa m in
+ *         [sqrt(1/2), sqrt(2)) and an exponent e.
+ *
+ * Shared by all instruction sets, which only differ in how they split
+ * the argument into mantissa and exponent.
+ *
+ */
+template<class V>
+inline typename V::reg simd_log_reduced(typename V::reg m, typename V::reg e) {
+    typename V::reg f = V::sub(m, V::set1(1.0));
+    typename V::reg s = V::div(f, V::add(f, V::set1(2.0)));
+    typename V::reg z = V::mul(s, s);
+    typename V::reg p = V::set1(SIMD_LOG_COEFFS[0]);
+    for(int k = 1; k < SIMD_LOG_COEFFS_N; ++k) {
+        p = V::fmadd(p, z, V::set1(SIMD_LOG_COEFFS[k]));
+    }
+    /* log(m) = 2s + 2s * z * p */
+    typename V::reg s2 = V::add(s, s);
+    typename V::reg lm = V::fmadd(V::mul(s2, z), p, s2);
+
+    return V::fmadd(e, V::set1(SIMD_LN2_HI), V::fmadd(e, V::set1(SIMD_LN2_LO), lm));
+}
+
+/**
+ *
+ * @brief  Evaluates exp(r) for |r| <= log(2)/2 and the rounded
+ *         multiple n of log(2) the argument was reduced by.
+ *
+ */
+template<class V>
+inline typename V::reg simd_exp_reduced(typename V::reg x, typename V::reg &n) {
+    n = V::round(V::mul(x, V::set1(SIMD_LOG2E)));
+    typename V::reg r = V::fnmadd(n, V::set1(SIMD_LN2_HI), x);
+    r = V::fnmadd(n, V::set1(SIMD_LN2_LO), r);
+    typename V::reg p = V::set1(SIMD_EXP_COEFFS[0]);
+    for(int k = 1; k < SIMD_EXP_COEFFS_N; ++k) {
+        p = V::fmadd(p, r, V::set1(SIMD_EXP_COEFFS[k]));
+    }
+
+    return p;
+}
+
+/**
+ *
+ * @brief Scalar instruction set, used for the tails of the vector
+ *        loops and if no vector instruction set is available.
+ *
+ */
+struct simd_scalar {
+    typedef double reg;
+    static size_t const width = 1;
+
+    static reg load(double const *p) {return *p;}
+    static void store(double *p, reg a) {*p = a;}
+    static reg set1(double x) {return x;}
+    static reg zero() {return 0.0;}
+    static reg add(reg a, reg b) {return a + b;}
+    static reg sub(reg a, reg b) {return a - b;}
+    static reg mul(reg a, reg b) {return a * b;}
+    static reg div(reg a, reg b) {return a / b;}
+    static reg fmadd(reg a, reg b, reg c) {return a * b + c;}
+    static reg fnmadd(reg a, reg b, reg c) {return c - a * b;}
+    static reg max(reg a, reg b) {return a > b ? a : b;}
+    static reg abs(reg a) {return std::fabs(a);}
+    static reg round(reg a) {return std::floor(a + 0.5);}
+    static reg sqrt(reg a) {return std::sqrt(a);}
+    static reg log(reg a) {return std::log(a);}
+    static reg log1p(reg a) {return std::log1p(a);}
+    static reg exp(reg a) {return std::exp(a);}
+    static double sum(reg a) {return a;}
+};
+
+#if defined(__AVX2__)
+/**
+ *
+ * @brief AVX2 instruction set, four doubles per register.
+ *
+ */
+struct simd_avx2 {
+    typedef __m256d reg;
+    static size_t const width = 4;
+
+    static reg load(double const *p) {return _mm256_loadu_pd(p);}
+    static void store(double *p, reg a) {_mm256_storeu_pd(p, a);}
+    static reg set1(double x) {return _mm256_set1_pd(x);}
+    static reg zero() {return _mm256_setzero_pd();}
+    static reg add(reg a, reg b) {return _mm256_add_pd(a, b);}
+    static reg sub(reg a, reg b) {return _mm256_sub_pd(a, b);}
+    static reg mul(reg a, reg b) {return _mm256_mul_pd(a, b);}
+    static reg div(reg a, reg b) {return _mm256_div_pd(a, b);}
+#if defined(__FMA__)
+    static reg fmadd(reg a, reg b, reg c) {return _mm256_fmadd_pd(a, b, c);}
+    static reg fnmadd(reg a, reg b, reg c) {return _mm256_fnmadd_pd(a, b, c);}
+#else
+    static reg fmadd(reg a, reg b, reg c) {return _mm256_add_pd(_mm256_mul_pd(a, b), c);}
+    static reg fnmadd(reg a, reg b, reg c) {return _mm256_sub_pd(c, _mm256_mul_pd(a, b));}
+#endif
+    static reg max(reg a, reg b) {return _mm256_max_pd(a, b);}
+    static reg abs(reg a) {return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);}
+    static reg round(reg a) {return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);}
+    static reg sqrt(reg a) {return _mm256_sqrt_pd(a);}
+
+    static reg log(reg x) {
+        __m256i bits = _mm256_castpd_si256(x);
+        __m256i ebits = _mm256_srli_epi64(bits, 52);
+        /* exponent to double: 2^52 + e as bit pattern minus 2^52 */
+        reg e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(ebits, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)))),
+            _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        reg m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+            _mm256_set1_epi64x(0x3FF0000000000000LL)));
+        reg big = _mm256_cmp_pd(m, _mm256_set1_pd(SIMD_SQRT2), _CMP_GT_OQ);
+        m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+        e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+        reg res = simd_log_reduced<simd_avx2>(m, e);
+        res = _mm256_blendv_pd(res, _mm256_set1_pd(-HUGE_VAL), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ));
+        res = _mm256_blendv_pd(res, _mm256_set1_pd(NAN), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_NGE_UQ));
+
+        return _mm256_blendv_pd(res, x, _mm256_cmp_pd(x, _mm256_set1_pd(HUGE_VAL), _CMP_EQ_OQ));
+    }
+
+    static reg log1p(reg x) {
+        /* log(1 + x) corrected by the rounding error of 1 + x */
+        reg u = _mm256_add_pd(_mm256_set1_pd(1.0), x);
+        reg c = _mm256_div_pd(_mm256_sub_pd(x, _mm256_sub_pd(u, _mm256_set1_pd(1.0))), u);
+
+        return _mm256_add_pd(log(u), c);
+    }
+
+    static reg exp(reg x) {
+        x = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(709.0)), _mm256_set1_pd(-708.0));
+        reg n;
+        reg p = simd_exp_reduced<simd_avx2>(x, n);
+        /* 2^n: n + 1.5 * 2^52 holds n in its low mantissa bits */
+        __m256i ni = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0))),
+            _mm256_castpd_si256(_mm256_set1_pd(6755399441055744.0)));
+        __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(ni, _mm256_set1_epi64x(1023)), 52);
+
+        return _mm256_mul_pd(p, _mm256_castsi256_pd(scale));
+    }
+
+    static double sum(reg a) {
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+/**
+ *
+ * @brief AVX-512 instruction set, eight doubles per register.
+ *
+ */
+struct simd_avx512 {
+    typedef __m512d reg;
+    static size_t const width = 8;
+
+    static reg load(double const *p) {return _mm512_loadu_pd(p);}
+    static void store(double *p, reg a) {_mm512_storeu_pd(p, a);}
+    static reg set1(double x) {return _mm512_set1_pd(x);}
+    static reg zero() {return _mm512_setzero_pd();}
+    static reg add(reg a, reg b) {return _mm512_add_pd(a, b);}
+    static reg sub(reg a, reg b) {return _mm512_sub_pd(a, b);}
+    static reg mul(reg a, reg b) {return _mm512_mul_pd(a, b);}
+    static reg div(reg a, reg b) {return _mm512_div_pd(a, b);}
+    static reg fmadd(reg a, reg b, reg c) {return _mm512_fmadd_pd(a, b, c);}
+    static reg fnmadd(reg a, reg b, reg c) {return _mm512_fnmadd_pd(a, b, c);}
+    static reg max(reg a, reg b) {return _mm512_max_pd(a, b);}
+    static reg abs(reg a) {return _mm512_abs_pd(a);}
+    static reg round(reg a) {return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);}
+    static reg sqrt(reg a) {return _mm512_sqrt_pd(a);}
+
+    static reg log(reg x) {
+        reg m = _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+        reg e = _mm512_getexp_pd(x);
+        __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(SIMD_SQRT2), _CMP_GT_OQ);
+        m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+        e = _mm512_mask_add_pd(e, big, e, _mm512_set1_pd(1.0));
+        reg res = simd_log_reduced<simd_avx512>(m, e);
+        res = _mm512_mask_mov_pd(res, _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_EQ_OQ), _mm512_set1_pd(-HUGE_VAL));
+        res = _mm512_mask_mov_pd(res, _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_NGE_UQ), _mm512_set1_pd(NAN));
+
+        return _mm512_mask_mov_pd(res, _mm512_cmp_pd_mask(x, _mm512_set1_pd(HUGE_VAL), _CMP_EQ_OQ), x);
+    }
+
+    static reg log1p(reg x) {
+        reg u = _mm512_add_pd(_mm512_set1_pd(1.0), x);
+        reg c = _mm512_div_pd(_mm512_sub_pd(x, _mm512_sub_pd(u, _mm512_set1_pd(1.0))), u);
+
+        return _mm512_add_pd(log(u), c);
+    }
+
+    static reg exp(reg x) {
+        x = _mm512_max_pd(_mm512_min_pd(x, _mm512_set1_pd(709.0)), _mm512_set1_pd(-708.0));
+        reg n;
+        reg p = simd_exp_reduced<simd_avx512>(x, n);
+
+        return _mm512_scalef_pd(p, n);
+    }
+
+    static double sum(reg a) {return _mm512_reduce_add_pd(a);}
+};
+#endif
+
+#if defined(__AVX512F__)
+typedef simd_avx512 simd_native;
+#elif defined(__AVX2__)
+typedef simd_avx2 simd_native;
+#else
+typedef simd_scalar simd_native;
+#endif
+
+/**
+ *
+ * @brief Reads an @ref argument_view register by register.
+ *
+ * Broadcast views are loaded once at construction. Vector
+ * instruction sets require unit stride, the scalar one takes any.
+ *
+ */
+template<class V>
+class simd_column {
+public:
+
+    simd_column(argument_view const &view) :
+    data(view.data), stride(view.stride), scalar(view.isScalar()),
+    value(V::set1(view.isScalar() ? view.data[0] : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        if(scalar) {
+            return value;
+        }
+        return V::width == 1 ? V::load(data + i * stride) : V::load(data + i);
+    }
+
+    double const *data;
+    size_t stride;
+    bool scalar;
+    typename V::reg value;
+};
+
+/**
+ *
+ * @brief Prefetches the cache lines holding the entries [i, i + count)
+ *        of every unit-stride view.
+ *
+ */
+inline void simd_prefetch(std::vector<argument_view> const &args, size_t i, size_t count) {
+#if defined(__GNUC__)
+    for(size_t k = 0; k < args.size(); ++k) {
+        if(args[k].stride == 1) {
+            for(size_t j = 0; j < count; j += 8) {
+                __builtin_prefetch(args[k].data + i + j);
+            }
+        }
+    }
+#endif
+}
+
+/**
+ *
+ * @brief  Runs a density kernel over all terms.
+ * @param  args Views on the arguments.
+ * @return Sum of the log-densities of all terms.
+ *
+ * The kernel template is instantiated for the native and the scalar
+ * instruction set. Views with a stride other than zero or one are
+ * evaluated with the scalar instruction set only. If the arguments
+ * do not fit into L2, the columns are prefetched ahead of the loop.
+ *
+ */
+template<template<class> class Kernel>
+double simd_sum(std::vector<argument_view> const &args) {
+    size_t n = 0;
+    bool unit = true;
+    for(size_t k = 0; k < args.size(); ++k) {
+        n = args[k].size() > n ? args[k].size() : n;
+        unit = unit && args[k].stride <= 1;
+    }
+    size_t i = 0;
+    double sum = 0;
+    if(unit && simd_native::width > 1) {
+        Kernel<simd_native> kernel(args);
+        typename simd_native::reg acc0 = simd_native::zero();
+        typename simd_native::reg acc1 = simd_native::zero();
+        bool prefetch = n * args.size() * sizeof(double) > SIMD_PREFETCH_BYTES;
+        for(; i + 2 * simd_native::width <= n; i += 2 * simd_native::width) {
+            if(prefetch) {
+                simd_prefetch(args, i + SIMD_PREFETCH_DISTANCE, 2 * simd_native::width);
+            }
+            acc0 = simd_native::add(acc0, kernel(i));
+            acc1 = simd_native::add(acc1, kernel(i + simd_native::width));
+        }
+        for(; i + simd_native::width <= n; i += simd_native::width) {
+            acc0 = simd_native::add(acc0, kernel(i));
+        }
+        sum = simd_native::sum(simd_native::add(acc0, acc1));
+    }
+    Kernel<simd_scalar> tail(args);
+    for(; i < n; ++i) {
+        sum += tail(i);
+    }
+
+    return sum;
+}
+
+/**
+ *
+ * @brief  Computes log(k!) for a non-negative integer k.
+ *
+ * Small values are looked up in a table, larger ones are computed
+ * through lgamma.
+ *
+ */
+inline double log_factorial(double k) {
+    static std::vector<double> const table = [] {
+        std::vector<double> t(256, 0.0);
+        for(size_t j = 2; j < t.size(); ++j) {
+            t[j] = t[j - 1] + std::log((double) j);
+        }
+        return t;
+    }();
+    if(k >= 0 && k < table.size() && k == (double) (size_t) k) {
+        return table[(size_t) k];
+    }
+    return std::lgamma(k + 1.0);
+}
+
+/**
+ *
+ * @brief  Sums lgamma over a view.
+ *
+ * A broadcast scalar is evaluated only once.
+ *
+ */
+inline double sum_lgamma(argument_view const &view, size_t n) {
+    if(view.isScalar()) {
+        return n * std::lgamma(view[0]);
+    }
+    double sum = 0;
+    for(size_t i = 0; i < n; ++i) {
+        sum += std::lgamma(view[i]);
+    }
+
+    return sum;
+}
+
+#endif	/* SIMD_MATH_H */
+
@@ -0,0 +1,468 @@
+/**
+ *
+ * @file slice_update.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 27, 2012, 9:15 AM
+ *
+ * @brief Slice sampling update of a parameter.
+ *
+ * The %slice_update draws a level under the posterior density at the
+ * current value and moves to a uniform point of the slice above the
+ * level (Neal, 2003). It accepts every move, there is no step size to
+ * tune: the width only determines how many evaluations it takes to
+ * find the slice.
+ *
+ * In the univariate mode each component is updated in turn. An
+ * interval of the width w is placed randomly around the value and
+ * stepped out by w until both ends are outside the slice, at most
+ * %SLICE_MAX_STEPS times. Points are drawn from the interval, which
+ * shrinks towards the value after each point outside the slice. In
+ * the hyper-rectangle mode all components move jointly: the rectangle
+ * with the widths as sides is placed randomly around the value and
+ * shrunk coordinatewise, without stepping out.
+ *
+ * The widths start at the step sizes of the parameter and, during the
+ * burn-in, follow %SLICE_WIDTH_SCALE standard deviations of each
+ * component. States outside the support have a logged posterior of
+ * minus infinity or NaN and are never in a slice, so bounded
+ * parameters need no transformation.
+ *
+ * Every point costs one evaluation of all bonds of the parameter, see
+ * mcmc_parameter::proposeCoordinates, counted as in
+ * mcmc_parameter::evaluations, and so comparable to the random walk.
+ *
+ * Example:
+ * @code
+ * slice_update slice(model.parameter(sigma));
+ * slice.startAdaptation(500);
+ * model.setUpdate(sigma, &slice);
+ * @endcode
+ *
+ * @see mcmc_parameter
+ * @see nuts_update
+ *
+ */
+#ifndef SLICE_UPDATE_H
+#define	SLICE_UPDATE_H
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/random/uniform_01.hpp>
+#include "mcmc_update.h"
+#include "mcmc_parameter.h"
+#include "philox_engine.h"
+
+/**
+ *
+ * @brief Largest number of steps of the stepping out, on both sides
+ *        together.
+ *
+ */
+static size_t const SLICE_MAX_STEPS = 100;
+
+/**
+ *
+ * @brief Relative length of the interval at which the shrinkage gives
+ *        up and the value is kept.
+ *
+ */
+static double const SLICE_MIN_WIDTH = 1e-12;
+
+/**
+ *
+ * @brief Width relative to the standard deviation of a component.
+ *
+ */
+static double const SLICE_WIDTH_SCALE = 3;
+
+/**
+ *
+ * @brief Number of adapted updates before the widths change.
+ *
+ */
+static size_t const SLICE_ADAPT_MIN = 10;
+
+class slice_update : public mcmc_update {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param par The parameter, referenced. Has to outlive the update.
+     * @param rectangle Determines if all components move jointly in
+     *        a hyper-rectangle, instead of one by one.
+     *
+     */
+    slice_update(mcmc_parameter &par, bool rectangle = false) : par(par), rectangle(rectangle),
+    adapting(false), burnin(0), iteration(0), updates(0), evals(0), last_evals(0), gen(0, 0) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    virtual ~slice_update() {};
+
+    /**
+     *
+     * @brief Starts the adaptation of the widths.
+     * @param burnin Number of updates after which the widths are
+     *        frozen.
+     *
+     */
+    void startAdaptation(size_t burnin) {
+        adapting = true;
+        this->burnin = burnin;
+        iteration = 0;
+        means.assign(par.value.size(), 0.0);
+        squares.assign(par.value.size(), 0.0);
+        moves = 0;
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief Freezes the widths.
+     *
+     */
+    void stopAdaptation() {
+        adapting = false;
+        resetStatistics();
+    }
+
+    /**
+     *
+     * @brief Sets the random stream of the update.
+     * @param key Seed shared by all streams of a run.
+     * @param stream Number of the stream.
+     *
+     * Inherited from @ref mcmc_update.
+     *
+     */
+    virtual void seed(uint64_t key, uint64_t stream) {
+        gen = philox_engine(key, 2 * stream);
+    }
+
+    /**
+     *
+     * @brief Moves the parameter to a point of the slice.
+     *
+     * Inherited from @ref mcmc_update.
+     *
+     */
+    virtual void update() {
+        if(par.const_val) {
+            return;
+        }
+        size_t before = par.evaluations();
+        if(widths.size() != par.value.size()) {
+            widths.resize(par.value.size());
+            for(size_t k = 0; k < widths.size(); ++k) {
+                widths[k] = par.mss[k] > 0 ? par.mss[k] : 1.0;
+            }
+        }
+        old = par.value;
+        if(rectangle) {
+            updateRectangle();
+        } else {
+            for(size_t k = 0; k < par.value.size(); ++k) {
+                updateCoordinate(k);
+            }
+        }
+        last_evals = par.evaluations() - before;
+        evals += last_evals;
+        ++updates;
+        if(adapting) {
+            adaptWidths();
+            if(++iteration >= burnin) {
+                stopAdaptation();
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Number of bond evaluations of the last update.
+     *
+     */
+    size_t lastEvaluations() const {
+        return last_evals;
+    }
+
+    /**
+     *
+     * @brief  Mean number of bond evaluations per update since the
+     *         last change of the phase.
+     *
+     */
+    double meanEvaluations() const {
+        return updates > 0 ? static_cast<double>(evals) / updates : 0.0;
+    }
+
+    /**
+     *
+     * @brief The widths of the components.
+     *
+     */
+    std::vector<double> const &getWidths() const {
+        return widths;
+    }
+
+    /**
+     *
+     * @brief  Informs about the sampler.
+     * @return The name of the parameter, the phase, the mean number of
+     *         bond evaluations per update and the widths.
+     *
+     */
+    virtual std::string accepted() {
+        std::ostringstream out;
+        out << par.name << " (slice" << (rectangle ? ", rectangle" : "") << (adapting ? ", adapting" : "")
+            << "): evaluations " << meanEvaluations() << ", widths";
+        for(size_t k = 0; k < widths.size(); ++k) {
+            out << " " << widths[k];
+        }
+
+        return out.str();
+    }
+
+private:
+
+    /**
+     *
+     * @brief  Logged posterior at a candidate for a component, relative
+     *         to the current value.
+     *
+     */
+    double logDensity(size_t k, double x) {
+        coord.assign(1, k);
+        cand.assign(1, x);
+
+        return par.proposeCoordinates(coord, cand);
+    }
+
+    /**
+     *
+     * @brief Univariate slice sampling of component k with stepping
+     *        out and shrinkage.
+     *
+     */
+    void updateCoordinate(size_t k) {
+        double x0 = par.value[k];
+        double w = widths[k];
+        double logy = std::log(1 - uni_dist(gen));
+        double lo = x0 - w * uni_dist(gen);
+        double hi = lo + w;
+        size_t left = static_cast<size_t>(SLICE_MAX_STEPS * uni_dist(gen));
+        size_t right = SLICE_MAX_STEPS - 1 - left;
+        for(; left > 0 && logy < logDensity(k, lo); --left) {
+            lo -= w;
+        }
+        for(; right > 0 && logy < logDensity(k, hi); --right) {
+            hi += w;
+        }
+        while(hi - lo > SLICE_MIN_WIDTH * (std::fabs(x0) + w)) {
+            double x1 = lo + (hi - lo) * uni_dist(gen);
+            if(logy < logDensity(k, x1)) {
+                par.acceptCoordinates(coord, cand);
+                return;
+            }
+            if(x1 < x0) {
+                lo = x1;
+            } else {
+                hi = x1;
+            }
+        }
+        par.rejectStep();
+    }
+
+    /**
+     *
+     * @brief Hyper-rectangle slice sampling of all components with
+     *        shrinkage.
+     *
+     */
+    void updateRectangle() {
+        size_t d = par.value.size();
+        double logy = std::log(1 - uni_dist(gen));
+        lower.resize(d);
+        upper.resize(d);
+        coord.resize(d);
+        cand.resize(d);
+        for(size_t k = 0; k < d; ++k) {
+            lower[k] = old[k] - widths[k] * uni_dist(gen);
+            upper[k] = lower[k] + widths[k];
+            coord[k] = k;
+        }
+        while(true) {
+            bool open = false;
+            for(size_t k = 0; k < d; ++k) {
+                cand[k] = lower[k] + (upper[k] - lower[k]) * uni_dist(gen);
+                open = open || upper[k] - lower[k] > SLICE_MIN_WIDTH * (std::fabs(old[k]) + widths[k]);
+            }
+            if(!open) {
+                break;
+            }
+            if(logy < par.proposeCoordinates(coord, cand)) {
+                par.acceptCoordinates(coord, cand);
+                return;
+            }
+            for(size_t k = 0; k < d; ++k) {
+                if(cand[k] < old[k]) {
+                    lower[k] = cand[k];
+                } else {
+                    upper[k] = cand[k];
+                }
+            }
+        }
+        par.rejectStep();
+    }
+
+    /**
+     *
+     * @brief Sets the widths to %SLICE_WIDTH_SCALE standard deviations
+     *        of the values since the adaptation started.
+     *
+     */
+    void adaptWidths() {
+        ++moves;
+        for(size_t k = 0; k < widths.size(); ++k) {
+            double delta = par.value[k] - means[k];
+            means[k] += delta / moves;
+            squares[k] += delta * (par.value[k] - means[k]);
+            if(moves >= SLICE_ADAPT_MIN && squares[k] > 0) {
+                widths[k] = SLICE_WIDTH_SCALE * std::sqrt(squares[k] / (moves - 1));
+            }
+        }
+    }
+
+    /**
+     *
+     * @brief Resets the statistics reported by @ref accepted.
+     *
+     */
+    void resetStatistics() {
+        updates = 0;
+        evals = 0;
+    }
+
+    /**
+     *
+     * @brief The parameter, not owned.
+     *
+     */
+    mcmc_parameter &par;
+
+    /**
+     *
+     * @brief Determines if all components move jointly.
+     *
+     */
+    bool rectangle;
+
+    /**
+     *
+     * @brief Determines if the widths adapt.
+     *
+     */
+    bool adapting;
+
+    /**
+     *
+     * @brief Number of updates after which the adaptation stops.
+     *
+     */
+    size_t burnin;
+
+    /**
+     *
+     * @brief Number of updates since the adaptation started.
+     *
+     */
+    size_t iteration;
+
+    /**
+     *
+     * @brief Number of updates since the last change of the phase.
+     *
+     */
+    size_t updates;
+
+    /**
+     *
+     * @brief Number of bond evaluations since the last change of the
+     *        phase.
+     *
+     */
+    size_t evals;
+
+    /**
+     *
+     * @brief Number of bond evaluations of the last update.
+     *
+     */
+    size_t last_evals;
+
+    /**
+     *
+     * @brief Number of adapted updates.
+     *
+     */
+    size_t moves;
+
+    /**
+     *
+     * @brief Width of each component.
+     *
+     */
+    std::vector<double> widths;
+
+    /**
+     *
+     * @brief Running means and sums of squared deviations of the
+     *        components.
+     *
+     */
+    std::vector<double> means, squares;
+
+    /**
+     *
+     * @brief The value before the update.
+     *
+     */
+    std::vector<double> old;
+
+    /**
+     *
+     * @brief Lower and upper ends of the hyper-rectangle.
+     *
+     */
+    std::vector<double> lower, upper;
+
+    /**
+     *
+     * @brief Components and candidates of the last proposal.
+     *
+     */
+    std::vector<size_t> coord;
+    std::vector<double> cand;
+
+    /**
+     *
+     * @brief Random number generator of the update.
+     *
+     */
+    philox_engine gen;
+
+    /**
+     *
+     * @brief Uniform distribution on [0, 1).
+     *
+     */
+    boost::random::uniform_01<double> uni_dist;
+};
+
+#endif	/* SLICE_UPDATE_H */
@@ -0,0 +1,384 @@
+/**
+ *
+ * @file staged_bond.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 6, 2012, 2:30 PM
+ *
+ * @brief Base of the bonds holding their own copy of the parameters.
+ *
+ * A %staged_bond copies the values of its nodes when they are
+ * attached and afterwards changes the copy coordinate by coordinate:
+ * a proposal writes its candidates into the copy and remembers the
+ * replaced values, @ref reject writes them back and @ref accept takes
+ * the value computed for the proposal as the current one. Constant
+ * nodes, i.e. data, are not copied but read in place, see
+ * mcmc_node::isConstant. The argument makers read the nodes through
+ * %node_views either way.
+ *
+ * Derived bonds compute the value of the bond, see
+ * @ref computeCurrent, and the difference for a proposal, see
+ * @ref proposeCoords, which writes the candidates through
+ * @ref changeParameters.
+ *
+ * @see basic_mcmc_bond
+ * @see static_bond
+ * @see streaming_bond
+ *
+ */
+#ifndef STAGED_BOND_H
+#define	STAGED_BOND_H
+
+#include <algorithm>
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+#include "argument_view.h"
+#include "mcmc_bond.h"
+#include "mcmc_node.h"
+
+class staged_bond : public mcmc_bond {
+public:
+
+    /**
+     *
+     * @brief Default constructor, a bond without nodes.
+     *
+     */
+    staged_bond() : value_computed(false), current_value(0), new_value(0) {};
+
+    /**
+     *
+     * @brief Default destructor.
+     *
+     */
+    virtual ~staged_bond() {};
+
+    /**
+     *
+     * @brief  Computes the change of the bond for a proposal.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  newpar The candidate.
+     * @param  which The coordinate in the parameter vector.
+     * @return The logged difference of the bond.
+     *
+     * A proposal that is neither accepted nor rejected is rejected by
+     * the next one.
+     *
+     */
+    virtual double propose(int whatami, double newpar, int which) {
+        size_t coord = which;
+
+        return proposeCoords(whatami, &coord, &newpar, 1);
+    }
+
+    /**
+     *
+     * @brief  Computes the change of the bond for a joint proposal of
+     *         several coordinates of one parameter.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which The coordinates in the parameter vector.
+     * @param  newpar The candidates, one per coordinate.
+     * @return The logged difference of the bond.
+     *
+     */
+    virtual double proposeBlock(int whatami, std::vector<size_t> const &which, std::vector<double> const &newpar) {
+        return proposeCoords(whatami, &which[0], &newpar[0], which.size());
+    }
+
+    /**
+     *
+     * @brief Accepts the last proposal.
+     *
+     * The value computed for the proposal becomes the current value
+     * and the undo record is discarded.
+     *
+     */
+    virtual void accept() {
+        current_value = new_value;
+        undo.clear();
+    }
+
+    /**
+     *
+     * @brief Rejects the last proposal.
+     *
+     * Writes the replaced values back into %preargs. The current value
+     * of the bond has not been touched by the proposal.
+     *
+     */
+    virtual void reject() {
+        while(!undo.empty()) {
+            undo_entry const &u = undo.back();
+            preargs[u.whatami][u.which] = u.value;
+            undo.pop_back();
+        }
+    }
+
+    /**
+     *
+     * @brief Moves a parameter to a value drawn outside the bond.
+     * @param whatami Index of the parameter vector in the bond.
+     * @param value The new value.
+     * @param change The change of the logged bond.
+     *
+     * The change is added to the current value if it was computed,
+     * otherwise it is computed when next needed from %preargs.
+     *
+     */
+    virtual void moveTo(int whatami, std::vector<double> const &value, double change) {
+        reject();
+        preargs[whatami] = value;
+        viewCopy(whatami);
+        if(value_computed) {
+            current_value += change;
+        }
+    }
+
+    /**
+     *
+     * @brief Attaches the nodes and copies their values.
+     * @param nodes The nodes in the order of the bond's arguments.
+     *
+     */
+    virtual void attach(std::vector<mcmc_node const*> const &nodes) {
+        copyNodes(nodes);
+    }
+
+    /**
+     *
+     * @brief  Exchanges the copies of the parameters and the current
+     *         value with a copy of the bond.
+     * @param  other A copy of the bond, see @ref clone.
+     * @return False, if %other is a bond of another type or has
+     *         other nodes.
+     *
+     * The copies are swapped, not copied, and the views are pointed to
+     * them again. Constant nodes are left in place, their copies are
+     * empty. State computed from the parameters beyond the current
+     * value has to be exchanged by the derived bonds.
+     *
+     */
+    virtual bool swapState(mcmc_bond &other) {
+        if(typeid(*this) != typeid(other)) {
+            return false;
+        }
+        staged_bond &copy = static_cast<staged_bond&>(other);
+        if(copy.preargs.size() != preargs.size()) {
+            return false;
+        }
+        reject();
+        copy.reject();
+        for(size_t i = 0; i < preargs.size(); ++i) {
+            if(!preargs[i].empty() || !copy.preargs[i].empty()) {
+                preargs[i].swap(copy.preargs[i]);
+                viewCopy(i);
+                copy.viewCopy(i);
+            }
+        }
+        std::swap(value_computed, copy.value_computed);
+        std::swap(current_value, copy.current_value);
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief  Returns the logged value of the bond at the current
+     *         state.
+     *
+     * Computed once, afterwards kept up to date by accepted proposals.
+     *
+     */
+    virtual double currentValue() {
+        restoreCurrent();
+
+        return current_value;
+    }
+
+    /**
+     *
+     * @brief Computes %current_value from %preargs and sets
+     *        %value_computed, unless the value cannot be computed.
+     *
+     */
+    virtual void computeCurrent() = 0;
+
+protected:
+
+    /**
+     *
+     * @brief  Computes the change of the bond for a proposal of one or
+     *         more coordinates of a parameter.
+     * @param  whatami Index of the parameter vector in the bond.
+     * @param  which The coordinates.
+     * @param  cand The candidates, one per coordinate.
+     * @param  count Number of coordinates.
+     * @return The logged difference of the bond. %new_value is set.
+     *
+     */
+    virtual double proposeCoords(int const whatami, size_t const *which, double const *cand, size_t const count) = 0;
+
+    /**
+     *
+     * @brief Copies the values of the nodes, or views them in place if
+     *        they are constant, and discards the current value.
+     *
+     */
+    void copyNodes(std::vector<mcmc_node const*> const &nodes) {
+        preargs.resize(nodes.size());
+        node_views.resize(nodes.size());
+        for(size_t i = 0; i < nodes.size(); ++i) {
+            if(nodes[i]->isConstant()) {
+                std::vector<double>().swap(preargs[i]);
+                node_views[i] = nodeView(nodes[i]->values());
+            } else {
+                preargs[i] = nodes[i]->value;
+                viewCopy(i);
+            }
+        }
+        value_computed = false;
+        undo.clear();
+    }
+
+    /**
+     *
+     * @brief Drops the nodes, e.g. in a copy made by clone.
+     *
+     */
+    void detach() {
+        preargs.clear();
+        node_views.clear();
+        undo.clear();
+        value_computed = false;
+    }
+
+    /**
+     *
+     * @brief Rejects a pending proposal and computes the current value,
+     *        if it is not known.
+     *
+     */
+    void restoreCurrent() {
+        reject();
+        if(!value_computed) {
+            computeCurrent();
+        }
+    }
+
+    /**
+     *
+     * @brief Writes a candidate into %preargs and remembers the value
+     *        it replaces.
+     * @param whatami Index of the parameter vector in the bond.
+     * @param cand The candidate.
+     * @param which The coordinate in the parameter vector.
+     *
+     */
+    void changeParameters(int const whatami, double const cand, size_t const which) {
+        undo.push_back(undo_entry(whatami, which, preargs[whatami][which]));
+        preargs[whatami][which] = cand;
+    }
+
+    /**
+     *
+     * @brief Points the view of a node to the bond's copy of it.
+     * @param i Index of the node.
+     *
+     */
+    void viewCopy(size_t const i) {
+        node_views[i] = nodeView(argument_view(preargs[i].empty() ? 0 : &preargs[i][0], 1, preargs[i].size()));
+    }
+
+    /**
+     *
+     * @brief  Returns the view through which the argument makers read
+     *         a node.
+     * @param  view View on the values of the node.
+     *
+     * A node with a single entry, e.g. a scalar mean, is viewed with
+     * stride zero and broadcast to all terms of the bond, like a
+     * constant. Otherwise it would be read as a vector of one entry
+     * next to arguments of the length of the data. The bond depends
+     * on all its terms in such a node, see @ref isBroadcast.
+     *
+     */
+    static argument_view nodeView(argument_view const &view) {
+        return view.size() == 1 ? argument_view(view.data, 0, 1) : view;
+    }
+
+    /**
+     *
+     * @brief Indicates if a node is broadcast to all terms, see
+     *        @ref nodeView.
+     * @param i Index of the node.
+     *
+     */
+    bool isBroadcast(size_t const i) const {
+        return node_views[i].isScalar();
+    }
+
+    /**
+     *
+     * @brief Determines if %current_value has been computed.
+     *
+     */
+    bool value_computed;
+
+    /**
+     *
+     * @brief The value of the bond at the current state.
+     *
+     */
+    double current_value;
+
+    /**
+     *
+     * @brief The value of the bond for the last proposal.
+     *
+     */
+    double new_value;
+
+    /**
+     *
+     * @brief The bond's copy of the values of its nodes, empty for
+     *        constant nodes.
+     *
+     */
+    std::vector<std::vector<double> > preargs;
+
+    /**
+     *
+     * @brief Views on the values of the nodes, passed to the
+     *        argument makers.
+     *
+     * A view refers to %preargs, or to the storage of a constant node.
+     *
+     */
+    std::vector<argument_view> node_views;
+
+private:
+
+    /**
+     *
+     * @brief A coordinate changed by a proposal and its former value.
+     *
+     */
+    struct undo_entry {
+        undo_entry(int whatami, size_t which, double value) : whatami(whatami), which(which), value(value) {};
+
+        int whatami;
+        size_t which;
+        double value;
+    };
+
+    /**
+     *
+     * @brief The coordinates changed by a proposal that is neither
+     *        accepted nor rejected.
+     *
+     */
+    std::vector<undo_entry> undo;
+};
+
+#endif	/* STAGED_BOND_H */
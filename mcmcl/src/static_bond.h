@@ -0,0 +1,284 @@
+/**
+ * 
+ * @file static_bond.h
+ * @author Lars Simon Zehnder
+ * 
+ * @created June 8, 2012, 10:15 AM
+ *  
+ * @brief Bond whose likelihood and argument makers are fixed 
+ *        at compile time.
+ * 
+ * A %static_bond computes the same quantity as a @ref basic_mcmc_bond,
+ * but its @ref mcmc_likelihood and @ref argument_makers are template 
+ * parameters held by value. All calls to them are qualified and 
+ * therefore not virtual, so the compiler can inline the construction
+ * of the arguments into the loop over the likelihood terms. No 
+ * argument vector is materialized: each term reads its arguments 
+ * through argument_maker::getArgumentAt and passes them to 
+ * mcmc_likelihood::computeTerm.
+ * 
+ * The likelihood has to be separable and the makers have to know 
+ * their dependent terms for the incremental update, otherwise all 
+ * terms are recomputed. Towards @ref mcmc_parameter the bond 
+ * behaves like any other @ref mcmc_bond, including the undo record
+ * for rejected proposals.
+ * 
+ * Example: 
+ * @code
+ * static_bond<normal_likelihood, identity_argument_maker, 
+ *     group_argument_maker, constant_argument_maker> 
+ *     bond(normal_likelihood(), par, identity_argument_maker(0), 
+ *     group_argument_maker(1, groups), constant_argument_maker(1.0));
+ * @endcode
+ * 
+ * @see basic_mcmc_bond
+ * @see mcmc_bond
+ * 
+ */
+#ifndef STATIC_BOND_H
+#define	STATIC_BOND_H
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "mcmc_parameter.h"
+#include "staged_bond.h"
+
+template<class Likelihood, class... ArgMakers>
+class static_bond : public staged_bond {
+public:
+    
+    /**
+     * 
+     * @brief Main constructor.
+     * @param lik Log-likelihood function used in this bond.
+     * @param par Parameters relevant for the bond. The bond is added
+     *        to each of them.
+     * @param argms The argument makers, one per likelihood column.
+     * 
+     */
+    static_bond(Likelihood const &lik, std::vector<mcmc_parameter> &par, ArgMakers const &... argms) : 
+    lik(lik), argms(argms...), row(sizeof...(ArgMakers)) {
+        std::vector<mcmc_node const*> nodes;
+        for(size_t i = 0; i < par.size(); ++i) {
+            nodes.push_back(&par[i]);
+        }
+        attach(nodes);
+        for(size_t i = 0; i < par.size(); ++i) {
+            par[i].addBond(*this, i);
+        }
+    }
+    
+    /**
+     * 
+     * @brief Constructor for bonds owned by an @ref mcmc_model.
+     * @param lik Log-likelihood function used in this bond.
+     * @param argms The argument makers, one per likelihood column.
+     * 
+     * The nodes are attached by mcmc_model::addBond.
+     * 
+     */
+    static_bond(Likelihood const &lik, ArgMakers const &... argms) : 
+    lik(lik), argms(argms...), row(sizeof...(ArgMakers)) {}
+    
+    /**
+     * 
+     * @brief Default destructor.
+     * 
+     */
+    virtual ~static_bond() {};
+    
+    /**
+     * 
+     * @brief Computes the value of the bond from all terms.
+     * 
+     * Inherited from @ref staged_bond.
+     * 
+     */
+    virtual void computeCurrent() {
+        current_value = sumAll();
+        value_computed = true;
+    }
+    
+    /**
+     * 
+     * @brief  Returns the number of likelihood terms, the largest 
+     *         length of the arguments.
+     * 
+     * Inherited from @ref mcmc_bond.
+     * 
+     */
+    virtual size_t numTerms() const {
+        return size(std::integral_constant<size_t, 0>());
+    }
+    
+    /**
+     * 
+     * @brief  Copies the bond without its nodes.
+     * @return A bond with copies of the likelihood and the makers.
+     * 
+     */
+    virtual mcmc_bond *clone() const {
+        static_bond *copy = new static_bond(*this);
+        copy->detach();
+        
+        return copy;
+    }
+    
+    /**
+     * @brief The likelihood function determining the model. 
+     * 
+     */
+    Likelihood lik;
+    
+    /**
+     * 
+     * @brief The argument makers, one per likelihood column.
+     * 
+     */
+    std::tuple<ArgMakers...> argms;
+    
+private:
+    
+    /**
+     * 
+     * @brief  Computes the logged difference of the bond for a 
+     *         proposal of one or more coordinates.
+     * 
+     * Only the terms depending on the coordinates are recomputed, if 
+     * all argument makers know them and the parameter is not 
+     * broadcast to all terms. The replaced values are restored, if 
+     * the proposal is rejected.
+     * 
+     * Inherited from @ref staged_bond.
+     * 
+     */
+    virtual double proposeCoords(int const whatami, size_t const *which, double const *cand, size_t const count) {
+        restoreCurrent();
+        terms.clear();
+        double logr = 0;
+        bool known = !isBroadcast(whatami);
+        for(size_t c = 0; c < count && known; ++c) {
+            known = collectTerms(whatami, which[c], std::integral_constant<size_t, 0>());
+        }
+        if(known) {
+            std::sort(terms.begin(), terms.end());
+            terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+            for(size_t t = 0; t < terms.size(); ++t) {
+                logr -= term(terms[t]);
+            }
+            for(size_t c = 0; c < count; ++c) {
+                changeParameters(whatami, cand[c], which[c]);
+            }
+            for(size_t t = 0; t < terms.size(); ++t) {
+                logr += term(terms[t]);
+            }
+            new_value = current_value + logr;
+        } else {
+            for(size_t c = 0; c < count; ++c) {
+                changeParameters(whatami, cand[c], which[c]);
+            }
+            new_value = sumAll();
+            logr = new_value - current_value;
+        }
+        
+        return logr;
+    }
+    
+    /**
+     * 
+     * @brief  Computes a single likelihood term.
+     * @param  i Index of the term.
+     * @return The value of term i.
+     * 
+     */
+    double term(size_t const i) {
+        fillRow(i, std::integral_constant<size_t, 0>());
+        
+        return lik.Likelihood::computeTerm(row);
+    }
+    
+    /**
+     * 
+     * @brief  Computes the sum of all likelihood terms.
+     * @return The value of the bond.
+     * 
+     */
+    double sumAll() {
+        size_t n = size(std::integral_constant<size_t, 0>());
+        double sum = 0;
+        for(size_t i = 0; i < n; ++i) {
+            sum += term(i);
+        }
+        
+        return sum;
+    }
+    
+    /**
+     * 
+     * @brief Writes the i-th entry of argument K and the following 
+     *        into %row.
+     * 
+     */
+    template<size_t K>
+    void fillRow(size_t const i, std::integral_constant<size_t, K>) {
+        typedef typename std::tuple_element<K, std::tuple<ArgMakers...> >::type maker;
+        row[K] = std::get<K>(argms).maker::getArgumentAt(node_views, i);
+        fillRow(i, std::integral_constant<size_t, K + 1>());
+    }
+    
+    void fillRow(size_t const i, std::integral_constant<size_t, sizeof...(ArgMakers)>) {}
+    
+    /**
+     * 
+     * @brief Collects the terms depending on a coordinate from 
+     *        argument K and the following.
+     * @return False, if any of the makers does not know them.
+     * 
+     */
+    template<size_t K>
+    bool collectTerms(int const whatami, int const which, std::integral_constant<size_t, K>) {
+        typedef typename std::tuple_element<K, std::tuple<ArgMakers...> >::type maker;
+        return std::get<K>(argms).maker::dependentTerms(whatami, which, terms) && 
+            collectTerms(whatami, which, std::integral_constant<size_t, K + 1>());
+    }
+    
+    bool collectTerms(int const whatami, int const which, std::integral_constant<size_t, sizeof...(ArgMakers)>) {
+        return true;
+    }
+    
+    /**
+     * 
+     * @brief Returns the largest length of argument K and the 
+     *        following, i.e. the number of likelihood terms.
+     * 
+     */
+    template<size_t K>
+    size_t size(std::integral_constant<size_t, K>) const {
+        typedef typename std::tuple_element<K, std::tuple<ArgMakers...> >::type maker;
+        return std::max(std::get<K>(argms).maker::getSize(node_views), 
+            size(std::integral_constant<size_t, K + 1>()));
+    }
+    
+    size_t size(std::integral_constant<size_t, sizeof...(ArgMakers)>) const {
+        return 0;
+    }
+    
+    /**
+     * 
+     * @brief Indices of the terms touched by the current proposal.
+     * 
+     */
+    std::vector<size_t> terms;
+    
+    /**
+     * 
+     * @brief Stores the arguments of a single likelihood term.
+     * 
+     */
+    std::vector<double> row;
+};
+
+#endif	/* STATIC_BOND_H */
+
@@ -0,0 +1,689 @@
+/**
+ *
+ * @file streaming_bond.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 6, 2012, 9:15 AM
+ *
+ * @brief Bond over data read chunk by chunk, for data larger than the
+ *        memory.
+ *
+ * A %streaming_bond computes a separable likelihood as a sum over
+ * chunks of rows. The data arguments are columns of a
+ * @ref chunk_reader, e.g. a @ref column_file_stream, the other
+ * arguments are made from the parameters by @ref argument_makers,
+ * range by range, see argument_maker::makeArgumentRange. An argument
+ * whose maker is null is read from the next of the given columns.
+ *
+ * Two chunk buffers are used: while the likelihood is evaluated on
+ * one chunk, a thread of the bond reads the next one into the other.
+ * After the last chunk the first one is read again, for the next
+ * evaluation. If all chunks fit into the two buffers they are read
+ * once.
+ *
+ * The chunk size follows from a memory budget, which bounds the chunk
+ * buffers and the arguments made for a chunk, whatever the number of
+ * rows. Not counted are the parameters, held in full like in
+ * @ref basic_mcmc_bond, and the state of the makers: a
+ * @ref group_argument_maker keeps the group of every row, so with
+ * such makers the memory still grows with the rows, by the size of
+ * an int per row and maker.
+ *
+ * Time spent waiting for a chunk is a stall of the evaluation. The
+ * stalls, the time reading and the time evaluating are counted, see
+ * @ref report. Many stalls mean the evaluation is bound by the
+ * storage, fewer and larger chunks or a faster device help then.
+ *
+ * Each proposal evaluates all chunks, the bond is meant for global
+ * parameters of large data. Chunks are evaluated in slices of
+ * %SLICE_TERMS terms, in parallel if a @ref thread_pool is set, and
+ * summed in order, so the value does not depend on the number of
+ * threads. A chunk that cannot be read makes the value NaN, which
+ * rejects the proposal, and @ref error tells why.
+ *
+ * Example:
+ * @code
+ * boost::shared_ptr<column_file_stream> file(new column_file_stream());
+ * file->open("data.csv.mcol");
+ * std::vector<boost::shared_ptr<argument_maker> > argms;
+ * argms.push_back(boost::shared_ptr<argument_maker>());
+ * argms.push_back(boost::shared_ptr<argument_maker>(new group_argument_maker(0, groups)));
+ * std::vector<size_t> columns(1, file->find("y"));
+ * boost::shared_ptr<mcmc_bond> bond(new streaming_bond(argms, lik, file, columns, 256 << 20));
+ * model.addBond(bond, nodes);
+ * @endcode
+ *
+ * @see basic_mcmc_bond
+ * @see chunk_reader
+ *
+ */
+#ifndef STREAMING_BOND_H
+#define	STREAMING_BOND_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "staged_bond.h"
+#include "mcmc_likelihood.h"
+#include "argument_maker.h"
+#include "bond_arg_matrix.h"
+#include "reader.h"
+#include "thread_pool.h"
+
+class streaming_bond : public staged_bond {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param argm One %argument_maker per argument of the likelihood,
+     *        null for an argument read from the source.
+     * @param lik The likelihood, separable.
+     * @param source The data, shared with the copies of the bond.
+     * @param columns The columns of %source read for the null makers,
+     *        in order.
+     * @param budget Bytes for the chunk buffers and the made
+     *        arguments of a chunk.
+     *
+     * The nodes are attached by mcmc_model::addBond, the makers index
+     * them like in @ref basic_mcmc_bond.
+     *
+     */
+    streaming_bond(std::vector<boost::shared_ptr<argument_maker> > const &argm,
+    boost::shared_ptr<mcmc_likelihood> const &lik, boost::shared_ptr<chunk_reader> const &source,
+    std::vector<size_t> const &columns, size_t budget) : argms(argm), lik(lik), source(source),
+    columns(columns), budget(budget), pool(0), pending(NONE), target(0), failed(false), stopping(false),
+    chunks_read(0), bytes_read(0), stalls(0), read_seconds(0), stall_seconds(0), eval_seconds(0) {
+        size_t nmade = argms.size() - std::min(argms.size(), columns.size());
+        size_t per_row = sizeof(double) * std::max<size_t>(2 * columns.size() + nmade, 1);
+        chunk_rows = std::max<size_t>(budget / per_row, 1);
+        loaded[0] = loaded[1] = NONE;
+    }
+
+    /**
+     *
+     * @brief Destructor, ends the read-ahead thread.
+     *
+     */
+    virtual ~streaming_bond() {
+        if(reader_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            ready.notify_all();
+            reader_thread.join();
+        }
+    }
+
+    /**
+     *
+     * @brief Computes the value of the bond from all chunks.
+     *
+     * The value stays unknown if a chunk could not be read.
+     *
+     * Inherited from @ref staged_bond.
+     *
+     */
+    virtual void computeCurrent() {
+        current_value = sumAll();
+        value_computed = !std::isnan(current_value);
+    }
+
+    /**
+     *
+     * @brief  Copies the bond without its nodes.
+     * @return A bond reading the same source with its own buffers.
+     *
+     */
+    virtual mcmc_bond *clone() const {
+        return new streaming_bond(argms, lik, source, columns, budget);
+    }
+
+    /**
+     *
+     * @brief Sets the pool evaluating the slices of a chunk.
+     * @param pool The pool, or null for serial evaluation. Not owned.
+     *
+     */
+    virtual void setThreadPool(thread_pool *pool) {
+        this->pool = pool;
+    }
+
+    /**
+     *
+     * @brief Number of likelihood terms, the rows of the source.
+     *
+     */
+    virtual size_t numTerms() const {
+        return source->rows();
+    }
+
+    /**
+     *
+     * @brief Number of rows per chunk, set by the budget.
+     *
+     */
+    size_t chunkRows() const {
+        return chunk_rows;
+    }
+
+    /**
+     *
+     * @brief Number of chunks read.
+     *
+     */
+    size_t numChunksRead() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return chunks_read;
+    }
+
+    /**
+     *
+     * @brief Number of bytes read.
+     *
+     */
+    size_t bytesRead() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes_read;
+    }
+
+    /**
+     *
+     * @brief Number of times the evaluation waited for a chunk.
+     *
+     */
+    size_t numStalls() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stalls;
+    }
+
+    /**
+     *
+     * @brief Seconds the evaluation waited for chunks.
+     *
+     */
+    double stallTime() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stall_seconds;
+    }
+
+    /**
+     *
+     * @brief Seconds spent reading chunks.
+     *
+     */
+    double readTime() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return read_seconds;
+    }
+
+    /**
+     *
+     * @brief Seconds spent in evaluations, the stalls included.
+     *
+     */
+    double evaluationTime() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return eval_seconds;
+    }
+
+    /**
+     *
+     * @brief Resets the counts and times.
+     *
+     */
+    void resetStatistics() {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks_read = 0;
+        bytes_read = 0;
+        read_seconds = 0;
+        stalls = 0;
+        stall_seconds = 0;
+        eval_seconds = 0;
+    }
+
+    /**
+     *
+     * @brief  Reports the reading and the stalls.
+     * @return One line with the chunks and bytes read, the read rate,
+     *         the stalls and their share of the evaluation time.
+     *
+     */
+    std::string report() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out << chunks_read << " chunks of " << chunk_rows << " rows read, " << bytes_read / 1e6 << " MB in "
+            << read_seconds << " s (" << (read_seconds > 0 ? bytes_read / 1e6 / read_seconds : 0.0) << " MB/s), "
+            << stalls << " stalls of " << stall_seconds << " s in total ("
+            << (eval_seconds > 0 ? 100 * stall_seconds / eval_seconds : 0.0) << "% of " << eval_seconds
+            << " s evaluating)\n";
+
+        return out.str();
+    }
+
+    /**
+     *
+     * @brief Why the last evaluation failed.
+     *
+     */
+    std::string error() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return message;
+    }
+
+    /**
+     *
+     * @brief Number of terms evaluated in one task.
+     *
+     */
+    static size_t const SLICE_TERMS = 16384;
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the read-ahead thread refers to this.
+     *
+     */
+    streaming_bond(streaming_bond const &other);
+    streaming_bond& operator=(streaming_bond const &other);
+
+    /**
+     *
+     * @brief No chunk.
+     *
+     */
+    static size_t const NONE = ~size_t(0);
+
+    /**
+     *
+     * @brief  Computes the change of the bond for a proposal of one or
+     *         more coordinates of a parameter, from all chunks.
+     *
+     * Inherited from @ref staged_bond.
+     *
+     */
+    virtual double proposeCoords(int const whatami, size_t const *which, double const *cand, size_t const count) {
+        restoreCurrent();
+        for(size_t c = 0; c < count; ++c) {
+            changeParameters(whatami, cand[c], which[c]);
+        }
+        new_value = sumAll();
+
+        return new_value - current_value;
+    }
+
+    /**
+     *
+     * @brief  Sums the likelihood over all chunks.
+     * @return The sum, or NaN if a chunk could not be read.
+     *
+     * The chunk after c, or the first one after the last, is requested
+     * before chunk c is evaluated.
+     *
+     */
+    double sumAll() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if(!lik->isSeparable()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            message = "the likelihood is not separable";
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        size_t n = source->rows();
+        size_t nchunks = (n + chunk_rows - 1) / chunk_rows;
+        size_t length = columns.size() * std::min(chunk_rows, n);
+        if(buffers[0].size() < length) {
+            waitIdle();
+            buffers[0].resize(length);
+            buffers[1].resize(length);
+            loaded[0] = loaded[1] = NONE;
+        }
+        double sum = 0;
+        if(nchunks > 0) {
+            request(0, NONE);
+        }
+        for(size_t c = 0; c < nchunks; ++c) {
+            size_t b = wait(c);
+            if(b == NONE) {
+                sum = std::numeric_limits<double>::quiet_NaN();
+                break;
+            }
+            request((c + 1) % nchunks, c);
+            sum += evaluateChunk(c, n, b);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        eval_seconds += seconds;
+
+        return sum;
+    }
+
+    /**
+     *
+     * @brief  Evaluates the likelihood on a loaded chunk.
+     * @param  c Index of the chunk.
+     * @param  n Number of rows of the source.
+     * @param  b The buffer holding the chunk.
+     * @return Sum of the terms of the chunk, slice by slice.
+     *
+     */
+    double evaluateChunk(size_t const c, size_t const n, size_t const b) {
+        size_t begin = c * chunk_rows;
+        size_t end = std::min(n, begin + chunk_rows);
+        size_t len = end - begin;
+        size_t stride = std::min(chunk_rows, n);
+        args.resize(argms.size(), len);
+        size_t j = 0;
+        for(size_t k = 0; k < argms.size(); ++k) {
+            if(!argms[k]) {
+                args.bind(k, argument_view(&buffers[b][j * stride], 1, len));
+                ++j;
+            } else {
+                args.bind(k, argms[k]->makeArgumentRange(node_views, begin, end, args.column(k)));
+            }
+        }
+        std::vector<argument_view> const &views = args.views();
+        size_t nslices = (len + SLICE_TERMS - 1) / SLICE_TERMS;
+        if(slice_views.size() < nslices) {
+            slice_views.resize(nslices);
+            slice_sums.resize(nslices);
+        }
+        std::function<void(size_t)> slice = [this, &views, len](size_t s) {
+            std::vector<argument_view> &part = slice_views[s];
+            part.resize(views.size());
+            for(size_t k = 0; k < views.size(); ++k) {
+                part[k] = views[k].slice(s * SLICE_TERMS, std::min(len, (s + 1) * SLICE_TERMS));
+            }
+            slice_sums[s] = lik->evaluate(part);
+        };
+        if(pool != 0 && nslices > 1) {
+            pool->run(nslices, slice);
+        } else {
+            for(size_t s = 0; s < nslices; ++s) {
+                slice(s);
+            }
+        }
+        double sum = 0;
+        for(size_t s = 0; s < nslices; ++s) {
+            sum += slice_sums[s];
+        }
+
+        return sum;
+    }
+
+    /**
+     *
+     * @brief Asks the read-ahead thread for a chunk, unless it is
+     *        loaded already.
+     * @param c The chunk.
+     * @param keep The chunk whose buffer must not be overwritten,
+     *        %NONE if any.
+     *
+     */
+    void request(size_t const c, size_t const keep) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(pending == c || loaded[0] == c || loaded[1] == c) {
+            return;
+        }
+        ready.wait(lock, [this] {return pending == NONE;});
+        target = loaded[0] == keep && keep != NONE ? 1 : 0;
+        loaded[target] = NONE;
+        pending = c;
+        failed = false;
+        if(!reader_thread.joinable()) {
+            reader_thread = std::thread(&streaming_bond::readAhead, this);
+        }
+        lock.unlock();
+        ready.notify_all();
+    }
+
+    /**
+     *
+     * @brief  Waits until a chunk is loaded and counts the stall.
+     * @return The buffer holding the chunk, or %NONE if it could not
+     *         be read.
+     *
+     */
+    size_t wait(size_t const c) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(loaded[0] == c || loaded[1] == c) {
+            return loaded[0] == c ? 0 : 1;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ready.wait(lock, [this, c] {return loaded[0] == c || loaded[1] == c || failed;});
+        stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++stalls;
+        if(loaded[0] != c && loaded[1] != c) {
+            failed = false;
+            return NONE;
+        }
+
+        return loaded[0] == c ? 0 : 1;
+    }
+
+    /**
+     *
+     * @brief Waits until no chunk is being read.
+     *
+     */
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] {return pending == NONE;});
+    }
+
+    /**
+     *
+     * @brief Loop of the read-ahead thread.
+     *
+     */
+    void readAhead() {
+        std::string why;
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true) {
+            ready.wait(lock, [this] {return stopping || pending != NONE;});
+            if(stopping) {
+                return;
+            }
+            size_t c = pending;
+            size_t b = target;
+            lock.unlock();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            size_t n = source->rows();
+            size_t first = c * chunk_rows;
+            size_t count = std::min(chunk_rows, n - first);
+            size_t stride = std::min(chunk_rows, n);
+            bool ok = true;
+            for(size_t j = 0; ok && j < columns.size(); ++j) {
+                ok = source->readRows(columns[j], first, count, &buffers[b][j * stride], why);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            lock.lock();
+            read_seconds += seconds;
+            if(ok) {
+                loaded[b] = c;
+                ++chunks_read;
+                bytes_read += count * columns.size() * sizeof(double);
+            } else {
+                failed = true;
+                message = why;
+            }
+            pending = NONE;
+            ready.notify_all();
+        }
+    }
+
+    /**
+     *
+     * @brief The makers, null for arguments read from the source.
+     *
+     */
+    std::vector<boost::shared_ptr<argument_maker> > argms;
+
+    /**
+     *
+     * @brief The likelihood.
+     *
+     */
+    boost::shared_ptr<mcmc_likelihood> lik;
+
+    /**
+     *
+     * @brief The data.
+     *
+     */
+    boost::shared_ptr<chunk_reader> source;
+
+    /**
+     *
+     * @brief The columns read from %source.
+     *
+     */
+    std::vector<size_t> columns;
+
+    /**
+     *
+     * @brief The memory budget in bytes.
+     *
+     */
+    size_t budget;
+
+    /**
+     *
+     * @brief Number of rows per chunk.
+     *
+     */
+    size_t chunk_rows;
+
+    /**
+     *
+     * @brief The arguments of the current chunk.
+     *
+     */
+    bond_arg_matrix args;
+
+    /**
+     *
+     * @brief Views on the arguments of each slice of a chunk.
+     *
+     */
+    std::vector<std::vector<argument_view> > slice_views;
+
+    /**
+     *
+     * @brief Sums of the slices, reduced in order.
+     *
+     */
+    std::vector<double> slice_sums;
+
+    /**
+     *
+     * @brief Pool evaluating the slices, not owned.
+     *
+     */
+    thread_pool *pool;
+
+    /**
+     *
+     * @brief The two chunk buffers, the columns one after another.
+     *
+     */
+    std::vector<double> buffers[2];
+
+    /**
+     *
+     * @brief The chunk held by each buffer, %NONE if none or while it
+     *        is written.
+     *
+     */
+    size_t loaded[2];
+
+    /**
+     *
+     * @brief The chunk being read, %NONE if none.
+     *
+     */
+    size_t pending;
+
+    /**
+     *
+     * @brief The buffer the pending chunk is read into.
+     *
+     */
+    size_t target;
+
+    /**
+     *
+     * @brief Set if the last requested chunk could not be read.
+     *
+     */
+    bool failed;
+
+    /**
+     *
+     * @brief Set by the destructor to end the read-ahead thread.
+     *
+     */
+    bool stopping;
+
+    /**
+     *
+     * @brief The thread reading ahead, started with the first request.
+     *
+     */
+    std::thread reader_thread;
+
+    /**
+     *
+     * @brief Guards the state shared with the read-ahead thread and
+     *        the statistics.
+     *
+     */
+    mutable std::mutex mutex;
+
+    /**
+     *
+     * @brief Signals requests and loaded chunks.
+     *
+     */
+    std::condition_variable ready;
+
+    /**
+     *
+     * @brief Number of chunks and bytes read.
+     *
+     */
+    size_t chunks_read, bytes_read;
+
+    /**
+     *
+     * @brief Number of waits for a chunk.
+     *
+     */
+    size_t stalls;
+
+    /**
+     *
+     * @brief Seconds reading, waiting and evaluating.
+     *
+     */
+    double read_seconds, stall_seconds, eval_seconds;
+
+    /**
+     *
+     * @brief Message of the last error.
+     *
+     */
+    std::string message;
+};
+
+#endif	/* STREAMING_BOND_H */
@@ -0,0 +1,182 @@
+/**
+ *
+ * @file student_t_likelihood.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 11, 2012, 5:20 PM
+ *
+ * @brief Log-density of the location-scale Student-t distribution.
+ *
+ * Columns: observations y, locations mu, scales sigma and degrees
+ * of freedom nu.
+ *
+ * @see mcmc_likelihood
+ * @see simd_math.h
+ *
+ */
+#ifndef STUDENT_T_LIKELIHOOD_H
+#define	STUDENT_T_LIKELIHOOD_H
+
+#include <cmath>
+#include <boost/math/special_functions/digamma.hpp>
+#include "mcmc_likelihood.h"
+#include "simd_math.h"
+
+/**
+ *
+ * @brief Student-t log-density kernel for the instruction set V,
+ *        without the normalizing constant of nu.
+ *
+ */
+template<class V>
+class student_t_kernel {
+public:
+
+    student_t_kernel(std::vector<argument_view> const &args) :
+    y(args[0]), mu(args[1]), sd(args[2]), nu(args[3]),
+    log_sd(V::set1(sd.scalar ? std::log(args[2][0]) : 0.0)) {};
+
+    typename V::reg operator()(size_t i) const {
+        typename V::reg z = V::div(V::sub(y(i), mu(i)), sd(i));
+        typename V::reg n = nu(i);
+        typename V::reg l = sd.scalar ? log_sd : V::log(sd(i));
+        typename V::reg h = V::mul(V::set1(0.5), V::add(n, V::set1(1.0)));
+
+        return V::fnmadd(h, V::log1p(V::div(V::mul(z, z), n)), V::sub(V::zero(), l));
+    }
+
+    simd_column<V> y, mu, sd, nu;
+    typename V::reg log_sd;
+};
+
+class student_t_likelihood : public mcmc_likelihood {
+public:
+
+    /**
+     *
+     * @brief Default destructor.
+     */
+    virtual ~student_t_likelihood() {};
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations.
+     * @param args Columns y, mu, sigma and nu.
+     *
+     */
+    virtual double compute (std::vector<std::vector<double> > const &args) {
+        return evaluate(views(args));
+    };
+
+    /**
+     *
+     * @brief Computes the log-likelihood of all observations from views.
+     * @param args Views on y, mu, sigma and nu.
+     *
+     * The normalizing constant depends on nu only and is computed
+     * once if nu is a broadcast scalar.
+     *
+     */
+    virtual double evaluate (std::vector<argument_view> const &args) {
+        size_t n = args[0].size();
+        double norm = 0;
+        if(args[3].isScalar()) {
+            norm = n * normalizer(args[3][0]);
+        } else {
+            for(size_t i = 0; i < n; ++i) {
+                norm += normalizer(args[3][i]);
+            }
+        }
+
+        return norm + simd_sum<student_t_kernel>(args);
+    };
+
+    /**
+     *
+     * @brief The log-likelihood is a sum over the observations.
+     *
+     */
+    virtual bool isSeparable () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the log-density of a single observation.
+     * @param row y, mu, sigma and nu of the observation.
+     *
+     */
+    virtual double computeTerm (std::vector<double> const &row) {
+        double z = (row[0] - row[1]) / row[2];
+
+        return normalizer(row[3]) - std::log(row[2]) - 0.5 * (row[3] + 1) * std::log1p(z * z / row[3]);
+    };
+
+    /**
+     *
+     * @brief The derivatives are computed analytically.
+     *
+     */
+    virtual bool hasGradient () const {
+        return true;
+    };
+
+    /**
+     *
+     * @brief Computes the derivatives of each term.
+     * @param args Views on y, mu, sigma and nu.
+     * @param grad Derivatives with respect to y, mu, sigma and nu.
+     *
+     */
+    virtual void gradient (std::vector<argument_view> const &args, std::vector<double*> const &grad) {
+        size_t n = args[0].size();
+        for(size_t i = 0; i < n; ++i) {
+            double sd = args[2][i];
+            double nu = args[3][i];
+            double z = (args[0][i] - args[1][i]) / sd;
+            double w = (nu + 1) / (nu + z * z);
+            if(grad[0]) {
+                grad[0][i] = -w * z / sd;
+            }
+            if(grad[1]) {
+                grad[1][i] = w * z / sd;
+            }
+            if(grad[2]) {
+                grad[2][i] = (w * z * z - 1) / sd;
+            }
+            if(grad[3]) {
+                grad[3][i] = 0.5 * (boost::math::digamma(0.5 * (nu + 1)) - boost::math::digamma(0.5 * nu) - 
+                    1 / nu - std::log1p(z * z / nu) + w * z * z / nu);
+            }
+        }
+    };
+
+    /**
+     *
+     * @brief  Bounds the log-likelihood by the mode of every term.
+     * @param  args Views on y, mu, sigma and nu.
+     * @return n (normalizer(nu) - log sigma) for a broadcast sigma and
+     *         nu, else HUGE_VAL.
+     *
+     */
+    virtual double upperBound (std::vector<argument_view> const &args) {
+        if(!args[2].isScalar() || !args[3].isScalar()) {
+            return HUGE_VAL;
+        }
+
+        return args[0].size() * (normalizer(args[3][0]) - std::log(args[2][0]));
+    };
+
+private:
+
+    /**
+     *
+     * @brief Log of the normalizing constant for nu degrees of freedom.
+     *
+     */
+    static double normalizer (double nu) {
+        return std::lgamma(0.5 * (nu + 1)) - std::lgamma(0.5 * nu) - 0.5 * std::log(nu * M_PI);
+    };
+};
+#endif	/* STUDENT_T_LIKELIHOOD_H */
+
@@ -0,0 +1,385 @@
+/**
+ *
+ * @file thread_pool.h
+ * @author Lars Simon Zehnder
+ *
+ * @created June 20, 2012, 10:00 AM
+ *
+ * @brief Work-stealing thread pool for parallel bond evaluation.
+ *
+ * The %thread_pool runs a fixed number of tasks, identified by their
+ * index, on its worker threads and the calling thread. Every thread
+ * owns a queue: it takes tasks from the back of its own queue and
+ * steals from the front of the others, if its own queue is empty.
+ * A thread waiting for its tasks to finish keeps executing tasks, so
+ * @ref run can be called from within a task, e.g. by a bond that
+ * splits its data while the bonds themselves run in parallel.
+ *
+ * The worker threads can be pinned, each to its own processor, such
+ * that they keep the memory they placed local, see numa_vector. The
+ * calling thread is left as it is. Pinned pools take the processors
+ * in turn, a pool created after another one starts where the former
+ * ended, so pools stack only if they have more threads than there
+ * are processors.
+ *
+ * Which thread executes a task is not determined. Callers get
+ * results independent of the number of threads by writing the result
+ * of task i into slot i and reducing the slots in index order, see
+ * mcmc_parameter::acceptanceP.
+ *
+ * @see mcmc_model::setThreadPool
+ *
+ */
+#ifndef THREAD_POOL_H
+#define	THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+class thread_pool {
+public:
+
+    /**
+     *
+     * @brief Custom constructor.
+     * @param nthreads Number of threads executing tasks, including
+     *        the calling thread. One thread runs all tasks on the
+     *        caller.
+     * @param pinned Determines if the worker threads are pinned, each
+     *        to one processor the process may run on. The calling
+     *        thread keeps its affinity.
+     *
+     */
+    explicit thread_pool(size_t nthreads, bool pinned = false) : queues(nthreads > 0 ? nthreads : 1), first(0),
+    queued(0), stop(false) {
+        if(pinned) {
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+                for(int c = 0; c < CPU_SETSIZE; ++c) {
+                    if(CPU_ISSET(c, &allowed)) {
+                        cpus.push_back(c);
+                    }
+                }
+            }
+            first = next_cpu().fetch_add(queues.size());
+        }
+        for(size_t t = 1; t < queues.size(); ++t) {
+            workers.push_back(std::thread(&thread_pool::work, this, t));
+        }
+    }
+
+    /**
+     *
+     * @brief Destructor, joins the worker threads.
+     *
+     */
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for(size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+    }
+
+    /**
+     *
+     * @brief Runs the tasks 0, ..., ntasks - 1 and returns when all of
+     *        them have finished.
+     * @param ntasks Number of tasks.
+     * @param task Function called with the index of each task.
+     *
+     * The tasks are dealt round-robin to the queues, starting with the
+     * queue of the calling thread. An exception thrown by a task is
+     * rethrown here, after all queued tasks of the call have
+     * finished.
+     *
+     */
+    void run(size_t ntasks, std::function<void(size_t)> const &task) {
+        if(ntasks == 0) {
+            return;
+        }
+        if(queues.size() == 1 || ntasks == 1) {
+            for(size_t i = 0; i < ntasks; ++i) {
+                task(i);
+            }
+            return;
+        }
+        job j(task, ntasks);
+        size_t self = index();
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            queued += ntasks;
+        }
+        for(size_t i = 0; i < ntasks; ++i) {
+            queue &q = queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(entry(&j, i));
+        }
+        wake.notify_all();
+        while(j.remaining.load(std::memory_order_acquire) > 0) {
+            if(!execute(self)) {
+                std::this_thread::yield();
+            }
+        }
+        if(j.error) {
+            std::rethrow_exception(j.error);
+        }
+    }
+
+    /**
+     *
+     * @brief Number of threads executing tasks, including the caller.
+     *
+     */
+    size_t size() const {
+        return queues.size();
+    }
+
+private:
+
+    /**
+     *
+     * @brief Not copyable, the workers refer to this.
+     *
+     */
+    thread_pool(thread_pool const &other);
+    thread_pool& operator=(thread_pool const &other);
+
+    /**
+     *
+     * @brief Tasks of one call to @ref run.
+     *
+     */
+    struct job {
+        job(std::function<void(size_t)> const &task, size_t ntasks) : task(task), remaining(ntasks) {};
+
+        std::function<void(size_t)> const &task;
+        std::atomic<size_t> remaining;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    /**
+     *
+     * @brief A queued task, the job and the index of the task.
+     *
+     */
+    struct entry {
+        entry() : owner(0), i(0) {};
+        entry(job *owner, size_t i) : owner(owner), i(i) {};
+
+        job *owner;
+        size_t i;
+    };
+
+    /**
+     *
+     * @brief Task queue of one thread.
+     *
+     */
+    struct queue {
+        std::mutex mutex;
+        std::deque<entry> tasks;
+    };
+
+    /**
+     *
+     * @brief  Index of the calling thread's queue.
+     *
+     * Threads not owned by the pool share the first queue.
+     *
+     */
+    size_t index() const {
+        return current_pool() == this ? current_index() : 0;
+    }
+
+    /**
+     *
+     * @brief  Takes a task, from the back of the own queue or from the
+     *         front of another one, and executes it. An exception of
+     *         the task is kept in its job.
+     * @param  self Index of the own queue.
+     * @return True, if a task was executed.
+     *
+     */
+    bool execute(size_t self) {
+        entry e;
+        bool found = false;
+        for(size_t k = 0; k < queues.size() && !found; ++k) {
+            queue &q = queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if(!q.tasks.empty()) {
+                if(k == 0) {
+                    e = q.tasks.back();
+                    q.tasks.pop_back();
+                } else {
+                    e = q.tasks.front();
+                    q.tasks.pop_front();
+                }
+                found = true;
+            }
+        }
+        if(!found) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            --queued;
+        }
+        try {
+            e.owner->task(e.i);
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(e.owner->error_mutex);
+            if(!e.owner->error) {
+                e.owner->error = std::current_exception();
+            }
+        }
+        e.owner->remaining.fetch_sub(1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     *
+     * @brief Loop of a worker thread.
+     * @param self Index of the worker's queue.
+     *
+     */
+    void work(size_t self) {
+        pin(self);
+        current_pool() = this;
+        current_index() = self;
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [this] {return stop || queued > 0;});
+                if(stop) {
+                    return;
+                }
+            }
+            while(execute(self)) {}
+        }
+    }
+
+    /**
+     *
+     * @brief Pins the calling worker to its processor, if the workers
+     *        are pinned.
+     * @param self Index of the worker's queue.
+     *
+     */
+    void pin(size_t self) {
+        if(cpus.empty()) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[(first + self) % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    /**
+     *
+     * @brief Offset of the processors of the next pinned pool.
+     *
+     */
+    static std::atomic<size_t> &next_cpu() {
+        static std::atomic<size_t> next(0);
+        return next;
+    }
+
+    /**
+     *
+     * @brief The pool owning the calling thread, if any.
+     *
+     */
+    static thread_pool const *&current_pool() {
+        static thread_local thread_pool const *pool = 0;
+        return pool;
+    }
+
+    /**
+     *
+     * @brief Queue index of the calling thread in its pool.
+     *
+     */
+    static size_t &current_index() {
+        static thread_local size_t i = 0;
+        return i;
+    }
+
+    /**
+     *
+     * @brief One queue per thread, the first one for the caller.
+     *
+     */
+    std::vector<queue> queues;
+
+    /**
+     *
+     * @brief The processors of the threads, empty if they are not
+     *        pinned.
+     *
+     */
+    std::vector<int> cpus;
+
+    /**
+     *
+     * @brief Offset of the pool's processors in %cpus, queue t is run
+     *        on processor first + t.
+     *
+     */
+    size_t first;
+
+    /**
+     *
+     * @brief The worker threads.
+     *
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     *
+     * @brief Number of queued tasks, guarded by %sleep_mutex. Counted
+     *        before the tasks are pushed, such that it never drops
+     *        below zero.
+     *
+     */
+    size_t queued;
+
+    /**
+     *
+     * @brief Set by the destructor to end the workers.
+     *
+     */
+    bool stop;
+
+    /**
+     *
+     * @brief Guards %queued and %stop.
+     *
+     */
+    std::mutex sleep_mutex;
+
+    /**
+     *
+     * @brief Wakes the workers if tasks are queued.
+     *
+     */
+    std::condition_variable wake;
+};
+
+#endif	/* THREAD_POOL_H */
+
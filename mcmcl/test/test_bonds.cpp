@@ -0,0 +1,146 @@
+/**
+ *
+ * @file test_bonds.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 9, 2012, 9:40 AM
+ *
+ * @brief Checks the values of @ref basic_mcmc_bond and
+ *        @ref static_bond against a direct computation.
+ *
+ * Both bonds compute a normal likelihood of data y with group means
+ * mu and a standard deviation per observation. After every proposal,
+ * accept, reject and move the value of each bond has to match the
+ * sum of the log-densities at the state the bond should be in.
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "basic_mcmc_bond.h"
+#include "static_bond.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "test_check.h"
+
+/**
+ *
+ * @brief Sum of the normal log-densities of y given the group means
+ *        and the standard deviations.
+ *
+ */
+double normalSum(std::vector<double> const &y, std::vector<double> const &mu, std::vector<int> const &group,
+    std::vector<double> const &sd) {
+    double sum = 0;
+    for(size_t i = 0; i < y.size(); ++i) {
+        double z = (y[i] - mu[group[i]]) / sd[i];
+        sum += -0.5 * z * z - std::log(sd[i]) - 0.91893853320467274178;
+    }
+
+    return sum;
+}
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    std::srand(7);
+    size_t const n = 1000, groups = 13;
+    std::vector<double> y(n), sd(n), mu(groups);
+    std::vector<int> group(n);
+    for(size_t i = 0; i < n; ++i) {
+        group[i] = std::rand() % groups;
+        y[i] = uniform(-2, 2);
+        sd[i] = uniform(0.5, 2);
+    }
+    for(size_t j = 0; j < groups; ++j) {
+        mu[j] = uniform(-1, 1);
+    }
+    std::vector<mcmc_parameter> par;
+    par.push_back(mcmc_parameter(y, std::vector<double>(n, 0), "y"));
+    par.push_back(mcmc_parameter(mu, std::vector<double>(groups, 0.1), "mu"));
+    par.push_back(mcmc_parameter(sd, std::vector<double>(n, 0.1), "sd"));
+
+    std::vector<boost::shared_ptr<argument_maker> > argms;
+    argms.push_back(boost::shared_ptr<argument_maker>(new identity_argument_maker(0)));
+    argms.push_back(boost::shared_ptr<argument_maker>(new group_argument_maker(1, group)));
+    argms.push_back(boost::shared_ptr<argument_maker>(new identity_argument_maker(2)));
+    basic_mcmc_bond basic(argms, boost::shared_ptr<mcmc_likelihood>(new normal_likelihood), par);
+    static_bond<normal_likelihood, identity_argument_maker, group_argument_maker, identity_argument_maker>
+        fixed(normal_likelihood(), par, identity_argument_maker(0), group_argument_maker(1, group),
+        identity_argument_maker(2));
+    mcmc_bond *bonds[] = {&basic, &fixed};
+
+    double const tol = 1e-8;
+    CHECK_CLOSE(basic.currentValue(), normalSum(y, mu, group, sd), tol);
+    CHECK_CLOSE(fixed.currentValue(), normalSum(y, mu, group, sd), tol);
+
+    for(int it = 0; it < 500; ++it) {
+        int whatami = it % 3 == 2 ? 2 : 1;
+        size_t which = std::rand() % (whatami == 1 ? groups : n);
+        double cand = whatami == 1 ? uniform(-1, 1) : uniform(0.5, 2);
+        std::vector<double> mu_new = mu, sd_new = sd;
+        (whatami == 1 ? mu_new : sd_new)[which] = cand;
+        double change = normalSum(y, mu_new, group, sd_new) - normalSum(y, mu, group, sd);
+        bool accept = std::rand() % 2;
+        for(size_t b = 0; b < 2; ++b) {
+            CHECK_CLOSE(bonds[b]->propose(whatami, cand, which), change, tol);
+            if(accept) {
+                bonds[b]->accept();
+            } else {
+                bonds[b]->reject();
+            }
+        }
+        if(accept) {
+            mu = mu_new;
+            sd = sd_new;
+        }
+    }
+    CHECK_CLOSE(basic.currentValue(), normalSum(y, mu, group, sd), 1e-6);
+    CHECK_CLOSE(fixed.currentValue(), normalSum(y, mu, group, sd), 1e-6);
+
+    /* A block proposal left pending is rejected by the next one. */
+    std::vector<size_t> which(2);
+    which[0] = 0;
+    which[1] = groups - 1;
+    std::vector<double> cand(2, 0.25);
+    std::vector<double> mu_new = mu;
+    mu_new[which[0]] = mu_new[which[1]] = 0.25;
+    for(size_t b = 0; b < 2; ++b) {
+        CHECK_CLOSE(bonds[b]->proposeBlock(1, which, cand),
+            normalSum(y, mu_new, group, sd) - normalSum(y, mu, group, sd), tol);
+    }
+    CHECK_CLOSE(basic.currentValue(), normalSum(y, mu, group, sd), 1e-6);
+    CHECK_CLOSE(fixed.currentValue(), normalSum(y, mu, group, sd), 1e-6);
+
+    /* A copy computes the same value once its nodes are attached. */
+    par[1].value = mu;
+    par[2].value = sd;
+    std::vector<mcmc_node const*> nodes;
+    for(size_t i = 0; i < par.size(); ++i) {
+        nodes.push_back(&par[i]);
+    }
+    for(size_t b = 0; b < 2; ++b) {
+        mcmc_bond *copy = bonds[b]->clone();
+        copy->attach(nodes);
+        CHECK_CLOSE(copy->currentValue(), normalSum(y, mu, group, sd), 1e-6);
+        delete copy;
+    }
+
+    /* Both bonds take a parameter moved outside them. */
+    double change = normalSum(y, mu_new, group, sd) - normalSum(y, mu, group, sd);
+    std::vector<double> mu_back = mu_new;
+    mu_back[0] = mu[0];
+    for(size_t b = 0; b < 2; ++b) {
+        bonds[b]->moveTo(1, mu_new, change);
+        CHECK_CLOSE(bonds[b]->currentValue(), normalSum(y, mu_new, group, sd), 1e-6);
+        CHECK_CLOSE(bonds[b]->propose(1, mu[0], 0),
+            normalSum(y, mu_back, group, sd) - normalSum(y, mu_new, group, sd), tol);
+        bonds[b]->reject();
+    }
+
+    return testResult("test_bonds");
+}
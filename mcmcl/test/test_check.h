@@ -0,0 +1,70 @@
+/**
+ *
+ * @file test_check.h
+ * @author Lars Simon Zehnder
+ *
+ * @created July 9, 2012, 9:10 AM
+ *
+ * @brief Checks shared by the behaviour tests.
+ *
+ * Every test is a program of its own. It prints the checks that
+ * fail and returns their number. A test is compiled from its own
+ * file and the .cpp files of the library, e.g. in this directory
+ * @code
+ * g++ -std=c++11 -O2 -pthread -I../src test_bonds.cpp ../src/[A-z]*.cpp
+ * @endcode
+ *
+ */
+#ifndef TEST_CHECK_H
+#define	TEST_CHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+/**
+ *
+ * @brief Number of failed checks of the test program.
+ *
+ */
+static int test_failures = 0;
+
+/**
+ *
+ * @brief Records a failed check.
+ *
+ */
+inline void testFail(char const *file, int line, char const *what) {
+    std::printf("%s:%d: check failed: %s\n", file, line, what);
+    ++test_failures;
+}
+
+/**
+ *
+ * @brief Checks that two values agree up to an absolute tolerance.
+ *
+ */
+inline void testClose(char const *file, int line, char const *what, double a, double b, double tol) {
+    if(!(std::fabs(a - b) <= tol)) {
+        std::printf("%s:%d: check failed: %s (%.12g vs %.12g, tolerance %g)\n", file, line, what, a, b, tol);
+        ++test_failures;
+    }
+}
+
+#define CHECK(cond) \
+    do { if(!(cond)) testFail(__FILE__, __LINE__, #cond); } while(0)
+
+#define CHECK_CLOSE(a, b, tol) \
+    testClose(__FILE__, __LINE__, #a " == " #b, (a), (b), (tol))
+
+/**
+ *
+ * @brief Prints the summary of the test and returns its exit code.
+ *
+ */
+inline int testResult(char const *name) {
+    std::printf("%s: %s\n", name, test_failures == 0 ? "passed" : "FAILED");
+
+    return test_failures;
+}
+
+#endif	/* TEST_CHECK_H */
@@ -0,0 +1,106 @@
+/**
+ *
+ * @file test_chromatic.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 11, 2012, 2:45 PM
+ *
+ * @brief Checks that the chromatic update draws the same chain as the
+ *        update of the components one by one.
+ *
+ * The group means of Student t data are conditionally independent
+ * and form a single colour. The draws of a sweep are addressed by the
+ * sweep and the component, see mcmc_parameter::drawSweep, so updating
+ * the colour in parallel, with any number of threads, has to give the
+ * values of the serial scan, for groups scattered over the data and
+ * for groups in contiguous ranges.
+ *
+ */
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "basic_mcmc_bond.h"
+#include "student_t_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "constant_argument_maker.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+/**
+ *
+ * @brief Runs the model of the group means and returns the values of
+ *        all sweeps after each other.
+ *
+ */
+std::vector<double> runChain(std::vector<double> const &y, std::vector<int> const &group, size_t groups,
+    bool chromatic, size_t nthreads) {
+    mcmc_model model;
+    mcmc_parameter data(y, y, "y");
+    data.const_val = true;
+    size_t iy = model.addParameter(data);
+    size_t im = model.addParameter(mcmc_parameter(std::vector<double>(groups, 0.0),
+        std::vector<double>(groups, 0.3), "mu"));
+    std::vector<maker_ptr> lik_argms, prior_argms;
+    lik_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+    lik_argms.push_back(maker_ptr(new group_argument_maker(1, group)));
+    lik_argms.push_back(maker_ptr(new constant_argument_maker(0.5)));
+    lik_argms.push_back(maker_ptr(new constant_argument_maker(4.0)));
+    prior_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+    prior_argms.push_back(maker_ptr(new constant_argument_maker(0.0)));
+    prior_argms.push_back(maker_ptr(new constant_argument_maker(3.0)));
+    prior_argms.push_back(maker_ptr(new constant_argument_maker(4.0)));
+    std::vector<size_t> lik_nodes, prior_nodes;
+    lik_nodes.push_back(iy);
+    lik_nodes.push_back(im);
+    prior_nodes.push_back(im);
+    model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(lik_argms,
+        boost::shared_ptr<mcmc_likelihood>(new student_t_likelihood))), lik_nodes);
+    model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(prior_argms,
+        boost::shared_ptr<mcmc_likelihood>(new student_t_likelihood))), prior_nodes);
+    model.finalize();
+    model.seed(21, 0);
+    thread_pool pool(nthreads);
+    if(nthreads > 1) {
+        model.setThreadPool(&pool);
+    }
+    model.parameter(im).setChromatic(chromatic);
+    CHECK(model.parameter(im).numColours() == (chromatic ? 1u : 0u));
+    model.startAdaptation(100);
+    std::vector<double> trace;
+    for(int it = 0; it < 300; ++it) {
+        model.update();
+        trace.insert(trace.end(), model.parameter(im).value.begin(), model.parameter(im).value.end());
+    }
+
+    return trace;
+}
+
+int main() {
+    size_t const groups = 300, per = 20, n = groups * per;
+    std::srand(9);
+    for(int sorted = 0; sorted < 2; ++sorted) {
+        std::vector<int> group(n);
+        std::vector<double> y(n);
+        for(size_t i = 0; i < n; ++i) {
+            group[i] = sorted ? i / per : i % groups;
+            y[i] = (group[i] % 10) * 0.3 + 2.0 * std::rand() / RAND_MAX - 1.0;
+        }
+        std::vector<double> serial = runChain(y, group, groups, false, 1);
+        size_t threads[] = {1, 3};
+        for(size_t t = 0; t < 2; ++t) {
+            std::vector<double> chromatic = runChain(y, group, groups, true, threads[t]);
+            CHECK(chromatic.size() == serial.size());
+            size_t same = 0;
+            for(size_t k = 0; k < serial.size() && k < chromatic.size(); ++k) {
+                same += chromatic[k] == serial[k];
+            }
+            CHECK(same == serial.size());
+        }
+    }
+
+    return testResult("test_chromatic");
+}
@@ -0,0 +1,181 @@
+/**
+ *
+ * @file test_column_file.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 16, 2012, 11:00 AM
+ *
+ * @brief Checks round trips of tables through CSV files and column
+ *        files.
+ *
+ * A CSV file of several chunks is read by @ref csv_data_reader on a
+ * pool and every value has to equal the one strtod gives for its
+ * field. The table is written as a @ref column_file, and mapping it,
+ * reading it by @ref column_file_reader and by
+ * @ref column_file_stream has to give the same columns bit by bit.
+ * @ref cached_data_reader has to write the column file once, use it
+ * afterwards and write it anew when the source changes. A damaged
+ * column file has to be refused.
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "csv_data_reader.h"
+#include "column_file.h"
+#include "cached_data_reader.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+/**
+ *
+ * @brief Determines if two values are the same bits or both NaN.
+ *
+ */
+bool same(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+/**
+ *
+ * @brief Determines if two tables have the same names and values.
+ *
+ */
+bool sameTable(column_table const &a, column_table const &b) {
+    if(a.names != b.names || a.columns.size() != b.columns.size()) {
+        return false;
+    }
+    for(size_t k = 0; k < a.columns.size(); ++k) {
+        if(a.columns[k].size() != b.columns[k].size()) {
+            return false;
+        }
+        for(size_t i = 0; i < a.columns[k].size(); ++i) {
+            if(!same(a.columns[k][i], b.columns[k][i])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ *
+ * @brief Writes a CSV file of rows with fields of many forms and
+ *        returns the values they stand for.
+ *
+ */
+column_table writeCsv(std::string const &path, size_t rows) {
+    column_table expected;
+    expected.names.push_back("a");
+    expected.names.push_back("b");
+    expected.names.push_back("c");
+    expected.columns.resize(3, std::vector<double>(rows));
+    char const *special[] = {"NA", "", "1e-5", "-2.5E+3", "+7", ".5", "123456789012345678901234"};
+    std::ofstream out(path.c_str());
+    out << "a,\"b\",c\n";
+    char field[64];
+    for(size_t i = 0; i < rows; ++i) {
+        std::snprintf(field, sizeof(field), "%.3f", (std::rand() % 2000000 - 1000000) / 1000.0);
+        expected.columns[0][i] = std::strtod(field, 0);
+        out << field << ',';
+        std::snprintf(field, sizeof(field), "%.17g", std::rand() / (double) RAND_MAX * std::pow(10.0, std::rand() % 40 - 20));
+        expected.columns[1][i] = std::strtod(field, 0);
+        out << field << ',';
+        char const *c = special[i % 7];
+        expected.columns[2][i] = *c == 0 || *c == 'N' ? NAN : std::strtod(c, 0);
+        out << c << '\n';
+        if(i % 1000 == 0) {
+            out << '\n';
+        }
+    }
+
+    return expected;
+}
+
+int main() {
+    std::string const csv_path = "test_column_file.csv";
+    std::string const cache_path = csv_path + COLUMN_FILE_SUFFIX;
+    std::string const mcol_path = "test_column_file.mcol";
+    std::remove(cache_path.c_str());
+    std::srand(29);
+    size_t const rows = 300000;
+    column_table expected = writeCsv(csv_path, rows);
+
+    /* The CSV file spans several chunks, parsed on three threads. */
+    thread_pool pool(3);
+    csv_data_reader csv;
+    csv.setThreadPool(&pool);
+    column_table table;
+    CHECK(csv.read(csv_path, table));
+    CHECK(table.rows() == rows);
+    CHECK(sameTable(table, expected));
+
+    /* Write, map, read and stream the column file. */
+    std::string message;
+    CHECK(column_file::write(mcol_path, table, 0, 0, message));
+    column_file file;
+    CHECK(file.open(mcol_path));
+    CHECK(file.rows() == rows && file.numColumns() == 3);
+    column_table mapped;
+    file.copy(mapped);
+    CHECK(sameTable(mapped, expected));
+    column_file_reader mcol;
+    column_table copied;
+    CHECK(mcol.read(mcol_path, copied));
+    CHECK(sameTable(copied, expected));
+    column_file_stream stream;
+    CHECK(stream.open(mcol_path));
+    std::vector<double> part(1000);
+    CHECK(stream.readRows(stream.find("b"), rows - 1000, 1000, &part[0], message));
+    bool equal = true;
+    for(size_t i = 0; i < part.size(); ++i) {
+        equal = equal && same(part[i], expected.columns[1][rows - 1000 + i]);
+    }
+    CHECK(equal);
+    CHECK(!stream.readRows(0, rows - 10, 11, &part[0], message));
+    stream.close();
+    file.close();
+
+    /* A damaged block is found by its checksum. */
+    {
+        std::fstream damage(mcol_path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        damage.seekg(0, std::ios::end);
+        std::streamoff size = damage.tellg();
+        damage.seekp(size - 8);
+        damage.put('\x7f');
+    }
+    CHECK(!file.open(mcol_path));
+    CHECK(!file.error().empty());
+    CHECK(file.open(mcol_path, false));
+    file.close();
+
+    /* The cache is written by the first read and used by the second. */
+    cached_data_reader cached(csv);
+    column_table first, second;
+    CHECK(cached.read(csv_path, first));
+    CHECK(sameTable(first, expected));
+    CHECK(file.open(cache_path));
+    file.close();
+    CHECK(cached.read(csv_path, second));
+    CHECK(sameTable(second, expected));
+
+    /* A changed source makes the cache stale. */
+    expected = writeCsv(csv_path, rows / 3);
+    column_table third;
+    CHECK(cached.read(csv_path, third));
+    CHECK(sameTable(third, expected));
+    CHECK(file.open(cache_path));
+    CHECK(file.rows() == rows / 3);
+    file.close();
+
+    std::remove(csv_path.c_str());
+    std::remove(cache_path.c_str());
+    std::remove(mcol_path.c_str());
+
+    return testResult("test_column_file");
+}
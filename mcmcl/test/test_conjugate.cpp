@@ -0,0 +1,150 @@
+/**
+ *
+ * @file test_conjugate.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 12, 2012, 9:30 AM
+ *
+ * @brief Checks the draws from full conditionals against the moments
+ *        of the analytic posteriors.
+ *
+ * Group means of normal data with a known standard deviation and a
+ * normal prior have a normal posterior, and the precision of normal
+ * data with a known mean and a flat prior on the standard deviation
+ * has a Gamma posterior. The means and variances of the draws of
+ * mcmc_parameter::drawConjugate have to match the moments of these
+ * posteriors within a few standard errors.
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "basic_mcmc_bond.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "constant_argument_maker.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+/**
+ *
+ * @brief Checks the mean and the variance of draws against the
+ *        moments of their distribution.
+ *
+ */
+void checkMoments(std::vector<double> const &draws, double mean, double var) {
+    double m = 0, v = 0;
+    for(size_t i = 0; i < draws.size(); ++i) {
+        m += draws[i];
+    }
+    m /= draws.size();
+    for(size_t i = 0; i < draws.size(); ++i) {
+        v += (draws[i] - m) * (draws[i] - m);
+    }
+    v /= draws.size() - 1;
+    CHECK_CLOSE(m, mean, 4 * std::sqrt(var / draws.size()));
+    CHECK_CLOSE(v / var, 1.0, 4 * std::sqrt(2.0 / draws.size()));
+}
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    size_t const n = 200, groups = 5, draws = 20000;
+    std::srand(5);
+    std::vector<double> y(n);
+    std::vector<int> group(n);
+    for(size_t i = 0; i < n; ++i) {
+        group[i] = i % groups;
+        y[i] = 0.5 * group[i] + uniform(-3, 3);
+    }
+    mcmc_parameter data(y, y, "y");
+    data.const_val = true;
+
+    /* Group means, known sd = 2 and the prior N(1, 0.5^2). */
+    {
+        double const sd = 2.0, m0 = 1.0, s0 = 0.5;
+        mcmc_model model;
+        size_t iy = model.addParameter(data);
+        size_t im = model.addParameter(mcmc_parameter(std::vector<double>(groups, 0.0),
+            std::vector<double>(groups, 0.1), "mu"));
+        std::vector<maker_ptr> lik_argms, prior_argms;
+        lik_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        lik_argms.push_back(maker_ptr(new group_argument_maker(1, group)));
+        lik_argms.push_back(maker_ptr(new constant_argument_maker(sd)));
+        prior_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(m0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(s0)));
+        std::vector<size_t> lik_nodes, prior_nodes;
+        lik_nodes.push_back(iy);
+        lik_nodes.push_back(im);
+        prior_nodes.push_back(im);
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(lik_argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), lik_nodes);
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(prior_argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), prior_nodes);
+        model.finalize();
+        model.seed(13, 0);
+        std::vector<std::vector<double> > trace(groups);
+        for(size_t it = 0; it < draws; ++it) {
+            model.update();
+            for(size_t k = 0; k < groups; ++k) {
+                trace[k].push_back(model.parameter(im).value[k]);
+            }
+        }
+        CHECK(model.parameter(im).accepted().find("(conjugate)") != std::string::npos);
+        for(size_t k = 0; k < groups; ++k) {
+            double count = 0, sum = 0;
+            for(size_t i = 0; i < n; ++i) {
+                if(group[i] == static_cast<int>(k)) {
+                    ++count;
+                    sum += y[i];
+                }
+            }
+            double prec = count / (sd * sd) + 1 / (s0 * s0);
+            checkMoments(trace[k], (sum / (sd * sd) + m0 / (s0 * s0)) / prec, 1 / prec);
+        }
+    }
+
+    /* The standard deviation of all observations, a known mean of 0.5
+     * and a flat prior: sd^(-2) is Gamma((n - 1) / 2, S / 2). */
+    {
+        double const mu = 0.5;
+        mcmc_model model;
+        size_t iy = model.addParameter(data);
+        size_t is = model.addParameter(mcmc_parameter(std::vector<double>(1, 1.0),
+            std::vector<double>(1, 0.1), "sd"));
+        std::vector<maker_ptr> argms;
+        argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        argms.push_back(maker_ptr(new constant_argument_maker(mu)));
+        argms.push_back(maker_ptr(new identity_argument_maker(1)));
+        std::vector<size_t> nodes;
+        nodes.push_back(iy);
+        nodes.push_back(is);
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), nodes);
+        model.finalize();
+        model.seed(17, 0);
+        std::vector<double> trace;
+        for(size_t it = 0; it < draws; ++it) {
+            model.update();
+            double sd = model.parameter(is).value[0];
+            trace.push_back(1 / (sd * sd));
+        }
+        CHECK(model.parameter(is).accepted().find("(conjugate)") != std::string::npos);
+        double ss = 0;
+        for(size_t i = 0; i < n; ++i) {
+            ss += (y[i] - mu) * (y[i] - mu);
+        }
+        double shape = 0.5 * (n - 1), rate = 0.5 * ss;
+        checkMoments(trace, shape / rate, shape / (rate * rate));
+    }
+
+    return testResult("test_conjugate");
+}
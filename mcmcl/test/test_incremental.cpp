@@ -0,0 +1,122 @@
+/**
+ *
+ * @file test_incremental.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 11, 2012, 10:20 AM
+ *
+ * @brief Checks the proposals of @ref basic_mcmc_bond that recompute
+ *        only the touched terms against a full recomputation.
+ *
+ * The same normal likelihood is computed by two bonds. One sees the
+ * likelihood as separable and recomputes the terms of the changed
+ * group means only, the other one sees it as not separable and
+ * recomputes all terms for every proposal. Both have to give the same
+ * differences and values, for groups scattered over the data and for
+ * groups in contiguous ranges.
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "basic_mcmc_bond.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "test_check.h"
+
+/**
+ *
+ * @brief The normal likelihood, seen as not separable.
+ *
+ */
+class whole_normal_likelihood : public normal_likelihood {
+public:
+    virtual bool isSeparable () const {
+        return false;
+    };
+};
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    std::srand(3);
+    size_t const n = 5000, groups = 40;
+    std::vector<double> y(n), sd(n), mu(groups);
+    for(size_t i = 0; i < n; ++i) {
+        y[i] = uniform(-2, 2);
+        sd[i] = uniform(0.5, 2);
+    }
+    for(int sorted = 0; sorted < 2; ++sorted) {
+        std::vector<int> group(n);
+        for(size_t i = 0; i < n; ++i) {
+            group[i] = std::rand() % groups;
+        }
+        if(sorted) {
+            std::sort(group.begin(), group.end());
+        }
+        for(size_t j = 0; j < groups; ++j) {
+            mu[j] = uniform(-1, 1);
+        }
+        std::vector<mcmc_parameter> par;
+        par.push_back(mcmc_parameter(y, std::vector<double>(n, 0), "y"));
+        par.push_back(mcmc_parameter(mu, std::vector<double>(groups, 0.1), "mu"));
+        par.push_back(mcmc_parameter(sd, std::vector<double>(n, 0.1), "sd"));
+        par[0].const_val = true;
+        std::vector<boost::shared_ptr<argument_maker> > argms;
+        argms.push_back(boost::shared_ptr<argument_maker>(new identity_argument_maker(0)));
+        argms.push_back(boost::shared_ptr<argument_maker>(new group_argument_maker(1, group)));
+        argms.push_back(boost::shared_ptr<argument_maker>(new identity_argument_maker(2)));
+        basic_mcmc_bond part(argms, boost::shared_ptr<mcmc_likelihood>(new normal_likelihood), par);
+        basic_mcmc_bond whole(argms, boost::shared_ptr<mcmc_likelihood>(new whole_normal_likelihood), par);
+        std::vector<size_t> terms;
+        CHECK(part.dependentTerms(1, 0, terms));
+        CHECK(!whole.dependentTerms(1, 0, terms));
+        CHECK_CLOSE(part.currentValue(), whole.currentValue(), 1e-8);
+
+        /* Single coordinates, blocks of a few and of most group means. */
+        for(int it = 0; it < 600; ++it) {
+            int whatami = it % 4 == 3 ? 2 : 1;
+            size_t count = it % 5 == 0 ? (it % 3 == 0 ? groups - 2 : 3) : 1;
+            size_t size = whatami == 1 ? groups : n;
+            std::vector<size_t> which;
+            std::vector<double> cand;
+            while(which.size() < count) {
+                size_t k = std::rand() % size;
+                if(std::find(which.begin(), which.end(), k) == which.end()) {
+                    which.push_back(k);
+                    cand.push_back(whatami == 1 ? uniform(-1, 1) : uniform(0.5, 2));
+                }
+            }
+            double a = part.proposeBlock(whatami, which, cand);
+            double b = whole.proposeBlock(whatami, which, cand);
+            CHECK_CLOSE(a, b, 1e-8);
+            if(std::rand() % 2) {
+                part.accept();
+                whole.accept();
+                for(size_t c = 0; c < count; ++c) {
+                    par[whatami].value[which[c]] = cand[c];
+                }
+            } else {
+                part.reject();
+                whole.reject();
+            }
+        }
+        CHECK_CLOSE(part.currentValue(), whole.currentValue(), 1e-7);
+
+        /* The accepted differences add up to the value of the state. */
+        std::vector<mcmc_node const*> nodes;
+        for(size_t i = 0; i < par.size(); ++i) {
+            nodes.push_back(&par[i]);
+        }
+        mcmc_bond *fresh = part.clone();
+        fresh->attach(nodes);
+        CHECK_CLOSE(part.currentValue(), fresh->currentValue(), 1e-7);
+        delete fresh;
+    }
+
+    return testResult("test_incremental");
+}
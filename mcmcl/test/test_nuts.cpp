@@ -0,0 +1,107 @@
+/**
+ *
+ * @file test_nuts.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 12, 2012, 2:15 PM
+ *
+ * @brief Checks that @ref nuts_update samples a known normal
+ *        posterior.
+ *
+ * Group means of normal data with a known standard deviation and a
+ * normal prior have independent normal posteriors. After the burn-in
+ * the means and variances of the draws have to match them, with the
+ * analytic derivatives of @ref basic_mcmc_bond and with the central
+ * differences used for @ref static_bond.
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "basic_mcmc_bond.h"
+#include "static_bond.h"
+#include "nuts_update.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "constant_argument_maker.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    size_t const n = 400, groups = 4, burnin = 500, draws = 4000;
+    double const sd = 1.5, s0 = 2.0;
+    std::srand(23);
+    std::vector<double> y(n), sum(groups, 0.0), count(groups, 0.0);
+    std::vector<int> group(n);
+    for(size_t i = 0; i < n; ++i) {
+        group[i] = i % groups;
+        y[i] = group[i] - 1.0 + uniform(-2, 2);
+        sum[group[i]] += y[i];
+        ++count[group[i]];
+    }
+    mcmc_parameter data(y, y, "y");
+    data.const_val = true;
+
+    for(int numeric = 0; numeric < 2; ++numeric) {
+        mcmc_model model;
+        size_t iy = model.addParameter(data);
+        size_t im = model.addParameter(mcmc_parameter(std::vector<double>(groups, 0.0),
+            std::vector<double>(groups, 0.1), "mu"));
+        std::vector<size_t> lik_nodes, prior_nodes;
+        lik_nodes.push_back(iy);
+        lik_nodes.push_back(im);
+        prior_nodes.push_back(im);
+        if(numeric) {
+            model.addBond(boost::shared_ptr<mcmc_bond>(new static_bond<normal_likelihood, identity_argument_maker,
+                group_argument_maker, constant_argument_maker>(normal_likelihood(), identity_argument_maker(0),
+                group_argument_maker(1, group), constant_argument_maker(sd))), lik_nodes);
+        } else {
+            std::vector<maker_ptr> argms;
+            argms.push_back(maker_ptr(new identity_argument_maker(0)));
+            argms.push_back(maker_ptr(new group_argument_maker(1, group)));
+            argms.push_back(maker_ptr(new constant_argument_maker(sd)));
+            model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(argms,
+                boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), lik_nodes);
+        }
+        std::vector<maker_ptr> prior_argms;
+        prior_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(0.0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(s0)));
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(prior_argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), prior_nodes);
+        model.finalize();
+        model.seed(31, 0);
+        nuts_update nuts(model.parameter(im));
+        model.setUpdate(im, &nuts);
+        nuts.startAdaptation(burnin);
+        for(size_t it = 0; it < burnin; ++it) {
+            model.update();
+        }
+        CHECK(model.parameter(im).numericGradients() == static_cast<size_t>(numeric));
+        std::vector<double> s1(groups, 0.0), s2(groups, 0.0);
+        for(size_t it = 0; it < draws; ++it) {
+            model.update();
+            for(size_t k = 0; k < groups; ++k) {
+                double v = model.parameter(im).value[k];
+                s1[k] += v;
+                s2[k] += v * v;
+            }
+        }
+        for(size_t k = 0; k < groups; ++k) {
+            double prec = count[k] / (sd * sd) + 1 / (s0 * s0);
+            double mean = s1[k] / draws, var = s2[k] / draws - mean * mean;
+            CHECK_CLOSE(mean, sum[k] / (sd * sd) / prec, 0.1 / std::sqrt(prec));
+            CHECK_CLOSE(var * prec, 1.0, 0.15);
+        }
+    }
+
+    return testResult("test_nuts");
+}
@@ -0,0 +1,104 @@
+/**
+ *
+ * @file test_scalar_parameter.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 10, 2012, 11:05 AM
+ *
+ * @brief Checks bonds with a parameter of a single entry next to
+ *        data of many entries.
+ *
+ * A scalar mean and standard deviation are passed through
+ * @ref identity_argument_maker, so the bond sees arguments of
+ * different lengths. The parameters have to be broadcast to all
+ * observations in the value, the proposals, the gradient and the
+ * sufficient statistics of the bond.
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "basic_mcmc_bond.h"
+#include "static_bond.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "test_check.h"
+
+double normalSum(std::vector<double> const &y, double mu, double sd) {
+    double sum = 0;
+    for(size_t i = 0; i < y.size(); ++i) {
+        double z = (y[i] - mu) / sd;
+        sum += -0.5 * z * z - std::log(sd) - 0.91893853320467274178;
+    }
+
+    return sum;
+}
+
+int main() {
+    std::srand(11);
+    size_t const n = 1003;
+    std::vector<double> y(n);
+    double ysum = 0;
+    for(size_t i = 0; i < n; ++i) {
+        y[i] = 4.0 * std::rand() / RAND_MAX - 1.0;
+        ysum += y[i];
+    }
+    double mu = 0.3, sd = 1.7;
+    std::vector<mcmc_parameter> par;
+    par.push_back(mcmc_parameter(y, std::vector<double>(n, 0), "y"));
+    par.push_back(mcmc_parameter(std::vector<double>(1, mu), std::vector<double>(1, 0.1), "mu"));
+    par.push_back(mcmc_parameter(std::vector<double>(1, sd), std::vector<double>(1, 0.1), "sd"));
+    par[0].const_val = true;
+
+    basic_mcmc_bond basic(boost::shared_ptr<mcmc_likelihood>(new normal_likelihood), par);
+    static_bond<normal_likelihood, identity_argument_maker, identity_argument_maker, identity_argument_maker>
+        fixed(normal_likelihood(), identity_argument_maker(0), identity_argument_maker(1),
+        identity_argument_maker(2));
+    std::vector<mcmc_node const*> nodes;
+    for(size_t i = 0; i < par.size(); ++i) {
+        nodes.push_back(&par[i]);
+    }
+    fixed.attach(nodes);
+    mcmc_bond *bonds[] = {&basic, &fixed};
+
+    CHECK(basic.numTerms() == n);
+    for(size_t b = 0; b < 2; ++b) {
+        CHECK_CLOSE(bonds[b]->currentValue(), normalSum(y, mu, sd), 1e-8);
+        CHECK_CLOSE(bonds[b]->propose(1, 0.5, 0), normalSum(y, 0.5, sd) - normalSum(y, mu, sd), 1e-8);
+        bonds[b]->accept();
+        CHECK_CLOSE(bonds[b]->propose(2, 1.2, 0), normalSum(y, 0.5, 1.2) - normalSum(y, 0.5, sd), 1e-8);
+        bonds[b]->reject();
+        CHECK_CLOSE(bonds[b]->currentValue(), normalSum(y, 0.5, sd), 1e-8);
+        std::vector<size_t> terms;
+        CHECK(!bonds[b]->dependentTerms(1, 0, terms));
+    }
+    mu = 0.5;
+
+    /* The terms of a broadcast mean are not known, all are recomputed. */
+    CHECK_CLOSE(basic.proposeCoordinate(1, 0, 0.9), normalSum(y, 0.9, sd) - normalSum(y, mu, sd), 1e-8);
+    CHECK_CLOSE(basic.currentValue(), normalSum(y, mu, sd), 1e-8);
+
+    /* d/dmu = sum (y - mu) / sd^2, d/dsd = sum ((y - mu)^2 / sd^2 - 1) / sd. */
+    double dmu = 0, dsd = 0;
+    for(size_t i = 0; i < n; ++i) {
+        double z = (y[i] - mu) / sd;
+        dmu += z / sd;
+        dsd += (z * z - 1) / sd;
+    }
+    std::vector<double> grad(1, 0.0);
+    CHECK(basic.gradient(1, grad));
+    CHECK_CLOSE(grad[0], dmu, 1e-8);
+    grad[0] = 0;
+    CHECK(basic.gradient(2, grad));
+    CHECK_CLOSE(grad[0], dsd, 1e-8);
+
+    /* The mean enters as x sum y / sd^2 - x^2 n / (2 sd^2). */
+    CHECK(basic.isConjugate(1));
+    std::vector<std::vector<double> > stats(CONJUGATE_STATS, std::vector<double>(1, 0.0));
+    basic.addStatistics(1, stats);
+    CHECK_CLOSE(stats[0][0], ysum / (sd * sd), 1e-8);
+    CHECK_CLOSE(stats[1][0], -0.5 * n / (sd * sd), 1e-8);
+
+    return testResult("test_scalar_parameter");
+}
@@ -0,0 +1,128 @@
+/**
+ *
+ * @file test_slice.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 12, 2012, 4:40 PM
+ *
+ * @brief Checks that @ref slice_update samples a known normal
+ *        posterior.
+ *
+ * Group means of normal data with a known standard deviation and a
+ * normal prior have independent normal posteriors. After the burn-in
+ * the means and variances of the draws have to match them, for the
+ * slices stepped out coordinate by coordinate and for the
+ * hyperrectangle.
+ *
+ */
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_model.h"
+#include "basic_mcmc_bond.h"
+#include "slice_update.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "constant_argument_maker.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+/**
+ *
+ * @brief Checks the mean and the variance of a chain against the
+ *        moments of the posterior.
+ *
+ * The standard error of the mean is estimated from the means of 40
+ * batches of the chain, which accounts for the autocorrelation.
+ *
+ */
+void checkPosterior(std::vector<double> const &trace, double mean, double var) {
+    size_t const batches = 40, size = trace.size() / batches;
+    double m = 0, v = 0, b = 0;
+    for(size_t i = 0; i < trace.size(); ++i) {
+        m += trace[i];
+    }
+    m /= trace.size();
+    for(size_t i = 0; i < trace.size(); ++i) {
+        v += (trace[i] - m) * (trace[i] - m);
+    }
+    v /= trace.size() - 1;
+    for(size_t j = 0; j < batches; ++j) {
+        double bm = 0;
+        for(size_t i = j * size; i < (j + 1) * size; ++i) {
+            bm += trace[i];
+        }
+        bm = bm / size - m;
+        b += bm * bm;
+    }
+    double se = std::sqrt(b / (batches - 1) / batches);
+    CHECK_CLOSE(m, mean, 4 * se);
+    CHECK_CLOSE(v / var, 1.0, 0.15);
+}
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    size_t const n = 400, groups = 4, burnin = 500, draws = 10000;
+    double const sd = 1.5, s0 = 2.0;
+    std::srand(23);
+    std::vector<double> y(n), sum(groups, 0.0), count(groups, 0.0);
+    std::vector<int> group(n);
+    for(size_t i = 0; i < n; ++i) {
+        group[i] = i % groups;
+        y[i] = group[i] - 1.0 + uniform(-2, 2);
+        sum[group[i]] += y[i];
+        ++count[group[i]];
+    }
+    mcmc_parameter data(y, y, "y");
+    data.const_val = true;
+
+    for(int rectangle = 0; rectangle < 2; ++rectangle) {
+        mcmc_model model;
+        size_t iy = model.addParameter(data);
+        size_t im = model.addParameter(mcmc_parameter(std::vector<double>(groups, 0.0),
+            std::vector<double>(groups, 0.1), "mu"));
+        std::vector<size_t> lik_nodes, prior_nodes;
+        lik_nodes.push_back(iy);
+        lik_nodes.push_back(im);
+        prior_nodes.push_back(im);
+        std::vector<maker_ptr> argms;
+        argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        argms.push_back(maker_ptr(new group_argument_maker(1, group)));
+        argms.push_back(maker_ptr(new constant_argument_maker(sd)));
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), lik_nodes);
+        std::vector<maker_ptr> prior_argms;
+        prior_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(0.0)));
+        prior_argms.push_back(maker_ptr(new constant_argument_maker(s0)));
+        model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(prior_argms,
+            boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), prior_nodes);
+        model.finalize();
+        model.seed(31, 0);
+        slice_update slice(model.parameter(im), rectangle);
+        model.setUpdate(im, &slice);
+        slice.startAdaptation(burnin);
+        for(size_t it = 0; it < burnin; ++it) {
+            model.update();
+        }
+        std::vector<std::vector<double> > trace(groups);
+        for(size_t it = 0; it < draws; ++it) {
+            model.update();
+            for(size_t k = 0; k < groups; ++k) {
+                trace[k].push_back(model.parameter(im).value[k]);
+            }
+        }
+        for(size_t k = 0; k < groups; ++k) {
+            double prec = count[k] / (sd * sd) + 1 / (s0 * s0);
+            checkPosterior(trace[k], sum[k] / (sd * sd) / prec, 1 / prec);
+        }
+    }
+
+    return testResult("test_slice");
+}
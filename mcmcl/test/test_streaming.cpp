@@ -0,0 +1,108 @@
+/**
+ *
+ * @file test_streaming.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 13, 2012, 3:20 PM
+ *
+ * @brief Checks @ref streaming_bond against @ref basic_mcmc_bond on
+ *        the same data.
+ *
+ * The data are written to a column file, which the streaming bond
+ * reads in several chunks, while the basic bond holds them in
+ * memory. Both compute a normal likelihood with group means and a
+ * common standard deviation, and have to give the same values for
+ * every proposal, accepted or rejected, on one and on three threads.
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "basic_mcmc_bond.h"
+#include "streaming_bond.h"
+#include "column_file.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "group_argument_maker.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+double uniform(double lo, double hi) {
+    return lo + (hi - lo) * std::rand() / (double) RAND_MAX;
+}
+
+int main() {
+    size_t const n = 100000, groups = 7;
+    std::string const path = "test_streaming.mcol";
+    std::srand(19);
+    column_table table;
+    table.names.push_back("y");
+    table.columns.resize(1, std::vector<double>(n));
+    std::vector<int> group(n);
+    for(size_t i = 0; i < n; ++i) {
+        group[i] = std::rand() % groups;
+        table.columns[0][i] = 0.3 * group[i] + uniform(-2, 2);
+    }
+    std::string message;
+    CHECK(column_file::write(path, table, 0, 0, message));
+    boost::shared_ptr<column_file_stream> file(new column_file_stream());
+    CHECK(file->open(path));
+
+    for(size_t nthreads = 1; nthreads <= 3; nthreads += 2) {
+        std::vector<mcmc_parameter> par;
+        par.push_back(mcmc_parameter(table.columns[0], std::vector<double>(n, 0), "y"));
+        par.push_back(mcmc_parameter(std::vector<double>(groups, 0.0), std::vector<double>(groups, 0.1), "mu"));
+        par.push_back(mcmc_parameter(std::vector<double>(1, 1.5), std::vector<double>(1, 0.1), "sd"));
+        par[0].const_val = true;
+        std::vector<maker_ptr> argms, stream_argms;
+        argms.push_back(maker_ptr(new identity_argument_maker(0)));
+        argms.push_back(maker_ptr(new group_argument_maker(1, group)));
+        argms.push_back(maker_ptr(new identity_argument_maker(2)));
+        basic_mcmc_bond memory(argms, boost::shared_ptr<mcmc_likelihood>(new normal_likelihood), par);
+
+        /* The data column replaces the first argument, the makers index
+         * the nodes mu and sd. */
+        stream_argms.push_back(maker_ptr());
+        stream_argms.push_back(maker_ptr(new group_argument_maker(0, group)));
+        stream_argms.push_back(maker_ptr(new identity_argument_maker(1)));
+        streaming_bond stream(stream_argms, boost::shared_ptr<mcmc_likelihood>(new normal_likelihood), file,
+            std::vector<size_t>(1, file->find("y")), 256 << 10);
+        std::vector<mcmc_node const*> nodes;
+        nodes.push_back(&par[1]);
+        nodes.push_back(&par[2]);
+        stream.attach(nodes);
+        thread_pool pool(nthreads);
+        if(nthreads > 1) {
+            memory.setThreadPool(&pool);
+            stream.setThreadPool(&pool);
+        }
+        CHECK(stream.chunkRows() < n / 4);
+
+        double const tol = 1e-9 * n;
+        CHECK_CLOSE(stream.currentValue(), memory.currentValue(), tol);
+        for(int it = 0; it < 60; ++it) {
+            bool sd = it % 3 == 2;
+            size_t which = sd ? 0 : std::rand() % groups;
+            double cand = sd ? uniform(1, 2) : uniform(-1, 2);
+            CHECK_CLOSE(stream.propose(sd ? 1 : 0, cand, which), memory.propose(sd ? 2 : 1, cand, which), tol);
+            if(std::rand() % 2) {
+                stream.accept();
+                memory.accept();
+            } else {
+                stream.reject();
+                memory.reject();
+            }
+        }
+        CHECK_CLOSE(stream.currentValue(), memory.currentValue(), tol);
+        CHECK(stream.error().empty());
+    }
+    file.reset();
+    std::remove(path.c_str());
+
+    return testResult("test_streaming");
+}
@@ -0,0 +1,82 @@
+/**
+ *
+ * @file test_tempering.cpp
+ * @author Lars Simon Zehnder
+ *
+ * @created July 13, 2012, 10:05 AM
+ *
+ * @brief Checks that the ladder of @ref mcmc_tempering adapts towards
+ *        equal swap rates.
+ *
+ * A sharp likelihood is tempered against a wide prior that is not.
+ * At the hot end the replicas see almost only the prior, so on the
+ * geometric ladder the pairs there nearly always swap and the pairs
+ * at the cold end rarely do. After the burn-in the adapted ladder has
+ * to give every pair about the same swap rate and keep its ends.
+ *
+ */
+#include <algorithm>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "mcmc_tempering.h"
+#include "basic_mcmc_bond.h"
+#include "normal_likelihood.h"
+#include "identity_argument_maker.h"
+#include "constant_argument_maker.h"
+#include "test_check.h"
+
+typedef boost::shared_ptr<argument_maker> maker_ptr;
+
+/**
+ *
+ * @brief Difference of the largest and the smallest swap rate.
+ *
+ */
+double rateSpread(mcmc_tempering const &pt) {
+    double lo = 1, hi = 0;
+    for(size_t k = 0; k + 1 < pt.numReplicas(); ++k) {
+        lo = std::min(lo, pt.swapRate(k));
+        hi = std::max(hi, pt.swapRate(k));
+    }
+
+    return hi - lo;
+}
+
+int main() {
+    size_t const nreplicas = 8, rounds = 10000;
+    double const beta_min = 1e-5;
+    mcmc_model model;
+    size_t ix = model.addParameter(mcmc_parameter(std::vector<double>(3, 0.0), std::vector<double>(3, 0.5), "x"));
+    std::vector<maker_ptr> lik_argms, prior_argms;
+    lik_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+    lik_argms.push_back(maker_ptr(new constant_argument_maker(0.0)));
+    lik_argms.push_back(maker_ptr(new constant_argument_maker(0.5)));
+    prior_argms.push_back(maker_ptr(new identity_argument_maker(0)));
+    prior_argms.push_back(maker_ptr(new constant_argument_maker(0.0)));
+    prior_argms.push_back(maker_ptr(new constant_argument_maker(10.0)));
+    model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(lik_argms,
+        boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), std::vector<size_t>(1, ix));
+    model.addBond(boost::shared_ptr<mcmc_bond>(new basic_mcmc_bond(prior_argms,
+        boost::shared_ptr<mcmc_likelihood>(new normal_likelihood))), std::vector<size_t>(1, ix), false);
+    model.finalize();
+
+    mcmc_tempering geometric(model, nreplicas, beta_min, 11, 2);
+    geometric.run(rounds);
+    double before = rateSpread(geometric);
+    CHECK(before > 0.5);
+
+    mcmc_tempering adapted(model, nreplicas, beta_min, 11, 2);
+    adapted.startAdaptation(rounds);
+    adapted.run(rounds);
+    adapted.run(rounds);
+    double after = rateSpread(adapted);
+    CHECK(after < 0.15);
+    CHECK(after < before);
+    CHECK(adapted.inverseTemperature(0) == 1.0);
+    CHECK_CLOSE(adapted.inverseTemperature(nreplicas - 1), beta_min, 1e-15);
+    for(size_t k = 0; k + 1 < nreplicas; ++k) {
+        CHECK(adapted.inverseTemperature(k + 1) < adapted.inverseTemperature(k));
+    }
+
+    return testResult("test_tempering");
+}